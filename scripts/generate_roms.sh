@@ -15,6 +15,10 @@ fi
 cat > "$OUTPUT_FILE" << 'EOF'
 // Auto-generated ROM data - DO NOT EDIT
 // Generated by generate_roms.sh
+//
+// Each machine variant #includes this file. The arrays are inline variables
+// so the linker keeps a single copy of every ROM image however many
+// translation units (and machine instances) use it.
 
 #include <cstdint>
 #include <cstddef>
@@ -30,8 +34,8 @@ generate_array() {
 
     if [ ! -f "$file" ]; then
         echo "// ROM file not found: $file" >> "$OUTPUT_FILE"
-        echo "const uint8_t ${name}[] = {};" >> "$OUTPUT_FILE"
-        echo "const size_t ${name}_SIZE = 0;" >> "$OUTPUT_FILE"
+        echo "inline constexpr uint8_t ${name}[] = {};" >> "$OUTPUT_FILE"
+        echo "inline constexpr size_t ${name}_SIZE = 0;" >> "$OUTPUT_FILE"
         echo "" >> "$OUTPUT_FILE"
         return
     fi
@@ -39,12 +43,12 @@ generate_array() {
     local size=$(wc -c < "$file" | tr -d ' ')
 
     echo "// $(basename "$file")" >> "$OUTPUT_FILE"
-    echo "const uint8_t ${name}[] = {" >> "$OUTPUT_FILE"
+    echo "inline constexpr uint8_t ${name}[] = {" >> "$OUTPUT_FILE"
 
     xxd -i < "$file" | sed 's/^/    /' >> "$OUTPUT_FILE"
 
     echo "};" >> "$OUTPUT_FILE"
-    echo "const size_t ${name}_SIZE = $size;" >> "$OUTPUT_FILE"
+    echo "inline constexpr size_t ${name}_SIZE = $size;" >> "$OUTPUT_FILE"
     echo "" >> "$OUTPUT_FILE"
 }
 
@@ -23,50 +23,275 @@
 #include "../core/debug/condition_evaluator.hpp"
 #include "../machines/loaders/z80_saver.hpp"
 #include "../machines/loaders/z80_loader.hpp"
+#include "../machines/time_travel.hpp"
 #include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 #include <emscripten.h>
 
-// Global machine instance
+// Machine instances. A module can host any number of isolated machines; JS
+// addresses them by handle (their index in g_machines). The un-suffixed
+// exports below all operate on g_machine, the currently selected instance,
+// and the ...For(handle) exports target a machine directly.
+static std::vector<std::unique_ptr<zxspec::Machine>> g_machines;
+static int g_selectedMachine = -1;
 static zxspec::Machine *g_machine = nullptr;
 
 // Helper macros to reduce repetitive null checks
 #define REQUIRE_MACHINE() do { if (!g_machine) return; } while(0)
 #define REQUIRE_MACHINE_OR(default_val) do { if (!g_machine) return (default_val); } while(0)
+#define REQUIRE_HANDLE(m, handle) zxspec::Machine* m = machineForHandle(handle); if (!m) return
+#define REQUIRE_HANDLE_OR(m, handle, default_val) zxspec::Machine* m = machineForHandle(handle); if (!m) return (default_val)
 
-extern "C" {
-
-EMSCRIPTEN_KEEPALIVE
-void initMachine(int machineId) {
-  delete g_machine;
-  g_machine = nullptr;
-
+static zxspec::Machine* newMachine(int machineId) {
   switch (machineId) {
     case 1:
-      g_machine = new zxspec::zx128k::ZXSpectrum128();
-      break;
+      return new zxspec::zx128k::ZXSpectrum128();
     case 2:
-      g_machine = new zxspec::zxplus2::ZXSpectrumPlus2();
-      break;
+      return new zxspec::zxplus2::ZXSpectrumPlus2();
     case 3:
-      g_machine = new zxspec::zxplus2a::ZXSpectrumPlus2A();
-      break;
+      return new zxspec::zxplus2a::ZXSpectrumPlus2A();
     case 4:
-      g_machine = new zxspec::zxplus3::ZXSpectrumPlus3();
-      break;
+      return new zxspec::zxplus3::ZXSpectrumPlus3();
     case 5:
-      g_machine = new zxspec::zx81::ZX81();
-      break;
+      return new zxspec::zx81::ZX81();
     case 0:
     default:
-      g_machine = new zxspec::zx48k::ZXSpectrum48();
-      break;
+      return new zxspec::zx48k::ZXSpectrum48();
   }
+}
+
+static zxspec::Machine* machineForHandle(int handle) {
+  if (handle < 0 || handle >= static_cast<int>(g_machines.size())) return nullptr;
+  return g_machines[handle].get();
+}
+
+// The time-travel history (see Time Travel below) holds one machine
+// instance's past, so it is dropped, and that machine's input journal
+// switched off, before the selected instance changes: another handle is
+// selected, or the selected machine is replaced or destroyed. It is also
+// dropped before a memory poke, register edit or NMI from the front end,
+// none of which the journal can replay.
+static zxspec::TimeTravel s_timeTravel;
+
+static void forgetTimeTravelHistory() {
+  if (g_machine && g_machine->getId() != 5) {
+    static_cast<zxspec::ZXSpectrum*>(g_machine)->setInputJournalEnabled(false);
+  }
+  s_timeTravel.clear();
+}
+
+// Reuse the first free slot so handles stay small
+static int allocateMachineSlot() {
+  for (size_t i = 0; i < g_machines.size(); i++) {
+    if (!g_machines[i]) return static_cast<int>(i);
+  }
+  g_machines.emplace_back();
+  return static_cast<int>(g_machines.size() - 1);
+}
+
+extern "C" {
+
+EMSCRIPTEN_KEEPALIVE
+void initMachine(int machineId) {
+  // Replaces the selected instance in place, keeping its handle
+  forgetTimeTravelHistory();
+  if (g_selectedMachine < 0) g_selectedMachine = allocateMachineSlot();
+  g_machines[g_selectedMachine].reset();
+  g_machine = nullptr;
 
+  g_machines[g_selectedMachine].reset(newMachine(machineId));
+  g_machine = g_machines[g_selectedMachine].get();
   g_machine->init();
 }
 
+// ============================================================================
+// Multi-instance management
+// ============================================================================
+
+EMSCRIPTEN_KEEPALIVE
+int createMachine(int machineId) {
+  int handle = allocateMachineSlot();
+  g_machines[handle].reset(newMachine(machineId));
+  g_machines[handle]->init();
+  return handle;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void destroyMachine(int handle) {
+  if (!machineForHandle(handle)) return;
+  if (handle == g_selectedMachine) {
+    forgetTimeTravelHistory();
+    g_selectedMachine = -1;
+    g_machine = nullptr;
+  }
+  g_machines[handle].reset();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int selectMachine(int handle) {
+  zxspec::Machine* m = machineForHandle(handle);
+  if (!m) return 0;
+  if (m != g_machine) forgetTimeTravelHistory();
+  g_selectedMachine = handle;
+  g_machine = m;
+  return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getSelectedMachine() {
+  return g_selectedMachine;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getMachineCount() {
+  int count = 0;
+  for (const auto& m : g_machines) {
+    if (m) count++;
+  }
+  return count;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getMachineIdFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, -1);
+  return m->getId();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void resetFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->reset();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void runFrameFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->runFrame();
+}
+
+EMSCRIPTEN_KEEPALIVE
+const uint8_t* getFramebufferFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, nullptr);
+  return m->getFramebuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+const uint8_t* getSignalBufferFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, nullptr);
+  return m->getSignalBuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+const uint32_t* getDirtyRowsFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, nullptr);
+  return m->getDirtyRows();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void clearDirtyRowsFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->clearDirtyRows();
+}
+
+EMSCRIPTEN_KEEPALIVE
+const float* getAudioBufferFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, nullptr);
+  return m->getAudioBuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getAudioSampleCountFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, 0);
+  return m->getAudioSampleCount();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void resetAudioBufferFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->resetAudioBuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setStereoOutputEnabledFor(int handle, int enabled) {
+  REQUIRE_HANDLE(m, handle);
+  m->setStereoOutputEnabled(enabled != 0);
+}
+
+EMSCRIPTEN_KEEPALIVE
+const float* getStereoAudioBufferFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, nullptr);
+  return m->getStereoAudioBuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getStereoAudioFrameCountFor(int handle) {
+  REQUIRE_HANDLE_OR(m, handle, 0);
+  return m->getStereoAudioFrameCount();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void keyDownFor(int handle, int row, int bit) {
+  REQUIRE_HANDLE(m, handle);
+  m->keyDown(row, bit);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void keyUpFor(int handle, int row, int bit) {
+  REQUIRE_HANDLE(m, handle);
+  m->keyUp(row, bit);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setKempstonJoystickFor(int handle, uint8_t value) {
+  REQUIRE_HANDLE(m, handle);
+  static_cast<zxspec::ZXSpectrum*>(m)->setKempstonJoystick(value);
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint8_t readMemoryFor(int handle, uint16_t address) {
+  REQUIRE_HANDLE_OR(m, handle, 0);
+  return m->readMemory(address);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void writeMemoryFor(int handle, uint16_t address, uint8_t data) {
+  REQUIRE_HANDLE(m, handle);
+  if (m == g_machine) forgetTimeTravelHistory();
+  m->writeMemory(address, data);
+}
+
+EMSCRIPTEN_KEEPALIVE
+void loadSNAFor(int handle, const uint8_t* data, int size) {
+  REQUIRE_HANDLE(m, handle);
+  m->loadSNA(data, static_cast<uint32_t>(size));
+}
+
+EMSCRIPTEN_KEEPALIVE
+void loadZ80For(int handle, const uint8_t* data, int size) {
+  REQUIRE_HANDLE(m, handle);
+  m->loadZ80(data, static_cast<uint32_t>(size));
+}
+
+EMSCRIPTEN_KEEPALIVE
+void loadTAPFor(int handle, const uint8_t* data, int size) {
+  REQUIRE_HANDLE(m, handle);
+  m->loadTAP(data, static_cast<uint32_t>(size));
+}
+
+EMSCRIPTEN_KEEPALIVE
+void tapePlayFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->tapePlay();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void tapeStopFor(int handle) {
+  REQUIRE_HANDLE(m, handle);
+  m->tapeStop();
+}
+
 EMSCRIPTEN_KEEPALIVE
 int getMachineId() {
   REQUIRE_MACHINE_OR(-1);
@@ -82,8 +307,7 @@ const char* getMachineName() {
 EMSCRIPTEN_KEEPALIVE
 void init() {
   if (!g_machine) {
-    g_machine = new zxspec::zx48k::ZXSpectrum48();
-    g_machine->init();
+    initMachine(0);
   }
 }
 
@@ -96,6 +320,7 @@ void reset() {
 EMSCRIPTEN_KEEPALIVE
 void triggerNMI() {
   REQUIRE_MACHINE();
+  forgetTimeTravelHistory();
   g_machine->triggerNMI();
 }
 
@@ -284,34 +509,34 @@ uint16_t getAltHL() {
 // ============================================================================
 
 EMSCRIPTEN_KEEPALIVE
-void setPC(uint16_t v) { REQUIRE_MACHINE(); g_machine->setPC(v); }
+void setPC(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setPC(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setSP(uint16_t v) { REQUIRE_MACHINE(); g_machine->setSP(v); }
+void setSP(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setSP(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setAF(uint16_t v) { REQUIRE_MACHINE(); g_machine->setAF(v); }
+void setAF(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setAF(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setBC(uint16_t v) { REQUIRE_MACHINE(); g_machine->setBC(v); }
+void setBC(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setBC(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setDE(uint16_t v) { REQUIRE_MACHINE(); g_machine->setDE(v); }
+void setDE(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setDE(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setHL(uint16_t v) { REQUIRE_MACHINE(); g_machine->setHL(v); }
+void setHL(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setHL(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setIX(uint16_t v) { REQUIRE_MACHINE(); g_machine->setIX(v); }
+void setIX(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setIX(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setIY(uint16_t v) { REQUIRE_MACHINE(); g_machine->setIY(v); }
+void setIY(uint16_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setIY(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setI(uint8_t v) { REQUIRE_MACHINE(); g_machine->setI(v); }
+void setI(uint8_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setI(v); }
 
 EMSCRIPTEN_KEEPALIVE
-void setR(uint8_t v) { REQUIRE_MACHINE(); g_machine->setR(v); }
+void setR(uint8_t v) { REQUIRE_MACHINE(); forgetTimeTravelHistory(); g_machine->setR(v); }
 
 // ============================================================================
 // Breakpoint Management
@@ -432,6 +657,7 @@ uint8_t readMemory(uint16_t address) {
 EMSCRIPTEN_KEEPALIVE
 void writeMemory(uint16_t address, uint8_t data) {
   REQUIRE_MACHINE();
+  forgetTimeTravelHistory();
   g_machine->writeMemory(address, data);
 }
 
@@ -494,6 +720,18 @@ void runFrame() {
   g_machine->runFrame();
 }
 
+EMSCRIPTEN_KEEPALIVE
+void runTurboFrames(int count) {
+  REQUIRE_MACHINE();
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->runTurboFrames(count);
+}
+
+EMSCRIPTEN_KEEPALIVE
+double getTurboSpeed() {
+  REQUIRE_MACHINE_OR(0.0);
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getTurboSpeed();
+}
+
 EMSCRIPTEN_KEEPALIVE
 uint32_t getDisplayTs() {
   REQUIRE_MACHINE_OR(0);
@@ -524,6 +762,21 @@ int getSignalBufferSize() {
   return g_machine->getSignalBufferSize();
 }
 
+// Rows of the framebuffer (and signal buffer) that changed since the last
+// clearDirtyRows(), as ceil(288 / 32) little-endian 32-bit words. Returns 0
+// (null) for machines that do not track this; upload every row then.
+EMSCRIPTEN_KEEPALIVE
+const uint32_t* getDirtyRows() {
+  REQUIRE_MACHINE_OR(nullptr);
+  return g_machine->getDirtyRows();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void clearDirtyRows() {
+  REQUIRE_MACHINE();
+  g_machine->clearDirtyRows();
+}
+
 // ============================================================================
 // Audio
 // ============================================================================
@@ -546,6 +799,112 @@ void resetAudioBuffer() {
   g_machine->resetAudioBuffer();
 }
 
+// Mix the stereo buffer as well as the mono one from the next frame on.
+// Off by default: only a front end that plays stereo should pay for it.
+EMSCRIPTEN_KEEPALIVE
+void setStereoOutputEnabled(int enabled) {
+  REQUIRE_MACHINE();
+  g_machine->setStereoOutputEnabled(enabled != 0);
+}
+
+// Interleaved L/R float32 frames; nullptr / 0 on the ZX81 (mono only) and
+// while stereo output is off
+EMSCRIPTEN_KEEPALIVE
+const float* getStereoAudioBuffer() {
+  REQUIRE_MACHINE_OR(nullptr);
+  return g_machine->getStereoAudioBuffer();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int getStereoAudioFrameCount() {
+  REQUIRE_MACHINE_OR(0);
+  return g_machine->getStereoAudioFrameCount();
+}
+
+// ============================================================================
+// Mixer (Spectrum models only)
+// ============================================================================
+
+// 0 = mono, 1 = ABC, 2 = ACB
+EMSCRIPTEN_KEEPALIVE
+int getAYPanning() {
+  REQUIRE_MACHINE_OR(0);
+  if (g_machine->getId() == 5) return 0;
+  return static_cast<int>(static_cast<zxspec::ZXSpectrum*>(g_machine)->getMixer().getAYPanning());
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setAYPanning(int panning) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  if (panning < 0 || panning > 2) panning = 0;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->setAYPanning(
+      static_cast<zxspec::AudioMixer::AYPanning>(panning));
+}
+
+// source: 0 = beeper, 1 = AY, 2 = speech
+EMSCRIPTEN_KEEPALIVE
+float getAudioGain(int source) {
+  REQUIRE_MACHINE_OR(0.0f);
+  if (g_machine->getId() == 5) return 1.0f;
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getMixer().getGain(
+      static_cast<zxspec::AudioMixer::Source>(source));
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setAudioGain(int source, float gain) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->getMixer().setGain(
+      static_cast<zxspec::AudioMixer::Source>(source), gain);
+}
+
+// Host output rate in Hz (8000-192000); the emulator runs at 48000 and
+// resamples the mono and stereo buffers when this differs
+EMSCRIPTEN_KEEPALIVE
+int getAudioOutputRate() {
+  REQUIRE_MACHINE_OR(0);
+  if (g_machine->getId() == 5) return static_cast<int>(zxspec::AUDIO_SAMPLE_RATE);
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getAudioOutputRate();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setAudioOutputRate(int sampleRate) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->setAudioOutputRate(sampleRate);
+}
+
+// Nudge the output rate by up to +/-10000 ppm to track the display clock;
+// positive values produce more samples per frame
+EMSCRIPTEN_KEEPALIVE
+double getAudioRateAdjustment() {
+  REQUIRE_MACHINE_OR(0.0);
+  if (g_machine->getId() == 5) return 0.0;
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getAudioRateAdjustment();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setAudioRateAdjustment(double ppm) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->setAudioRateAdjustment(ppm);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int isDCBlockEnabled() {
+  REQUIRE_MACHINE_OR(0);
+  if (g_machine->getId() == 5) return 0;
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getMixer().isDCBlockEnabled() ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setDCBlockEnabled(int enabled) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->getMixer().setDCBlockEnabled(enabled != 0);
+}
+
 // ============================================================================
 // Keyboard Input
 // ============================================================================
@@ -849,6 +1208,20 @@ int tapeGetInstantLoad() {
   return spec ? (spec->tapeGetInstantLoad() ? 1 : 0) : 0;
 }
 
+EMSCRIPTEN_KEEPALIVE
+void tapeSetEdgeSkip(int skip) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->tapeSetEdgeSkip(skip != 0);
+}
+
+EMSCRIPTEN_KEEPALIVE
+int tapeGetEdgeSkip() {
+  REQUIRE_MACHINE_OR(0);
+  if (g_machine->getId() == 5) return 0;
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->tapeGetEdgeSkip() ? 1 : 0;
+}
+
 // ============================================================================
 // Tape Recording
 // ============================================================================
@@ -1029,6 +1402,25 @@ void setAYEnabled(int enabled) {
   if (spec) spec->setAYEnabled(enabled != 0);
 }
 
+// ============================================================================
+// Beeper
+// ============================================================================
+
+// Band-limited (BLEP) beeper synthesis; Spectrum models only (not the ZX81)
+EMSCRIPTEN_KEEPALIVE
+int isBeeperBandLimited() {
+  REQUIRE_MACHINE_OR(0);
+  if (g_machine->getId() == 5) return 0;
+  return static_cast<zxspec::ZXSpectrum*>(g_machine)->getAudio().isBandLimited() ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void setBeeperBandLimited(int enabled) {
+  REQUIRE_MACHINE();
+  if (g_machine->getId() == 5) return;
+  static_cast<zxspec::ZXSpectrum*>(g_machine)->getAudio().setBandLimited(enabled != 0);
+}
+
 // ============================================================================
 // SpecDrum DAC Peripheral
 // ============================================================================
@@ -1124,6 +1516,7 @@ const char* basicParseVariables() {
 EMSCRIPTEN_KEEPALIVE
 void basicWriteProgram(const uint8_t* data, int length) {
     REQUIRE_MACHINE();
+    forgetTimeTravelHistory();
     auto* spec = static_cast<zxspec::ZXSpectrum*>(g_machine);
     if (spec) zxspec::basic::writeProgramToMemory(*spec, data, static_cast<size_t>(length));
 }
@@ -1548,6 +1941,24 @@ int currahIsBusy() {
     return (spectrum && spectrum->getCurrahSpeech().getSP0256().isBusy()) ? 1 : 0;
 }
 
+// Replay allophones from a cache rendered on first use instead of running
+// the SP0256 sequencer and LPC filter live (the default, exact mode)
+EMSCRIPTEN_KEEPALIVE
+int currahIsCachedMode() {
+    REQUIRE_MACHINE_OR(0);
+    if (g_machine->getId() == 5) return 0;
+    auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
+    return spectrum->getCurrahSpeech().getSP0256().isCachedMode() ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void currahSetCachedMode(int cached) {
+    REQUIRE_MACHINE();
+    if (g_machine->getId() == 5) return;
+    auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
+    spectrum->getCurrahSpeech().getSP0256().setCachedMode(cached != 0);
+}
+
 // ============================================================================
 // Tape State Snapshot (for time-travel scrubber)
 // ============================================================================
@@ -1579,53 +1990,104 @@ void tapeRestoreState(const uint8_t* buffer, uint32_t size) {
 // FDC State Snapshot (for time-travel scrubber)
 // ============================================================================
 
-static uint8_t s_fdcStateBuf[96]; // enough for UPD765A (64) + WD1770 (32)
+static uint8_t s_fdcStateBuf[zxspec::ZXSpectrum::FDC_SNAPSHOT_SIZE];
 
 EMSCRIPTEN_KEEPALIVE
 const uint8_t* fdcSnapshotState() {
     REQUIRE_MACHINE_OR(nullptr);
-    std::memset(s_fdcStateBuf, 0, sizeof(s_fdcStateBuf));
-    int id = g_machine->getId();
-
-    // +2A/+3: UPD765A FDC
-    if (id == 3 || id == 4) { // +2A or +3
-        auto* plus3 = static_cast<zxspec::zxplus3::ZXSpectrumPlus3*>(g_machine);
-        plus3->getFDC().snapshotState(s_fdcStateBuf);
-    }
-
-    // Opus Discovery: WD1770 (offset 64 in buffer)
     auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
-    if (spectrum->isOpusEnabled()) {
-        spectrum->getOpus().getFDC().snapshotState(s_fdcStateBuf + 64);
-    }
-
+    spectrum->fdcSnapshotState(s_fdcStateBuf);
     return s_fdcStateBuf;
 }
 
 EMSCRIPTEN_KEEPALIVE
 uint32_t fdcSnapshotSize() {
-    return 96;
+    return zxspec::ZXSpectrum::FDC_SNAPSHOT_SIZE;
 }
 
 EMSCRIPTEN_KEEPALIVE
 void fdcRestoreState(const uint8_t* buffer, uint32_t size) {
     REQUIRE_MACHINE();
-    if (!buffer || size < 96) return;
-    int id = g_machine->getId();
+    if (!buffer || size < zxspec::ZXSpectrum::FDC_SNAPSHOT_SIZE) return;
+    auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
+    spectrum->fdcRestoreState(buffer);
+}
+
+// ============================================================================
+// Time Travel (frame history held in a native arena)
+// ============================================================================
+
+// The selected machine, if it supports time travel
+static zxspec::ZXSpectrum* timeTravelMachine() {
+    if (!g_machine || g_machine->getId() == 5) return nullptr;  // ZX81 not supported
+    return static_cast<zxspec::ZXSpectrum*>(g_machine);
+}
 
-    if (id == 3 || id == 4) { // +2A or +3
-        auto* plus3 = static_cast<zxspec::zxplus3::ZXSpectrumPlus3*>(g_machine);
-        plus3->getFDC().restoreState(buffer);
+EMSCRIPTEN_KEEPALIVE
+void timeTravelConfigure(uint32_t arenaBytes, uint32_t maxFrames, uint32_t keyframeInterval) {
+    s_timeTravel.configure(arenaBytes, maxFrames, keyframeInterval);
+    // The input journal only runs while there is a history to replay it
+    // into; capturing switches it on
+    if (arenaBytes == 0) {
+        if (auto* spectrum = timeTravelMachine()) spectrum->setInputJournalEnabled(false);
     }
+}
+
+EMSCRIPTEN_KEEPALIVE
+void timeTravelClear() {
+    s_timeTravel.clear();
+    if (auto* spectrum = timeTravelMachine()) spectrum->getInputJournal().clear();
+}
 
+EMSCRIPTEN_KEEPALIVE
+int timeTravelCapture() {
+    REQUIRE_MACHINE_OR(0);
+    if (g_machine->getId() == 5) return 0;  // ZX81 not supported
     auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
-    if (spectrum->isOpusEnabled()) {
-        spectrum->getOpus().getFDC().restoreState(buffer + 64);
-    }
+    return s_timeTravel.capture(*spectrum) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+int timeTravelSeek(uint32_t frame) {
+    REQUIRE_MACHINE_OR(0);
+    if (g_machine->getId() == 5) return 0;
+    auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
+    return s_timeTravel.seekToFrame(*spectrum, frame) ? 1 : 0;
+}
+
+EMSCRIPTEN_KEEPALIVE
+void timeTravelTruncateAfter(uint32_t frame) {
+    s_timeTravel.truncateAfter(frame);
+    if (auto* spectrum = timeTravelMachine()) spectrum->getInputJournal().truncateFrom(frame);
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t timeTravelCount() {
+    return s_timeTravel.count();
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t timeTravelFrameAt(uint32_t index) {
+    return s_timeTravel.frameAt(index);
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t timeTravelOldestFrame() {
+    return s_timeTravel.oldestFrame();
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t timeTravelNewestFrame() {
+    return s_timeTravel.newestFrame();
+}
+
+EMSCRIPTEN_KEEPALIVE
+uint32_t timeTravelBytesUsed() {
+    return static_cast<uint32_t>(s_timeTravel.bytesUsed());
 }
 
 // ============================================================================
-// Save State (Z80 v3 format)
+// Save State (native ZXST format; .z80 still accepted on import)
 // ============================================================================
 
 static std::vector<uint8_t> s_stateBuffer;
@@ -1634,14 +2096,13 @@ EMSCRIPTEN_KEEPALIVE
 uint8_t* exportState(uint32_t* sizeOut) {
     if (!g_machine) { *sizeOut = 0; return nullptr; }
 
-    // ZX81 doesn't use Z80 snapshot format — save states not supported yet
+    // ZX81 doesn't have a machine state format — save states not supported yet
     if (g_machine->getId() == 5) { *sizeOut = 0; return nullptr; }
 
     auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
 
-    s_stateBuffer.resize(256 * 1024);  // 256KB max
-    uint32_t written = zxspec::Z80Saver::save(*spectrum, s_stateBuffer.data(), static_cast<uint32_t>(s_stateBuffer.size()));
-    *sizeOut = written;
+    spectrum->saveState(s_stateBuffer, true);
+    *sizeOut = static_cast<uint32_t>(s_stateBuffer.size());
     return s_stateBuffer.data();
 }
 
@@ -1649,6 +2110,19 @@ EMSCRIPTEN_KEEPALIVE
 int importState(const uint8_t* data, uint32_t size) {
     if (!data || size < 30) return 0;
 
+    // Native state: the header names the machine it came from
+    int stateMachine = zxspec::ZXSpectrum::stateMachineId(data, size);
+    if (stateMachine >= 0) {
+        if (stateMachine > 4) return 0;   // ZX81 or unknown
+        int currentMachine = g_machine ? g_machine->getId() : -1;
+        if (stateMachine != currentMachine) {
+            initMachine(stateMachine);
+        }
+        if (!g_machine) return 0;
+        auto* spectrum = static_cast<zxspec::ZXSpectrum*>(g_machine);
+        return spectrum->loadState(data, size) ? 1 : 0;
+    }
+
     // Detect required machine from Z80 header
     // Re-use detectSnapshotMachine with format "z80"
     int requiredMachine = detectSnapshotMachine(data, static_cast<int>(size), "z80");
@@ -2210,6 +2684,17 @@ int diskGetLastResultST2() {
     return p3->getFDC().getLastResultST2();
 }
 
+// ============================================================================
+// UDG editor session
+// ============================================================================
+
+EMSCRIPTEN_KEEPALIVE
+void udgPatchEnable(int enable) {
+    REQUIRE_MACHINE();
+    if (g_machine->getId() == 5) return;
+    static_cast<zxspec::ZXSpectrum*>(g_machine)->setUdgScreenPatching(enable != 0);
+}
+
 // ============================================================================
 // CPU Instruction Trace
 // ============================================================================
@@ -0,0 +1,101 @@
+/*
+ * frame_profile.hpp - Optional wall-clock profiling of emulator subsystems
+ *
+ * Compiled in only when ZXSPEC_PROFILE is defined to 1 (the native
+ * zxspec_bench_profile target does this). The WASM build and the other native
+ * targets see empty macros, so the hot paths are unchanged.
+ *
+ * Profiled sections mark themselves with ZXSPEC_PROFILE_SCOPE(Section).
+ * Time is charged to the FrameProfile installed on the current thread with
+ * FrameProfile::setActive(); with none installed a scope costs one load and
+ * branch. Sections must not nest, so each nanosecond is charged once and
+ * CPU time can be derived as total minus the profiled sections. Callers
+ * scale nanoseconds by calls / timedCalls to account for sampling.
+ */
+
+#pragma once
+
+#ifndef ZXSPEC_PROFILE
+#define ZXSPEC_PROFILE 0
+#endif
+
+#include <cstdint>
+
+#if ZXSPEC_PROFILE
+#include <chrono>
+#endif
+
+namespace zxspec {
+
+struct FrameProfile {
+    enum Section {
+        Display = 0,    // Display::updateWithTs (framebuffer + signal buffer)
+        Audio,          // Beeper, AY and SP0256 updates and frame-end mixing
+        Contention,     // Memory and no-MREQ contention callbacks
+        SectionCount
+    };
+
+    // Contention runs several times per instruction and costs less than a
+    // clock read, so only one call in 64 is timed and the rest are counted
+    static constexpr uint32_t sampleShift[SectionCount] = { 0, 0, 6 };
+
+    uint64_t nanoseconds[SectionCount] = {};    // Summed over timed calls only
+    uint64_t calls[SectionCount] = {};
+    uint64_t timedCalls[SectionCount] = {};
+
+    void clear() { *this = FrameProfile{}; }
+
+#if ZXSPEC_PROFILE
+    static FrameProfile*& active()
+    {
+        static thread_local FrameProfile* profile = nullptr;
+        return profile;
+    }
+    static void setActive(FrameProfile* profile) { active() = profile; }
+#endif
+};
+
+#if ZXSPEC_PROFILE
+
+class FrameProfileScope {
+public:
+    explicit FrameProfileScope(FrameProfile::Section section)
+        : profile_(FrameProfile::active()), section_(section)
+    {
+        if (!profile_) return;
+        uint64_t mask = (uint64_t{1} << FrameProfile::sampleShift[section]) - 1;
+        if ((profile_->calls[section]++ & mask) != 0) {
+            profile_ = nullptr;
+            return;
+        }
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~FrameProfileScope()
+    {
+        if (!profile_) return;
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        profile_->nanoseconds[section_] += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        profile_->timedCalls[section_]++;
+    }
+
+    FrameProfileScope(const FrameProfileScope&) = delete;
+    FrameProfileScope& operator=(const FrameProfileScope&) = delete;
+
+private:
+    FrameProfile* profile_;
+    FrameProfile::Section section_;
+    std::chrono::steady_clock::time_point start_{};
+};
+
+#define ZXSPEC_PROFILE_SCOPE(section) \
+    ::zxspec::FrameProfileScope zxspecProfileScope_(::zxspec::FrameProfile::section)
+
+#else
+
+#define ZXSPEC_PROFILE_SCOPE(section) do {} while (0)
+
+#endif
+
+} // namespace zxspec
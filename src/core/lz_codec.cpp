@@ -0,0 +1,254 @@
+/*
+ * lz_codec.cpp - Fast LZ77 compression for machine state
+ */
+
+#include "lz_codec.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace zxspec {
+
+static constexpr uint32_t MIN_MATCH = 4;
+static constexpr uint32_t HASH_BITS = 12;
+
+static void writeLE32(uint8_t* dst, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) dst[i] = (value >> (i * 8)) & 0xFF;
+}
+
+static uint32_t readLE32(const uint8_t* src)
+{
+    return src[0] | (src[1] << 8) | (src[2] << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+
+static uint32_t hash4(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Bytes a length of 15 or more needs after its nibble
+static size_t extraLengthBytes(size_t length)
+{
+    return length >= 15 ? (length - 15) / 255 + 1 : 0;
+}
+
+static uint8_t* writeExtraLength(uint8_t* op, size_t length)
+{
+    if (length < 15) return op;
+    length -= 15;
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+size_t LZEncoder::encodeBlock(const uint8_t* src, uint32_t size, uint8_t* dst)
+{
+    // Anything that doesn't beat the raw size is stored raw
+    uint8_t* op = dst + BLOCK_HEADER_SIZE;
+    uint8_t* limit = op + size;
+    bool compressed = size > MIN_MATCH;
+
+    if (compressed) {
+        uint16_t table[1u << HASH_BITS] = {};
+        uint32_t ip = 0;
+        uint32_t anchor = 0;
+        uint32_t misses = 0;
+
+        while (ip + MIN_MATCH <= size) {
+            uint32_t h = hash4(src + ip);
+            uint32_t candidate = table[h];
+            table[h] = static_cast<uint16_t>(ip);
+
+            if (candidate >= ip || std::memcmp(src + candidate, src + ip, MIN_MATCH) != 0) {
+                // Step faster through data that isn't matching
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            uint32_t length = MIN_MATCH;
+            while (ip + length + 8 <= size && std::memcmp(src + candidate + length, src + ip + length, 8) == 0) {
+                length += 8;
+            }
+            while (ip + length < size && src[candidate + length] == src[ip + length]) length++;
+
+            size_t literals = ip - anchor;
+            size_t need = 1 + extraLengthBytes(literals) + literals + 2 + extraLengthBytes(length - MIN_MATCH);
+            if (op + need >= limit) {
+                compressed = false;
+                break;
+            }
+
+            uint8_t token = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+            token |= static_cast<uint8_t>(length - MIN_MATCH < 15 ? length - MIN_MATCH : 15);
+            *op++ = token;
+            op = writeExtraLength(op, literals);
+            std::memcpy(op, src + anchor, literals);
+            op += literals;
+            uint32_t offset = ip - candidate;
+            *op++ = offset & 0xFF;
+            *op++ = (offset >> 8) & 0xFF;
+            op = writeExtraLength(op, length - MIN_MATCH);
+
+            ip += length;
+            anchor = ip;
+        }
+
+        if (compressed) {
+            size_t literals = size - anchor;
+            if (op + 1 + extraLengthBytes(literals) + literals >= limit) {
+                compressed = false;
+            } else {
+                *op++ = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+                op = writeExtraLength(op, literals);
+                std::memcpy(op, src + anchor, literals);
+                op += literals;
+            }
+        }
+    }
+
+    if (!compressed) {
+        std::memcpy(dst + BLOCK_HEADER_SIZE, src, size);
+        op = dst + BLOCK_HEADER_SIZE + size;
+    }
+
+    writeLE32(dst, size);
+    writeLE32(dst + 4, static_cast<uint32_t>(op - dst - BLOCK_HEADER_SIZE));
+    return static_cast<size_t>(op - dst);
+}
+
+void LZEncoder::emitBlock(const uint8_t* src, uint32_t size)
+{
+    size_t at = out_.size();
+    out_.resize(at + maxEncodedSize(size));
+    size_t written = encodeBlock(src, size, out_.data() + at);
+    out_.resize(at + written);
+}
+
+void LZEncoder::write(const void* data, size_t size)
+{
+    const auto* in = static_cast<const uint8_t*>(data);
+
+    // Top up a partial block first
+    if (!pending_.empty()) {
+        size_t take = std::min<size_t>(size, BLOCK_SIZE - pending_.size());
+        pending_.insert(pending_.end(), in, in + take);
+        in += take;
+        size -= take;
+        if (pending_.size() < BLOCK_SIZE) return;
+        emitBlock(pending_.data(), BLOCK_SIZE);
+        pending_.clear();
+    }
+
+    // Whole blocks compress straight from the caller's memory
+    while (size >= BLOCK_SIZE) {
+        emitBlock(in, BLOCK_SIZE);
+        in += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+    pending_.insert(pending_.end(), in, in + size);
+}
+
+void LZEncoder::finish()
+{
+    if (pending_.empty()) return;
+    emitBlock(pending_.data(), static_cast<uint32_t>(pending_.size()));
+    pending_.clear();
+}
+
+size_t lzDecodedSize(const uint8_t* src, size_t size)
+{
+    size_t total = 0;
+    size_t pos = 0;
+    while (pos < size) {
+        if (size - pos < LZEncoder::BLOCK_HEADER_SIZE) return SIZE_MAX;
+        uint32_t raw = readLE32(src + pos);
+        uint32_t stored = readLE32(src + pos + 4);
+        pos += LZEncoder::BLOCK_HEADER_SIZE;
+        if (raw > LZEncoder::BLOCK_SIZE || stored > raw || stored > size - pos) return SIZE_MAX;
+        total += raw;
+        pos += stored;
+    }
+    return total;
+}
+
+// Read the continuation bytes of a length whose nibble was 15
+static bool readExtraLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+{
+    uint8_t b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+static bool decodeBlock(const uint8_t* ip, const uint8_t* end, uint8_t* dst, uint32_t size)
+{
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + size;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !readExtraLength(ip, end, literals)) return false;
+        if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(opEnd - op)) return false;
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The final sequence stops after its literals
+        if (ip == end) break;
+
+        if (end - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = token & 0x0F;
+        if (length == 15 && !readExtraLength(ip, end, length)) return false;
+        length += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) || length > static_cast<size_t>(opEnd - op)) {
+            return false;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            // Overlapping copy repeats the last offset bytes
+            for (size_t i = 0; i < length; i++) *op++ = match[i];
+        }
+    }
+    return op == opEnd;
+}
+
+bool lzDecode(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize)
+{
+    size_t pos = 0;
+    size_t out = 0;
+    while (pos < size) {
+        if (size - pos < LZEncoder::BLOCK_HEADER_SIZE) return false;
+        uint32_t raw = readLE32(src + pos);
+        uint32_t stored = readLE32(src + pos + 4);
+        pos += LZEncoder::BLOCK_HEADER_SIZE;
+        if (raw > LZEncoder::BLOCK_SIZE || stored > raw || stored > size - pos || raw > dstSize - out) return false;
+
+        if (stored == raw) {
+            std::memcpy(dst + out, src + pos, raw);
+        } else if (!decodeBlock(src + pos, src + pos + stored, dst + out, raw)) {
+            return false;
+        }
+        pos += stored;
+        out += raw;
+    }
+    return out == dstSize;
+}
+
+} // namespace zxspec
@@ -0,0 +1,71 @@
+/*
+ * lz_codec.hpp - Fast LZ77 compression for machine state
+ *
+ * A byte-oriented LZ77 codec in the style of LZ4: greedy matching through
+ * a small hash table, no entropy coding, and a decoder that is little more
+ * than a run of copies. Emulator state is mostly zeroed RAM, repeated
+ * attribute bytes and sparse buffers, which this compresses several times
+ * over at memory speed.
+ *
+ * A stream is a sequence of independent blocks of at most BLOCK_SIZE bytes:
+ *
+ *   block   raw size (4), stored size (4), stored bytes
+ *
+ * A block whose stored size equals its raw size didn't compress and is
+ * stored as is. Otherwise it is a series of sequences:
+ *
+ *   token (1)        high nibble literal count, low nibble match length - 4;
+ *                    15 in either is continued by bytes of 255 and a final
+ *                    byte below 255, all added together
+ *   literals
+ *   offset (2)       distance back to the match, 1..65535
+ *
+ * The last sequence of a block has literals only. LZEncoder writes blocks
+ * as data arrives, so compressing never needs the whole input in memory.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zxspec {
+
+class LZEncoder {
+public:
+    static constexpr uint32_t BLOCK_SIZE = 64 * 1024;
+    static constexpr uint32_t BLOCK_HEADER_SIZE = 8;
+
+    // Largest stored form of size raw bytes, headers included
+    static constexpr size_t maxEncodedSize(size_t size)
+    {
+        return size + (size / BLOCK_SIZE + 1) * BLOCK_HEADER_SIZE;
+    }
+
+    // Appends the compressed stream to out
+    explicit LZEncoder(std::vector<uint8_t>& out) : out_(out) {}
+
+    void write(const void* data, size_t size);
+    // Write out the last partial block
+    void finish();
+
+    // Compress one block (at most BLOCK_SIZE bytes) to dst, which must hold
+    // maxEncodedSize(size) bytes. Returns the bytes written, header included.
+    static size_t encodeBlock(const uint8_t* src, uint32_t size, uint8_t* dst);
+
+private:
+    void emitBlock(const uint8_t* src, uint32_t size);
+
+    std::vector<uint8_t>& out_;
+    std::vector<uint8_t> pending_;
+};
+
+// Total raw size of a stream, or SIZE_MAX if its block headers are damaged
+size_t lzDecodedSize(const uint8_t* src, size_t size);
+
+// Decode a whole stream into dst, which must be exactly its raw size.
+// Returns false if the stream is damaged or doesn't fill dst exactly.
+bool lzDecode(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize);
+
+} // namespace zxspec
@@ -0,0 +1,210 @@
+/*
+ * state_stream.hpp - Chunked binary machine state
+ *
+ * A machine state is a short header followed by one chunk per subsystem:
+ *
+ *   header  magic "ZXST", format version (2), machine id (1), reserved (1),
+ *           chunk count (4)
+ *   chunk   id (4, a four character tag), version (2), flags (2),
+ *           stored size (4), payload
+ *
+ * Each component writes its own chunk payload straight from its members:
+ * every field is trivially copyable and copied with memcpy in a fixed
+ * order, in host byte order, so saving and restoring is a run of copies
+ * with nothing to parse. Vectors are written as a 32-bit element count
+ * followed by the elements. Bools are stored as one byte and enums as 32
+ * bits, and both are range-checked on reading, so a corrupt state fails
+ * to load instead of producing a value the type cannot hold. Structs are
+ * copied whole and so must not contain bools or enums. A chunk's version changes whenever its layout
+ * does; readers skip chunks they don't know.
+ *
+ * A writer made with compress set stores each payload as an LZ stream
+ * (lz_codec.hpp), flagged CHUNK_COMPRESSED, compressing as the fields are
+ * written rather than from a finished copy of the state.
+ */
+
+#pragma once
+
+#include "lz_codec.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace zxspec {
+
+constexpr uint32_t stateChunkId(const char (&tag)[5])
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(tag[0]))
+         | static_cast<uint32_t>(static_cast<uint8_t>(tag[1])) << 8
+         | static_cast<uint32_t>(static_cast<uint8_t>(tag[2])) << 16
+         | static_cast<uint32_t>(static_cast<uint8_t>(tag[3])) << 24;
+}
+
+class StateWriter {
+public:
+    static constexpr uint8_t MAGIC[4] = { 'Z', 'X', 'S', 'T' };
+    static constexpr uint16_t FORMAT_VERSION = 2;     // 2 added chunk flags
+    static constexpr uint32_t HEADER_SIZE = 12;
+    static constexpr uint32_t CHUNK_HEADER_SIZE = 12;
+    static constexpr uint16_t CHUNK_COMPRESSED = 0x0001;
+
+    StateWriter(std::vector<uint8_t>& out, uint8_t machineId, bool compress = false)
+        : out_(out), compress_(compress)
+    {
+        out_.clear();
+        out_.resize(HEADER_SIZE, 0);
+        std::memcpy(out_.data(), MAGIC, 4);
+        std::memcpy(out_.data() + 4, &FORMAT_VERSION, 2);
+        out_[6] = machineId;
+    }
+
+    void beginChunk(uint32_t id, uint16_t version)
+    {
+        chunkStart_ = out_.size();
+        out_.resize(chunkStart_ + CHUNK_HEADER_SIZE, 0);
+        std::memcpy(out_.data() + chunkStart_, &id, 4);
+        std::memcpy(out_.data() + chunkStart_ + 4, &version, 2);
+        if (compress_) {
+            std::memcpy(out_.data() + chunkStart_ + 6, &CHUNK_COMPRESSED, 2);
+            encoder_.emplace(out_);
+        }
+    }
+
+    void endChunk()
+    {
+        if (encoder_) {
+            encoder_->finish();
+            encoder_.reset();
+        }
+        uint32_t size = static_cast<uint32_t>(out_.size() - chunkStart_ - CHUNK_HEADER_SIZE);
+        std::memcpy(out_.data() + chunkStart_ + 8, &size, 4);
+        chunkCount_++;
+        std::memcpy(out_.data() + 8, &chunkCount_, 4);
+    }
+
+    void bytes(const void* data, size_t size)
+    {
+        if (encoder_) {
+            encoder_->write(data, size);
+            return;
+        }
+        size_t at = out_.size();
+        out_.resize(at + size);
+        if (size > 0) std::memcpy(out_.data() + at, data, size);
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be memcpy-able");
+        if constexpr (std::is_same_v<T, bool>) {
+            write(static_cast<uint8_t>(value ? 1 : 0));
+        } else if constexpr (std::is_enum_v<T>) {
+            write(static_cast<uint32_t>(value));
+        } else {
+            bytes(&value, sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be memcpy-able");
+        write(static_cast<uint32_t>(values.size()));
+        bytes(values.data(), values.size() * sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    bool compress_;
+    std::optional<LZEncoder> encoder_;
+    size_t chunkStart_ = 0;
+    uint32_t chunkCount_ = 0;
+};
+
+// Reads one chunk's payload. A read past the end or out of range fails,
+// leaves its target untouched and makes ok() false for the rest of the
+// chunk.
+class StateReader {
+public:
+    StateReader(uint32_t id, uint16_t version, const uint8_t* data, uint32_t size)
+        : id_(id), version_(version), data_(data), size_(size) {}
+
+    uint32_t id() const { return id_; }
+    uint16_t version() const { return version_; }
+    uint32_t size() const { return size_; }
+    bool ok() const { return ok_; }
+    bool atEnd() const { return pos_ == size_; }
+
+    bool bytes(void* data, size_t size)
+    {
+        if (!ok_ || size > size_ - pos_) {
+            ok_ = false;
+            return false;
+        }
+        if (size > 0) std::memcpy(data, data_ + pos_, size);
+        pos_ += static_cast<uint32_t>(size);
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be memcpy-able");
+        static_assert(!std::is_enum_v<T>, "enums are read with read(value, last)");
+        if constexpr (std::is_same_v<T, bool>) {
+            uint8_t byte = 0;
+            if (!read(byte)) return false;
+            if (byte > 1) {
+                ok_ = false;
+                return false;
+            }
+            value = byte != 0;
+            return true;
+        } else {
+            return bytes(&value, sizeof(T));
+        }
+    }
+
+    // An enum is stored as a 32-bit value and must lie in 0..last
+    template <typename E>
+    bool read(E& value, E last)
+    {
+        static_assert(std::is_enum_v<E>, "only enums take a range");
+        uint32_t raw = 0;
+        if (!read(raw)) return false;
+        if (raw > static_cast<uint32_t>(last)) {
+            ok_ = false;
+            return false;
+        }
+        value = static_cast<E>(raw);
+        return true;
+    }
+
+    template <typename T>
+    bool read(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "state fields must be memcpy-able");
+        uint32_t count = 0;
+        if (!read(count)) return false;
+        if (count > (size_ - pos_) / sizeof(T)) {
+            ok_ = false;
+            return false;
+        }
+        values.resize(count);
+        return bytes(values.data(), count * sizeof(T));
+    }
+
+private:
+    uint32_t id_;
+    uint16_t version_;
+    const uint8_t* data_;
+    uint32_t size_;
+    uint32_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace zxspec
@@ -24,6 +24,7 @@ void Z80::initialise(MemReadFunc memRead, MemWriteFunc memWrite,
                      void* param)
 {
     m_Param = param;
+    m_Bus = Bus{};
     m_MemRead = memRead;
     m_MemWrite = memWrite;
     m_IORead = ioRead;
@@ -64,89 +65,18 @@ void Z80::registerRetnCallback(RetnCallback callback)
     m_RetnCallback = callback;
 }
 
-uint8_t Z80::z80OpcodeFetch(uint16_t address)
-{
-    z80MemContention(address, 4);
-
-    if (m_OpcodeFetch)
-    {
-        return m_OpcodeFetch(address, m_Param);
-    }
-
-    if (m_MemRead)
-    {
-        return m_MemRead(address, m_Param);
-    }
-
-    return 0;
-}
-
-uint8_t Z80::z80MemRead(uint16_t address, uint32_t tstates)
-{
-    z80MemContention(address, tstates);
-
-    if (m_MemRead)
-    {
-        return m_MemRead(address, m_Param);
-    }
-
-    return 0;
-}
-
-void Z80::z80MemWrite(uint16_t address, uint8_t data, uint32_t tstates)
-{
-    z80MemContention(address, tstates);
-
-    if (m_MemWrite)
-    {
-        m_MemWrite(address, data, m_Param);
-    }
-}
-
-uint8_t Z80::z80IORead(uint16_t address)
-{
-    if (m_IORead)
-    {
-        return m_IORead(address, m_Param);
-    }
-
-    return 0;
-}
-
-void Z80::z80IOWrite(uint16_t address, uint8_t data)
-{
-    if (m_IOWrite)
-    {
-        m_IOWrite(address, data, m_Param);
-    }
-}
-
-void Z80::z80MemContention(uint16_t address, uint32_t tstates)
-{
-    if (m_MemContentionHandling)
-    {
-        m_MemContentionHandling(address, tstates, m_Param);
-    }
-
-    m_CPURegisters.TStates += tstates;
-}
-
-void Z80::z80NoMreqContention(uint16_t address, uint32_t tstates)
-{
-    if (m_NoMreqContentionHandling)
-    {
-        m_NoMreqContentionHandling(address, tstates, m_Param);
-    }
-
-    m_CPURegisters.TStates += tstates;
-}
-
 uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
 {
     uint32_t tstates = m_CPURegisters.TStates;
+    m_BreakRequested = false;
 
     do
     {
+        m_InstructionStartTStates = m_CPURegisters.TStates;
+#if ZXSPEC_PROFILE
+        m_InstructionCount++;
+#endif
+
         if (m_CPURegisters.NMIReq)
         {
             m_CPURegisters.NMIReq = false;
@@ -227,7 +157,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
         m_CPURegisters.DDFDmultiByte = false;
         m_Iff2_read = false;
 
-        Z80OpcodeTable *table = &Main_Opcodes;
+        uint32_t opcodeSet = OPCODESET_Main;
 
         uint8_t opcode = z80OpcodeFetch(m_CPURegisters.regPC);
 
@@ -237,7 +167,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
         switch (opcode)
         {
             case 0xcb:
-                table = &CB_Opcodes;
+                opcodeSet = OPCODESET_CB;
 
                 opcode = z80OpcodeFetch(m_CPURegisters.regPC);
                 m_CPURegisters.regPC++;
@@ -252,7 +182,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
 
                 if (opcode == 0xcb)
                 {
-                    table = &DDCB_Opcodes;
+                    opcodeSet = OPCODESET_DDCB;
 
                     int8_t offset = z80MemRead(m_CPURegisters.regPC);
                     m_CPURegisters.regPC++;
@@ -263,12 +193,12 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
                 }
                 else
                 {
-                    table = &DD_Opcodes;
+                    opcodeSet = OPCODESET_DD;
                 }
                 break;
 
             case 0xed:
-                table = &ED_Opcodes;
+                opcodeSet = OPCODESET_ED;
 
                 opcode = z80OpcodeFetch(m_CPURegisters.regPC);
                 m_CPURegisters.regPC++;
@@ -283,7 +213,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
 
                 if (opcode == 0xcb)
                 {
-                    table = &FDCB_Opcodes;
+                    opcodeSet = OPCODESET_FDCB;
 
                     int8_t offset = z80MemRead(m_CPURegisters.regPC);
                     m_CPURegisters.regPC++;
@@ -294,7 +224,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
                 }
                 else
                 {
-                    table = &FD_Opcodes;
+                    opcodeSet = OPCODESET_FD;
                 }
                 break;
         }
@@ -308,13 +238,26 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
 
         if (!skip_instruction)
         {
-            if (table->entries[opcode].function != nullptr)
+#if Z80_FLAT_DISPATCH
+            const FlatOpcode& entry = Flat_Opcodes[(opcodeSet << 8) | opcode];
+
+            if (entry.function != nullptr)
             {
-                (this->*table->entries[opcode].function)(opcode);
+                entry.function(*this, opcode);
 
-                m_PrevOpcodeFlags = table->entries[opcode].flags;
+                m_PrevOpcodeFlags = entry.flags;
             }
-            else if (table == &ED_Opcodes)
+#else
+            const Z80Opcode& entry = Opcode_Tables[opcodeSet]->entries[opcode];
+
+            if (entry.function != nullptr)
+            {
+                (this->*entry.function)(opcode);
+
+                m_PrevOpcodeFlags = entry.flags;
+            }
+#endif
+            else if (opcodeSet == OPCODESET_ED)
             {
                 // Undefined ED opcodes are 8-T-state NOPs.
                 // The 8 T-states have already been consumed (4 for ED fetch + 4 for
@@ -331,7 +274,7 @@ uint32_t Z80::execute(uint32_t numTStates, uint32_t intTStates)
             }
         }
 
-    } while (m_CPURegisters.TStates - tstates < numTStates);
+    } while (m_CPURegisters.TStates - tstates < numTStates && !m_BreakRequested);
 
     return m_CPURegisters.TStates - tstates;
 }
@@ -357,7 +300,10 @@ void Z80::reset(bool hardReset)
     m_CPURegisters.Halted = false;
     m_CPURegisters.EIHandled = false;
     m_CPURegisters.IntReq = false;
+    m_CPURegisters.NMIReq = false;
+    m_CPURegisters.DDFDmultiByte = false;
     m_CPURegisters.TStates = 0;
+    m_MEMPTR = 0;
 
     if (hardReset)
     {
@@ -372,6 +318,59 @@ void Z80::reset(bool hardReset)
     }
 }
 
+// The register file goes field by field so the bools are stored as bytes
+// and checked when read back
+void Z80::saveState(StateWriter& writer) const
+{
+    const Z80State& r = m_CPURegisters;
+    writer.write(r.reg_pairs);
+    writer.write(r.regSP);
+    writer.write(r.regPC);
+    writer.write(r.regI);
+    writer.write(r.regR);
+    writer.write(r.IFF1);
+    writer.write(r.IFF2);
+    writer.write(r.IM);
+    writer.write(r.Halted);
+    writer.write(r.EIHandled);
+    writer.write(r.IntReq);
+    writer.write(r.NMIReq);
+    writer.write(r.DDFDmultiByte);
+    writer.write(r.TStates);
+    writer.write(m_MEMPTR);
+    writer.write(m_CPUType);
+    writer.write(m_PrevOpcodeFlags);
+    writer.write(m_Iff2_read);
+    writer.write(m_LD_I_A);
+    writer.write(m_InstructionStartTStates);
+}
+
+bool Z80::loadState(StateReader& reader)
+{
+    Z80State& r = m_CPURegisters;
+    reader.read(r.reg_pairs);
+    reader.read(r.regSP);
+    reader.read(r.regPC);
+    reader.read(r.regI);
+    reader.read(r.regR);
+    reader.read(r.IFF1);
+    reader.read(r.IFF2);
+    reader.read(r.IM);
+    reader.read(r.Halted);
+    reader.read(r.EIHandled);
+    reader.read(r.IntReq);
+    reader.read(r.NMIReq);
+    reader.read(r.DDFDmultiByte);
+    reader.read(r.TStates);
+    reader.read(m_MEMPTR);
+    reader.read(m_CPUType, CpuType::NMOS);
+    reader.read(m_PrevOpcodeFlags);
+    reader.read(m_Iff2_read);
+    reader.read(m_LD_I_A);
+    reader.read(m_InstructionStartTStates);
+    return reader.ok();
+}
+
 uint8_t Z80::getRegister(ByteReg reg) const
 {
     switch (reg)
@@ -13,6 +13,19 @@
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <utility>
+
+#include "../frame_profile.hpp"
+#include "../state_stream.hpp"
+
+// Opcode dispatch strategy, chosen at build time (see Z80_FLAT_DISPATCH in
+// CMakeLists.txt). 0 = per-prefix pointer-to-member tables, 1 = one flat
+// 1792-entry table of plain function pointers indexed by (prefix << 8) | opcode.
+// It changes the layout of Z80, so there is no default: every file built
+// into a target must see the same value.
+#ifndef Z80_FLAT_DISPATCH
+#error "Z80_FLAT_DISPATCH must be defined by the build (link z80_dispatch)"
+#endif
 
 namespace zxspec {
 
@@ -54,9 +67,34 @@ public:
     using OpcodeFetchFunc = std::function<uint8_t(uint16_t address, void* param)>;
     using RetnCallback = std::function<void()>;
 
+    // Compile-time bus binding. A bus policy is a type with static members
+    // memRead, memWrite, ioRead, ioWrite, contention and noMreqContention
+    // (plus an optional opcodeFetch) using the same signatures as the
+    // callbacks above. bindBus() stores them as plain function pointers so the
+    // per-cycle bus path skips std::function dispatch entirely.
+    struct Bus {
+        uint8_t (*memRead)(uint16_t address, void* param) = nullptr;
+        void (*memWrite)(uint16_t address, uint8_t data, void* param) = nullptr;
+        uint8_t (*opcodeFetch)(uint16_t address, void* param) = nullptr;
+        uint8_t (*ioRead)(uint16_t address, void* param) = nullptr;
+        void (*ioWrite)(uint16_t address, uint8_t data, void* param) = nullptr;
+        void (*contention)(uint16_t address, uint32_t tstates, void* param) = nullptr;
+        void (*noMreqContention)(uint16_t address, uint32_t tstates, void* param) = nullptr;
+    };
+
 private:
     static constexpr uint32_t OPCODEFLAG_AltersFlags = (1 << 0);
 
+    // Opcode sets, in flat table order
+    static constexpr uint32_t OPCODESET_Main = 0;
+    static constexpr uint32_t OPCODESET_CB = 1;
+    static constexpr uint32_t OPCODESET_DD = 2;
+    static constexpr uint32_t OPCODESET_ED = 3;
+    static constexpr uint32_t OPCODESET_FD = 4;
+    static constexpr uint32_t OPCODESET_DDCB = 5;
+    static constexpr uint32_t OPCODESET_FDCB = 6;
+    static constexpr uint32_t OPCODESET_Count = 7;
+
     struct Z80State {
         union {
             struct {
@@ -121,6 +159,17 @@ private:
         Z80Opcode entries[256];
     };
 
+#if Z80_FLAT_DISPATCH
+    // Flat dispatch entry: a plain function pointer, so the call needs no
+    // pointer-to-member decode or this-adjustment
+    using FlatHandler = void (*)(Z80& cpu, uint8_t opcode);
+
+    struct FlatOpcode {
+        FlatHandler function;
+        uint32_t flags;
+    };
+#endif
+
 public:
     Z80();
     ~Z80() = default;
@@ -131,14 +180,41 @@ public:
                     void* param);
 
     void reset(bool hardReset = true);
+
+    // Registers and internal latches (MEMPTR, LD A,I), not the bus bindings
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     uint32_t execute(uint32_t numTStates = 0, uint32_t intTStates = 32);
 
+    // Bind a bus policy (see Bus above). Takes precedence over the callbacks
+    // passed to initialise(); calling initialise() again clears the binding.
+    template <typename Policy>
+    void bindBus(void* param)
+    {
+        m_Bus.memRead = &Policy::memRead;
+        m_Bus.memWrite = &Policy::memWrite;
+        if constexpr (requires { &Policy::opcodeFetch; }) {
+            m_Bus.opcodeFetch = &Policy::opcodeFetch;
+        } else {
+            m_Bus.opcodeFetch = &Policy::memRead;
+        }
+        m_Bus.ioRead = &Policy::ioRead;
+        m_Bus.ioWrite = &Policy::ioWrite;
+        m_Bus.contention = &Policy::contention;
+        m_Bus.noMreqContention = &Policy::noMreqContention;
+        m_Param = param;
+    }
+    void unbindBus() { m_Bus = Bus{}; }
+    bool isBusBound() const { return m_Bus.memRead != nullptr; }
+
     void registerOpcodeCallback(OpcodeCallback callback);
     void registerOpcodeFetchCallback(OpcodeFetchFunc callback);
     void registerRetnCallback(RetnCallback callback);
     void signalInterrupt();
 
     bool isInterruptRequesting() const { return m_CPURegisters.IntReq; }
+    bool isNMIRequesting() const { return m_CPURegisters.NMIReq; }
 
     uint8_t getRegister(ByteReg reg) const;
     uint16_t getRegister(WordReg reg) const;
@@ -159,6 +235,20 @@ public:
 
     bool isLD_I_A() const { return m_LD_I_A; }
 
+    // Batch execution support. execute() records the T-state at which each
+    // instruction began so callers running many instructions per call can
+    // attribute mid-instruction peripheral accesses to the right instruction,
+    // and requestBreak() lets a callback end the current execute() call after
+    // the instruction in progress.
+    uint32_t getInstructionStartTStates() const { return m_InstructionStartTStates; }
+    void requestBreak() { m_BreakRequested = true; }
+
+#if ZXSPEC_PROFILE
+    // Running count of instructions executed, for the profiling bench. Not
+    // cleared by reset() and not part of the saved state.
+    uint64_t getInstructionCount() const { return m_InstructionCount; }
+#endif
+
     void addContentionTStates(uint32_t extra) { m_CPURegisters.TStates += extra; }
     void addTStates(uint32_t extra) { m_CPURegisters.TStates += extra; }
     uint32_t getTStates() const { return m_CPURegisters.TStates; }
@@ -793,13 +883,49 @@ protected:
 
 protected:
     // Opcode tables
-    static Z80OpcodeTable Main_Opcodes;
-    static Z80OpcodeTable CB_Opcodes;
-    static Z80OpcodeTable DD_Opcodes;
-    static Z80OpcodeTable ED_Opcodes;
-    static Z80OpcodeTable FD_Opcodes;
-    static Z80OpcodeTable DDCB_Opcodes;
-    static Z80OpcodeTable FDCB_Opcodes;
+    static const Z80OpcodeTable Main_Opcodes;
+    static const Z80OpcodeTable CB_Opcodes;
+    static const Z80OpcodeTable DD_Opcodes;
+    static const Z80OpcodeTable ED_Opcodes;
+    static const Z80OpcodeTable FD_Opcodes;
+    static const Z80OpcodeTable DDCB_Opcodes;
+    static const Z80OpcodeTable FDCB_Opcodes;
+
+#if Z80_FLAT_DISPATCH
+    // All seven tables flattened into one, built at compile time from the
+    // tables above (z80_opcode_tables.cpp)
+    static const std::array<FlatOpcode, OPCODESET_Count * 256> Flat_Opcodes;
+
+    template <const Z80OpcodeTable& Table, uint8_t Opcode>
+    static void flatHandler(Z80& cpu, uint8_t opcode)
+    {
+        (cpu.*(Table.entries[Opcode].function))(opcode);
+    }
+
+    // Whether an entry is empty is settled per entry at compile time, so the
+    // handler address is never itself tested against null
+    template <const Z80OpcodeTable& Table, size_t Opcode>
+    static constexpr FlatOpcode flatEntry()
+    {
+        constexpr auto function = Table.entries[Opcode].function;
+        if constexpr (function == nullptr) {
+            return { nullptr, Table.entries[Opcode].flags };
+        } else {
+            return { &flatHandler<Table, Opcode>, Table.entries[Opcode].flags };
+        }
+    }
+
+    template <const Z80OpcodeTable& Table, size_t... Opcodes>
+    static constexpr std::array<FlatOpcode, 256> flattenTable(std::index_sequence<Opcodes...>)
+    {
+        return { { flatEntry<Table, Opcodes>()... } };
+    }
+
+    static constexpr std::array<FlatOpcode, OPCODESET_Count * 256> buildFlatOpcodes();
+#else
+    // Indexed by OPCODESET_*
+    static const Z80OpcodeTable* const Opcode_Tables[OPCODESET_Count];
+#endif
 
     // CPU state
     Z80State m_CPURegisters;
@@ -810,9 +936,15 @@ protected:
     uint32_t m_PrevOpcodeFlags;
     bool m_Iff2_read = false;
     bool m_LD_I_A = false;
+    uint32_t m_InstructionStartTStates = 0;
+    bool m_BreakRequested = false;
+#if ZXSPEC_PROFILE
+    uint64_t m_InstructionCount = 0;
+#endif
 
     // Callbacks
     void* m_Param = nullptr;
+    Bus m_Bus;
     MemReadFunc m_MemRead;
     MemWriteFunc m_MemWrite;
     IoReadFunc m_IORead;
@@ -824,4 +956,117 @@ protected:
     RetnCallback m_RetnCallback;
 };
 
+// ============================================================================
+// Bus access - inline so the opcode handlers in every table TU get the bound
+// bus call without an extra out-of-line hop
+// ============================================================================
+
+inline void Z80::z80MemContention(uint16_t address, uint32_t tstates)
+{
+    if (m_Bus.contention)
+    {
+        m_Bus.contention(address, tstates, m_Param);
+    }
+    else if (m_MemContentionHandling)
+    {
+        m_MemContentionHandling(address, tstates, m_Param);
+    }
+
+    m_CPURegisters.TStates += tstates;
+}
+
+inline void Z80::z80NoMreqContention(uint16_t address, uint32_t tstates)
+{
+    if (m_Bus.noMreqContention)
+    {
+        m_Bus.noMreqContention(address, tstates, m_Param);
+    }
+    else if (m_NoMreqContentionHandling)
+    {
+        m_NoMreqContentionHandling(address, tstates, m_Param);
+    }
+
+    m_CPURegisters.TStates += tstates;
+}
+
+inline uint8_t Z80::z80OpcodeFetch(uint16_t address)
+{
+    z80MemContention(address, 4);
+
+    if (m_Bus.opcodeFetch)
+    {
+        return m_Bus.opcodeFetch(address, m_Param);
+    }
+
+    if (m_OpcodeFetch)
+    {
+        return m_OpcodeFetch(address, m_Param);
+    }
+
+    if (m_MemRead)
+    {
+        return m_MemRead(address, m_Param);
+    }
+
+    return 0;
+}
+
+inline uint8_t Z80::z80MemRead(uint16_t address, uint32_t tstates)
+{
+    z80MemContention(address, tstates);
+
+    if (m_Bus.memRead)
+    {
+        return m_Bus.memRead(address, m_Param);
+    }
+
+    if (m_MemRead)
+    {
+        return m_MemRead(address, m_Param);
+    }
+
+    return 0;
+}
+
+inline void Z80::z80MemWrite(uint16_t address, uint8_t data, uint32_t tstates)
+{
+    z80MemContention(address, tstates);
+
+    if (m_Bus.memWrite)
+    {
+        m_Bus.memWrite(address, data, m_Param);
+    }
+    else if (m_MemWrite)
+    {
+        m_MemWrite(address, data, m_Param);
+    }
+}
+
+inline uint8_t Z80::z80IORead(uint16_t address)
+{
+    if (m_Bus.ioRead)
+    {
+        return m_Bus.ioRead(address, m_Param);
+    }
+
+    if (m_IORead)
+    {
+        return m_IORead(address, m_Param);
+    }
+
+    return 0;
+}
+
+inline void Z80::z80IOWrite(uint16_t address, uint8_t data)
+{
+    if (m_Bus.ioWrite)
+    {
+        m_Bus.ioWrite(address, data, m_Param);
+    }
+    else if (m_IOWrite)
+    {
+        m_IOWrite(address, data, m_Param);
+    }
+}
+
 } // namespace zxspec
@@ -11,7 +11,7 @@
 
 namespace zxspec {
 
-Z80::Z80OpcodeTable Z80::FDCB_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::FDCB_Opcodes = {
 {
 	{ &Z80::LD_B_RLC_off_IX_IY_d   , Z80::OPCODEFLAG_AltersFlags,	"LD   B, RLC (IY + %O)" },
 	{ &Z80::LD_C_RLC_off_IX_IY_d   , Z80::OPCODEFLAG_AltersFlags,	"LD   C, RLC (IY + %O)" },
@@ -271,7 +271,7 @@ Z80::Z80OpcodeTable Z80::FDCB_Opcodes = {
 	{ &Z80::LD_A_SET_7_off_IX_IY_d , 0,								"LD   A,SET 7, (IY + %O)" }
 } };
 
-Z80::Z80OpcodeTable Z80::CB_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::CB_Opcodes = {
 {
 	{ &Z80::RLC_B               , Z80::OPCODEFLAG_AltersFlags,		"RLC  B"             },
 	{ &Z80::RLC_C               , Z80::OPCODEFLAG_AltersFlags,		"RLC  C"             },
@@ -532,7 +532,7 @@ Z80::Z80OpcodeTable Z80::CB_Opcodes = {
 } };
 
 
-Z80::Z80OpcodeTable Z80::DD_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::DD_Opcodes = {
 {
     { nullptr							 , 0,										nullptr                },
     { nullptr							 , 0,										nullptr                },
@@ -793,7 +793,7 @@ Z80::Z80OpcodeTable Z80::DD_Opcodes = {
 } };
 
 
-Z80::Z80OpcodeTable Z80::ED_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::ED_Opcodes = {
 {
     { nullptr							 , 0,										nullptr                },
     { nullptr							 , 0,										nullptr                },
@@ -1054,7 +1054,7 @@ Z80::Z80OpcodeTable Z80::ED_Opcodes = {
 } };
 
 
-Z80::Z80OpcodeTable Z80::FD_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::FD_Opcodes = {
 {
     { nullptr							 , 0,										nullptr					},
     { nullptr							 , 0,										nullptr					},
@@ -1315,7 +1315,7 @@ Z80::Z80OpcodeTable Z80::FD_Opcodes = {
 } };
 
 
-Z80::Z80OpcodeTable Z80::DDCB_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::DDCB_Opcodes = {
 {
 	{ &Z80::LD_B_RLC_off_IX_IY_d   , Z80::OPCODEFLAG_AltersFlags,		"LD   B, RLC (IX + %O)" },
 	{ &Z80::LD_C_RLC_off_IX_IY_d   , Z80::OPCODEFLAG_AltersFlags,		"LD   C, RLC (IX + %O)" },
@@ -1576,7 +1576,7 @@ Z80::Z80OpcodeTable Z80::DDCB_Opcodes = {
 }};
 
 
-Z80::Z80OpcodeTable Z80::Main_Opcodes = {
+constexpr Z80::Z80OpcodeTable Z80::Main_Opcodes = {
 	{
 		{ &Z80::NOP                 , 0,									"NOP"              },
 		{ &Z80::LD_BC_nn            , 0,									"LD   BC, %W"     },
@@ -1836,4 +1836,42 @@ Z80::Z80OpcodeTable Z80::Main_Opcodes = {
 		{ &Z80::RST_38H             , 0,									"RST  38H"          }
 	}
 };
+
+#if Z80_FLAT_DISPATCH
+
+constexpr std::array<Z80::FlatOpcode, Z80::OPCODESET_Count * 256> Z80::buildFlatOpcodes()
+{
+    // Same order as OPCODESET_*
+    const std::array<FlatOpcode, 256> sets[OPCODESET_Count] = {
+        flattenTable<Main_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<CB_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<DD_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<ED_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<FD_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<DDCB_Opcodes>(std::make_index_sequence<256>{}),
+        flattenTable<FDCB_Opcodes>(std::make_index_sequence<256>{}),
+    };
+
+    std::array<FlatOpcode, OPCODESET_Count * 256> flat{};
+    for (uint32_t set = 0; set < OPCODESET_Count; set++)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            flat[(set << 8) | i] = sets[set][i];
+        }
+    }
+    return flat;
+}
+
+constexpr std::array<Z80::FlatOpcode, Z80::OPCODESET_Count * 256> Z80::Flat_Opcodes = buildFlatOpcodes();
+
+#else
+
+const Z80::Z80OpcodeTable* const Z80::Opcode_Tables[OPCODESET_Count] = {
+    &Main_Opcodes, &CB_Opcodes, &DD_Opcodes, &ED_Opcodes,
+    &FD_Opcodes, &DDCB_Opcodes, &FDCB_Opcodes,
+};
+
+#endif
+
 } // namespace zxspec
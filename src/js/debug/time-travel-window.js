@@ -8,15 +8,15 @@
 import "../css/time-travel.css";
 import { BaseWindow } from "../windows/base-window.js";
 
-// Depth presets: { label, maxEntries } at 10 captures/sec
+// Depth presets: { label, maxEntries } at 50 captures/sec
 const DEPTH_PRESETS = [
-  { label: "15s", maxEntries: 150 },
-  { label: "30s", maxEntries: 300 },
-  { label: "1m",  maxEntries: 600 },
-  { label: "2.5m", maxEntries: 1500 },
+  { label: "15s", maxEntries: 750 },
+  { label: "30s", maxEntries: 1500 },
+  { label: "1m",  maxEntries: 3000 },
+  { label: "2.5m", maxEntries: 7500 },
 ];
 
-const CAPTURE_INTERVAL = 5; // frames between captures
+const CAPTURE_INTERVAL = 1; // frames between captures
 
 export class TimeTravelWindow extends BaseWindow {
   constructor(proxy) {
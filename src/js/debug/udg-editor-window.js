@@ -638,6 +638,20 @@ export class UDGEditorWindow extends BaseWindow {
     reader.readAsText(file);
   }
 
+  // ---- Window visibility ----
+
+  // The emulator only patches on-screen UDG cells while the editor is open,
+  // keeping that work off the CPU's memory write path the rest of the time
+  show() {
+    super.show();
+    this._proxy.udgPatchEnable(true);
+  }
+
+  hide() {
+    this._proxy.udgPatchEnable(false);
+    super.hide();
+  }
+
   // ---- Machine awareness ----
 
   // UDG editor is not available on +2A/+3 (machine IDs 3, 4) because
@@ -649,6 +663,9 @@ export class UDGEditorWindow extends BaseWindow {
     this._disabled = UDGEditorWindow._UNSUPPORTED_MACHINES.has(machineId);
     if (this._disabled && this.isVisible) {
       this.hide();
+    } else if (this.isVisible) {
+      // A new machine starts with screen patching off
+      this._proxy.udgPatchEnable(true);
     }
     // Update menu button visibility
     const btn = document.getElementById("btn-udg-editor");
@@ -908,6 +908,10 @@ export class EmulatorProxy {
     });
   }
 
+  udgPatchEnable(enable) {
+    this.worker.postMessage({ type: "udgPatchEnable", enable });
+  }
+
   traceEnable(enable) {
     this.worker.postMessage({ type: "traceEnable", enable });
   }
@@ -22,82 +22,76 @@ function withWasmBuffer(data, fn) {
   }
 }
 
-// ── Time-travel history ring buffer ──────────────────────────────────────────
+// ── Time-travel history ──────────────────────────────────────────────────────
+//
+// History lives in a native arena (see time_travel.hpp): a record of the
+// machine every few frames (a keyframe of all RAM, then deltas of the bytes
+// that changed) plus a journal of every input. Frames between records are
+// reached by replaying the journal from the record before them, so every
+// frame is scrubbable. Entries are frames, addressed by index here (0 is the
+// oldest reachable frame) and by frame number in the WASM module.
+
+// Native arena bytes per record; deltas average well under this
+const TIME_TRAVEL_BYTES_PER_RECORD = 16384;
+const TIME_TRAVEL_MIN_ARENA = 4 * 1024 * 1024;
+const TIME_TRAVEL_MAX_ARENA = 64 * 1024 * 1024;
+const TIME_TRAVEL_RECORD_INTERVAL = 5;     // frames between records
+const TIME_TRAVEL_KEYFRAME_INTERVAL = 20;  // records between keyframes
 
 const timeTravel = {
   enabled: false,
-  captureInterval: 5,   // capture every N frames (5 = ~10 snapshots/sec at 50fps)
-  maxEntries: 300,       // ring buffer capacity (300 @ 10/sec = 30 seconds)
-  entries: [],           // ring buffer of { frameNumber, stateData: Uint8Array }
-  head: 0,               // next write position
-  count: 0,              // number of valid entries
+  captureInterval: 1,   // scrub granularity in frames
+  maxEntries: 1500,      // history capacity (1500 @ 50/sec = 30 seconds)
+  count: 0,              // number of reachable frames
   framesSinceCapture: 0,
-  totalFrames: 0,        // monotonic frame counter
   isScrubbing: false,
 };
 
-function captureTimeTravelSnapshot() {
-  const sizePtr = wasm._malloc(4);
-  const statePtr = wasm._exportState(sizePtr);
-  const size = new DataView(wasm.HEAPU8.buffer, sizePtr, 4).getUint32(0, true);
-  wasm._free(sizePtr);
-  if (size === 0 || !statePtr) return;
-
-  const stateData = new Uint8Array(wasm.HEAPU8.buffer.slice(statePtr, statePtr + size));
-
-  // Capture tape + FDC state so scrubbing during loading works correctly
-  const tapePtr = wasm._tapeSnapshotState();
-  const tapeSize = wasm._tapeSnapshotSize();
-  const tapeState = tapePtr ? new Uint8Array(wasm.HEAPU8.buffer, tapePtr, tapeSize).slice() : null;
-
-  const fdcPtr = wasm._fdcSnapshotState();
-  const fdcSize = wasm._fdcSnapshotSize();
-  const fdcState = fdcPtr ? new Uint8Array(wasm.HEAPU8.buffer, fdcPtr, fdcSize).slice() : null;
-
-  timeTravel.entries[timeTravel.head] = {
-    frameNumber: timeTravel.totalFrames,
-    stateData,
-    tapeState,
-    fdcState,
-  };
-  timeTravel.head = (timeTravel.head + 1) % timeTravel.maxEntries;
-  if (timeTravel.count < timeTravel.maxEntries) {
-    timeTravel.count++;
+function configureTimeTravel() {
+  // The slack keeps the full depth while the oldest group waits for eviction
+  const maxRecords = Math.ceil(timeTravel.maxEntries / TIME_TRAVEL_RECORD_INTERVAL)
+    + TIME_TRAVEL_KEYFRAME_INTERVAL;
+  const arenaBytes = Math.min(TIME_TRAVEL_MAX_ARENA,
+    Math.max(TIME_TRAVEL_MIN_ARENA, maxRecords * TIME_TRAVEL_BYTES_PER_RECORD));
+  wasm._timeTravelConfigure(arenaBytes, maxRecords, TIME_TRAVEL_KEYFRAME_INTERVAL);
+  timeTravel.count = 0;
+  timeTravel.framesSinceCapture = 0;
+}
+
+function updateTimeTravelCount() {
+  if (wasm._timeTravelCount() === 0) {
+    timeTravel.count = 0;
+    return;
   }
+  const frames = wasm._timeTravelNewestFrame() - wasm._timeTravelOldestFrame() + 1;
+  timeTravel.count = Math.min(frames, timeTravel.maxEntries);
 }
 
-function getTimeTravelEntry(index) {
-  if (index < 0 || index >= timeTravel.count) return null;
-  const start = (timeTravel.head - timeTravel.count + timeTravel.maxEntries) % timeTravel.maxEntries;
-  return timeTravel.entries[(start + index) % timeTravel.maxEntries];
+function captureTimeTravelSnapshot() {
+  wasm._timeTravelCapture();
+  updateTimeTravelCount();
 }
 
-function truncateTimeTravelAfter(index) {
-  if (index < 0 || index >= timeTravel.count) return;
-  const keepCount = index + 1;
-  const start = (timeTravel.head - timeTravel.count + timeTravel.maxEntries) % timeTravel.maxEntries;
-  timeTravel.head = (start + keepCount) % timeTravel.maxEntries;
-  timeTravel.count = keepCount;
+function timeTravelFrameAt(index) {
+  if (index < 0 || index >= timeTravel.count) return -1;
+  return wasm._timeTravelNewestFrame() - (timeTravel.count - 1) + index;
 }
 
 function clearTimeTravelBuffer() {
-  timeTravel.entries = [];
-  timeTravel.head = 0;
+  if (wasm) wasm._timeTravelClear();
   timeTravel.count = 0;
   timeTravel.framesSinceCapture = 0;
-  timeTravel.totalFrames = 0;
 }
 
 function getTimeTravelStatusObj() {
-  const oldest = timeTravel.count > 0 ? getTimeTravelEntry(0) : null;
-  const newest = timeTravel.count > 0 ? getTimeTravelEntry(timeTravel.count - 1) : null;
+  const hasHistory = timeTravel.count > 0;
   return {
     enabled: timeTravel.enabled,
     count: timeTravel.count,
     maxEntries: timeTravel.maxEntries,
     captureInterval: timeTravel.captureInterval,
-    oldestFrame: oldest ? oldest.frameNumber : 0,
-    newestFrame: newest ? newest.frameNumber : 0,
+    oldestFrame: hasHistory ? timeTravelFrameAt(0) : 0,
+    newestFrame: hasHistory ? wasm._timeTravelNewestFrame() : 0,
   };
 }
 
@@ -513,11 +507,10 @@ function runFrames(count) {
 
   // Time-travel: capture state snapshot after frame is fully sent
   if (timeTravel.enabled && !timeTravel.isScrubbing) {
-    timeTravel.totalFrames += totalFrames;
     timeTravel.framesSinceCapture += totalFrames;
-    if (timeTravel.framesSinceCapture >= timeTravel.captureInterval) {
-      timeTravel.framesSinceCapture = 0;
+    if (timeTravel.framesSinceCapture >= TIME_TRAVEL_RECORD_INTERVAL) {
       captureTimeTravelSnapshot();
+      timeTravel.framesSinceCapture = 0;
     }
   }
 }
@@ -1508,6 +1501,12 @@ self.onmessage = async function (e) {
       break;
     }
 
+    case "udgPatchEnable": {
+      if (!wasm) break;
+      wasm._udgPatchEnable(msg.enable ? 1 : 0);
+      break;
+    }
+
     case "traceEnable": {
       if (!wasm) break;
       wasm._traceEnable(msg.enable ? 1 : 0);
@@ -1540,7 +1539,12 @@ self.onmessage = async function (e) {
       timeTravel.enabled = !!msg.enabled;
       if (msg.captureInterval) timeTravel.captureInterval = msg.captureInterval;
       if (msg.maxEntries) timeTravel.maxEntries = msg.maxEntries;
-      if (!timeTravel.enabled) clearTimeTravelBuffer();
+      if (timeTravel.enabled) {
+        configureTimeTravel();
+      } else {
+        wasm._timeTravelConfigure(0, 1, TIME_TRAVEL_KEYFRAME_INTERVAL);  // free the arena
+        clearTimeTravelBuffer();
+      }
       sendTimeTravelStatus();
       break;
     }
@@ -1549,30 +1553,21 @@ self.onmessage = async function (e) {
       if (!timeTravel.enabled || timeTravel.count === 0) break;
       timeTravel.isScrubbing = true;
       wasm._setPaused(true);
+
+      // Record the live frame so scrubbing back to the end returns to it
+      captureTimeTravelSnapshot();
+      timeTravel.framesSinceCapture = 0;
       sendTimeTravelStatus();
       break;
     }
 
     case "timeTravelScrubTo": {
       if (!timeTravel.isScrubbing) break;
-      const entry = getTimeTravelEntry(msg.index);
-      if (!entry) break;
+      const frameNumber = timeTravelFrameAt(msg.index);
+      if (frameNumber < 0) break;
 
-      withWasmBuffer(entry.stateData, (statePtr, len) =>
-        wasm._importState(statePtr, len));
-
-      // Restore tape + FDC state so loading can resume correctly
-      if (entry.tapeState) {
-        withWasmBuffer(entry.tapeState, (tapePtr, len) =>
-          wasm._tapeRestoreState(tapePtr, len));
-      }
-      if (entry.fdcState) {
-        withWasmBuffer(entry.fdcState, (fdcPtr, len) =>
-          wasm._fdcRestoreState(fdcPtr, len));
-      }
-
-      // Re-assert pause — importState restores machine state which clears it
-      wasm._setPaused(true);
+      // Restores RAM, CPU, tape and FDC state; the pause is kept
+      if (!wasm._timeTravelSeek(frameNumber)) break;
 
       wasm._renderDisplay();
       const fbPtr = wasm._getFramebuffer();
@@ -1585,7 +1580,7 @@ self.onmessage = async function (e) {
       self.postMessage({
         type: "timeTravelFrame",
         index: msg.index,
-        frameNumber: entry.frameNumber,
+        frameNumber,
         framebuffer,
         signalBuffer,
         state: getState(),
@@ -1598,23 +1593,14 @@ self.onmessage = async function (e) {
       timeTravel.isScrubbing = false;
 
       if (msg.resume && msg.index !== undefined) {
-        // Resume from scrubbed point — state + tape already restored by last scrubTo
-        truncateTimeTravelAfter(msg.index);
-      } else {
-        // Cancel — restore to latest state (machine + tape)
-        const latest = getTimeTravelEntry(timeTravel.count - 1);
-        if (latest) {
-          withWasmBuffer(latest.stateData, (ptr, len) =>
-            wasm._importState(ptr, len));
-          if (latest.tapeState) {
-            withWasmBuffer(latest.tapeState, (tapePtr, len) =>
-              wasm._tapeRestoreState(tapePtr, len));
-          }
-          if (latest.fdcState) {
-            withWasmBuffer(latest.fdcState, (fdcPtr, len) =>
-              wasm._fdcRestoreState(fdcPtr, len));
-          }
-        }
+        // Resume from scrubbed point — state already restored by last scrubTo
+        const frameNumber = timeTravelFrameAt(msg.index);
+        if (frameNumber >= 0) wasm._timeTravelTruncateAfter(frameNumber);
+        captureTimeTravelSnapshot();
+        timeTravel.framesSinceCapture = 0;
+      } else if (timeTravel.count > 0) {
+        // Cancel — restore to latest state
+        wasm._timeTravelSeek(wasm._timeTravelNewestFrame());
       }
 
       wasm._clearBreakpointHit();
@@ -84,7 +84,7 @@ export class SaveStatesWindow extends BaseWindow {
           ${slotsHtml}
         </div>
         <div class="save-states-toolbar">
-          <input type="file" accept=".z80" style="display:none" class="load-file-input" />
+          <input type="file" accept=".zxst,.z80" style="display:none" class="load-file-input" />
           <input type="file" accept=".zip" style="display:none" class="import-zip-input" />
           <button class="slot-btn load-file-btn">Load from File...</button>
           <button class="slot-btn export-all-btn">Export All Slots</button>
@@ -314,7 +314,7 @@ export class SaveStatesWindow extends BaseWindow {
     const slotData = await loadStateFromSlot(slot);
     if (!slotData) return;
     const name = (slotData.name || `Slot ${slot}`).replace(/[^a-zA-Z0-9_\- ]/g, "").trim().replace(/\s+/g, "-");
-    this.downloadBlob(slotData.data, `${name}.z80`);
+    this.downloadBlob(slotData.data, `${name}.zxst`);
   }
 
   async handleLoadAutosave() {
@@ -327,10 +327,10 @@ export class SaveStatesWindow extends BaseWindow {
   async handleDownloadAutosave() {
     const data = await loadStateFromStorage();
     if (!data) return;
-    this.downloadBlob(data, "zxspectrum-autosave.z80");
+    this.downloadBlob(data, "zxspectrum-autosave.zxst");
   }
 
-  async downloadBlob(data, filename, ext = ".z80", desc = "Z80 Snapshot") {
+  async downloadBlob(data, filename, ext = ".zxst", desc = "Machine State") {
     const blob = new Blob([data], { type: "application/octet-stream" });
 
     if (window.showSaveFilePicker) {
@@ -363,7 +363,7 @@ export class SaveStatesWindow extends BaseWindow {
     reader.onload = async () => {
       const data = new Uint8Array(reader.result);
 
-      // Basic Z80 format validation: minimum header size
+      // Basic validation: minimum header size
       if (data.length < 30) {
         console.error("Invalid state file: too small");
         return;
@@ -394,7 +394,7 @@ export class SaveStatesWindow extends BaseWindow {
         return;
       }
 
-      // Build ZIP entries: manifest.json + per-slot .z80 and thumbnails
+      // Build ZIP entries: manifest.json + per-slot .zxst and thumbnails
       const manifest = [];
       const zipEntries = [];
 
@@ -411,9 +411,9 @@ export class SaveStatesWindow extends BaseWindow {
           savedAt: info.savedAt || Date.now(),
         });
 
-        // State data (.z80 binary)
+        // State data (.zxst binary)
         zipEntries.push({
-          name: `slot-${slotNum}.z80`,
+          name: `slot-${slotNum}.zxst`,
           data: new Uint8Array(fullSlot.data),
         });
 
@@ -474,8 +474,9 @@ export class SaveStatesWindow extends BaseWindow {
         const slotNum = slotInfo.slot;
         if (slotNum < 1 || slotNum > SLOT_COUNT) continue;
 
-        // Find the .z80 data
-        const stateEntry = entries.find(e => e.name === `slot-${slotNum}.z80`);
+        // Find the state data (.z80 in archives from older versions)
+        const stateEntry = entries.find(e => e.name === `slot-${slotNum}.zxst`)
+          || entries.find(e => e.name === `slot-${slotNum}.z80`);
         if (!stateEntry || stateEntry.data.length < 30) continue;
 
         // Find thumbnail and preview (optional)
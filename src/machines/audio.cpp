@@ -6,6 +6,10 @@
  */
 
 #include "audio.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
 
 namespace zxspec {
 
@@ -16,12 +20,14 @@ Audio::Audio() = default;
 // For the 48K: 48000 Hz / 50.08 fps ≈ 958.7 samples per frame.
 // With 69,888 T-states per frame: 69888 / 958.7 ≈ 72.9 T-states per sample.
 //
-// The fractional accumulator in update() handles the non-integer ratio
-// smoothly, producing exactly the right number of samples per frame.
+// Sample times are kept as a fractional T-state position, so the
+// non-integer ratio produces exactly the right number of samples per frame
+// on average without drift.
 void Audio::setup(int sampleRate, double framesPerSecond, int tStatesPerFrame)
 {
     double samplesPerFrame = static_cast<double>(sampleRate) / framesPerSecond;
     beeperTsStep_ = static_cast<double>(tStatesPerFrame) / samplesPerFrame;
+    edges_.reserve(1024);
     reset();
 }
 
@@ -32,59 +38,184 @@ void Audio::reset()
     tapeEarBit_ = 0;
     specdrumLevel_ = 0.0f;
     sampleIndex_ = 0;
-    tsCounter_ = 0.0;
-    outputLevel_ = 0.0;
+    level_ = 0.0f;
+    baseLevel_ = 0.0f;
+    edges_.clear();
+    frameTs_ = 0;
+    nextSampleTs_ = beeperTsStep_;
     waveformWritePos_ = 0;
     for (int i = 0; i < WAVEFORM_BUFFER_SIZE; i++) waveformBuffer_[i] = 0.0f;
 }
 
-// Advance the audio accumulator by the given number of T-states.
+void Audio::saveState(StateWriter& writer) const
+{
+    writer.write(earBit_);
+    writer.write(micBit_);
+    writer.write(tapeEarBit_);
+    writer.write(specdrumLevel_);
+    writer.write(level_);
+    writer.write(baseLevel_);
+    writer.write(edges_);
+    writer.write(frameTs_);
+    writer.write(nextSampleTs_);
+    writer.write(sampleIndex_);
+    writer.write(sampleBuffer_);
+    writer.write(waveformWritePos_);
+    writer.write(waveformBuffer_);
+}
+
+bool Audio::loadState(StateReader& reader)
+{
+    reader.read(earBit_);
+    reader.read(micBit_);
+    reader.read(tapeEarBit_);
+    reader.read(specdrumLevel_);
+    reader.read(level_);
+    reader.read(baseLevel_);
+    reader.read(edges_);
+    reader.read(frameTs_);
+    reader.read(nextSampleTs_);
+    reader.read(sampleIndex_);
+    reader.read(sampleBuffer_);
+    reader.read(waveformWritePos_);
+    reader.read(waveformBuffer_);
+    sampleIndex_ = std::clamp(sampleIndex_, 0, MAX_SAMPLES_PER_FRAME);
+    waveformWritePos_ = std::clamp(waveformWritePos_, 0, WAVEFORM_BUFFER_SIZE - 1);
+    return reader.ok();
+}
+
+// Record a level change at the current T-state. The machine catches the
+// audio clock up with update() before it changes a level, so the edge lands
+// where the change took effect. Changes made without the clock moving (for
+// example while instant-loading a tape, when update() is not called) replace
+// each other rather than piling up.
+void Audio::addEdge(float level)
+{
+    if (!edges_.empty() && edges_.back().ts == frameTs_)
+    {
+        edges_.back().level = level;
+        return;
+    }
+    edges_.push_back({ frameTs_, level });
+}
+
+// The integrated band-limited step: BLEP_TAPS samples of a Blackman-windowed
+// sinc (cut off at 0.45 of the sample rate) summed and normalised to rise
+// from 0 to 1, sampled at BLEP_PHASES points per output sample.
+const float* Audio::blepTable()
+{
+    static const auto table = [] {
+        constexpr int size = BLEP_TAPS * BLEP_PHASES;
+        constexpr double pi = 3.14159265358979323846;
+        constexpr double cutoff = 0.45;
+
+        std::array<double, size + 1> impulse{};
+        double total = 0.0;
+        for (int i = 0; i <= size; i++)
+        {
+            double t = static_cast<double>(i) / BLEP_PHASES - BLEP_TAPS / 2.0;
+            double sinc = (t == 0.0) ? 1.0 : std::sin(2.0 * pi * cutoff * t) / (2.0 * pi * cutoff * t);
+            double w = static_cast<double>(i) / size;
+            double window = 0.42 - 0.5 * std::cos(2.0 * pi * w) + 0.08 * std::cos(4.0 * pi * w);
+            impulse[i] = sinc * window;
+            total += impulse[i];
+        }
+
+        std::array<float, size + 1> step{};
+        double sum = 0.0;
+        for (int i = 0; i <= size; i++)
+        {
+            sum += impulse[i];
+            step[i] = static_cast<float>(sum / total);
+        }
+        return step;
+    }();
+    return table.data();
+}
+
+// Synthesise every output sample due up to the current T-state.
+//
+// The output is the sum of the level before the first pending edge and each
+// pending edge's change of level weighted by a step shape S(x), where x is
+// how many samples the sample time lies after the edge:
 //
-// Uses a simple box-averaging approach: for each T-state, we accumulate the
-// current beeper level. When enough T-states have elapsed to fill one audio
-// sample (~72.9 T-states for 48K), we average the accumulated level and emit
-// a sample. The fractional remainder carries over to the next sample period,
-// ensuring smooth timing without drift.
+//   box (default):  S rises linearly over one sample, which is exactly the
+//                   average of the level across the sample period
+//   band-limited:   S is the windowed-sinc step from blepTable(), spread over
+//                   BLEP_TAPS samples (so output lags by BLEP_TAPS / 2)
 //
-// This is called after every CPU instruction with the instruction's T-state
-// count, so the beeper output faithfully tracks rapid bit-banging.
-void Audio::update(int32_t tStates)
+// Once an edge is a whole step width behind the sample time its weight is 1
+// and it is folded into the base level. Whatever is still pending at the end
+// of the frame is carried over with its time rebased to the next frame.
+// Without output only the edges are folded in as the sample time passes.
+void Audio::synthesise(bool output)
 {
-    // Current output level: beeper contributes BEEPER_VOLUME when EAR bit is set,
-    // tape playback adds TAPE_VOLUME when active, SpecDrum DAC adds its level
-    float level = (earBit_ ? BEEPER_VOLUME : 0.0f)
-               + (tapeEarBit_ ? TAPE_VOLUME : 0.0f)
-               + specdrumLevel_;
+    const float* blep = bandLimited_ ? blepTable() : nullptr;
+    const double width = bandLimited_ ? BLEP_TAPS : 1.0;
+    const double samplesPerTs = 1.0 / beeperTsStep_;
+    const size_t edgeCount = edges_.size();
+    size_t consumed = 0;
 
-    for (int32_t i = 0; i < tStates; i++)
+    while (nextSampleTs_ <= frameTs_)
     {
-        tsCounter_ += 1.0;
-        outputLevel_ += static_cast<double>(level);
+        double t = nextSampleTs_;
+        nextSampleTs_ += beeperTsStep_;
 
-        // Have we accumulated enough T-states for one audio sample?
-        if (tsCounter_ >= beeperTsStep_)
+        while (consumed < edgeCount && (t - edges_[consumed].ts) * samplesPerTs >= width)
         {
-            if (sampleIndex_ < MAX_SAMPLES_PER_FRAME)
-            {
-                // Average the accumulated level over the sample period
-                float sample = static_cast<float>(outputLevel_ / tsCounter_);
-                sampleBuffer_[sampleIndex_++] = sample;
+            baseLevel_ = edges_[consumed++].level;
+        }
+        if (!output) continue;
 
-                // Store in waveform ring buffer for debug display
-                waveformBuffer_[waveformWritePos_] = sample;
-                waveformWritePos_ = (waveformWritePos_ + 1) % WAVEFORM_BUFFER_SIZE;
+        float sample = baseLevel_;
+        float previous = baseLevel_;
+        for (size_t i = consumed; i < edgeCount && edges_[i].ts < t; i++)
+        {
+            double x = (t - edges_[i].ts) * samplesPerTs;
+            float weight;
+            if (blep)
+            {
+                double pos = x * BLEP_PHASES;
+                int index = static_cast<int>(pos);
+                float frac = static_cast<float>(pos - index);
+                weight = blep[index] + (blep[index + 1] - blep[index]) * frac;
+            }
+            else
+            {
+                weight = static_cast<float>(x);
             }
-            // Carry the fractional remainder into the next sample period,
-            // preserving the current level contribution for the overflow portion
-            tsCounter_ -= beeperTsStep_;
-            outputLevel_ = static_cast<double>(level) * tsCounter_;
+            sample += (edges_[i].level - previous) * weight;
+            previous = edges_[i].level;
+        }
+
+        if (sampleIndex_ < MAX_SAMPLES_PER_FRAME)
+        {
+            sampleBuffer_[sampleIndex_++] = sample;
+
+            // Store in waveform ring buffer for debug display
+            waveformBuffer_[waveformWritePos_] = sample;
+            waveformWritePos_ = (waveformWritePos_ + 1) % WAVEFORM_BUFFER_SIZE;
         }
     }
+
+    // Rebase the pending edges and the next sample time onto the next frame
+    edges_.erase(edges_.begin(), edges_.begin() + static_cast<std::ptrdiff_t>(consumed));
+    for (Edge& edge : edges_)
+    {
+        edge.ts -= frameTs_;
+    }
+    nextSampleTs_ -= frameTs_;
+    frameTs_ = 0;
 }
 
 void Audio::frameEnd()
 {
-    // Accumulator carries over naturally — no flush needed
+    synthesise(true);
+}
+
+void Audio::skipFrame()
+{
+    synthesise(false);
 }
 
 void Audio::getWaveform(float* buf, int count) const
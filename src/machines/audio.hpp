@@ -1,13 +1,22 @@
 /*
  * audio.hpp - Audio subsystem (beeper) shared across machine variants
  *
+ * The beeper output is a step signal that only changes when the EAR bit,
+ * the tape EAR level or the SpecDrum DAC changes. Each change is recorded
+ * as an edge at its T-state, and update() only advances the clock, so the
+ * per-instruction cost is a couple of adds. At frame end the 48 kHz samples
+ * are synthesised from the edge list, so the work scales with the number of
+ * edges and samples rather than T-states.
+ *
  * Written by
  *  Mike Daley <michael_daley@icloud.com>
  */
 
 #pragma once
 
+#include "../core/state_stream.hpp"
 #include <cstdint>
+#include <vector>
 
 namespace zxspec {
 
@@ -18,21 +27,37 @@ public:
 
     void setup(int sampleRate, double framesPerSecond, int tStatesPerFrame);
     void reset();
-    void update(int32_t tStates);
+    void update(int32_t tStates) { frameTs_ += tStates; }
+
+    // Port bits, pending edges and this frame's samples; not the settings
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     void frameEnd();
 
-    void setEarBit(uint8_t bit) { earBit_ = bit; }
+    // frameEnd() for a frame nobody hears: the edges and the sample clock
+    // advance the same way, so the next frame sounds the same, but no
+    // samples are made
+    void skipFrame();
+
+    void setEarBit(uint8_t bit) { earBit_ = bit; levelChanged(); }
     uint8_t getEarBit() const { return earBit_; }
 
     void setMicBit(uint8_t bit) { micBit_ = bit; }
     uint8_t getMicBit() const { return micBit_; }
 
-    void setTapeEarBit(uint8_t bit) { tapeEarBit_ = bit; }
+    void setTapeEarBit(uint8_t bit) { tapeEarBit_ = bit; levelChanged(); }
 
-    // SpecDrum 8-bit DAC output (added to beeper level each T-state)
-    void setSpecdrumLevel(float level) { specdrumLevel_ = level; }
+    // SpecDrum 8-bit DAC output (added to the beeper level)
+    void setSpecdrumLevel(float level) { specdrumLevel_ = level; levelChanged(); }
     float getSpecdrumLevel() const { return specdrumLevel_; }
 
+    // Band-limited output: each edge is drawn with a windowed-sinc step
+    // instead of a box average, which removes most of the aliasing from
+    // square waves at the cost of BLEP_TAPS / 2 samples of latency
+    void setBandLimited(bool enabled) { bandLimited_ = enabled; }
+    bool isBandLimited() const { return bandLimited_; }
+
     const float* getBuffer() const { return sampleBuffer_; }
     float* getMutableBuffer() { return sampleBuffer_; }
     int getSampleCount() const { return sampleIndex_; }
@@ -64,9 +89,35 @@ private:
     float waveformBuffer_[WAVEFORM_BUFFER_SIZE]{};
     int waveformWritePos_ = 0;
 
-    double tsCounter_ = 0.0;
-    double outputLevel_ = 0.0;
+    // A change of output level at a T-state relative to the current frame
+    struct Edge {
+        int32_t ts;
+        float level;                // Level from ts onwards
+    };
+
+    // Samples per band-limited step, and table entries per sample
+    static constexpr int BLEP_TAPS = 16;
+    static constexpr int BLEP_PHASES = 64;
+
+    void levelChanged()
+    {
+        float level = (earBit_ ? BEEPER_VOLUME : 0.0f)
+                    + (tapeEarBit_ ? TAPE_VOLUME : 0.0f)
+                    + specdrumLevel_;
+        if (level != level_) addEdge(level);
+        level_ = level;
+    }
+    void addEdge(float level);
+    void synthesise(bool output);
+    static const float* blepTable();
+
+    float level_ = 0.0f;            // Level after the last edge
+    float baseLevel_ = 0.0f;        // Level before the first unconsumed edge
+    std::vector<Edge> edges_;
+    int32_t frameTs_ = 0;           // T-states advanced by update() this frame
+    double nextSampleTs_ = 0.0;     // Time of the next output sample this frame
     double beeperTsStep_ = 0.0;
+    bool bandLimited_ = false;
 };
 
 } // namespace zxspec
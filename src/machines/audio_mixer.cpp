@@ -0,0 +1,203 @@
+/*
+ * audio_mixer.cpp - Frame-end mixing of the beeper, AY and speech outputs
+ */
+
+#include "audio_mixer.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace zxspec {
+
+// Write count frames of left/right pairs to dst, four frames per step where
+// SIMD is available
+static inline void interleave(float* dst, const float* left, const float* right, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t lr = { { vld1q_f32(left + i), vld1q_f32(right + i) } };
+        vst2q_f32(dst + i * 2, lr);
+    }
+#elif defined(__wasm_simd128__)
+    for (; i + 4 <= count; i += 4) {
+        v128_t l = wasm_v128_load(left + i);
+        v128_t r = wasm_v128_load(right + i);
+        wasm_v128_store(dst + i * 2, wasm_i32x4_shuffle(l, r, 0, 4, 1, 5));
+        wasm_v128_store(dst + i * 2 + 4, wasm_i32x4_shuffle(l, r, 2, 6, 3, 7));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i * 2] = left[i];
+        dst[i * 2 + 1] = right[i];
+    }
+}
+
+void AudioMixer::reset()
+{
+    frameCount_ = 0;
+    for (int side = 0; side < 2; side++) {
+        dcInput_[side] = 0.0f;
+        dcOutput_[side] = 0.0f;
+    }
+}
+
+void AudioMixer::saveState(StateWriter& writer) const
+{
+    writer.write(dcInput_);
+    writer.write(dcOutput_);
+    writer.write(frameCount_);
+    writer.write(stereoBuffer_);
+}
+
+bool AudioMixer::loadState(StateReader& reader)
+{
+    reader.read(dcInput_);
+    reader.read(dcOutput_);
+    reader.read(frameCount_);
+    reader.read(stereoBuffer_);
+    frameCount_ = std::clamp(frameCount_, 0, MAX_FRAMES);
+    return reader.ok();
+}
+
+void AudioMixer::setGain(Source source, float gain)
+{
+    if (source >= 0 && source < SourceCount) gains_[source] = std::max(0.0f, gain);
+}
+
+float AudioMixer::getGain(Source source) const
+{
+    if (source >= 0 && source < SourceCount) return gains_[source];
+    return 0.0f;
+}
+
+// ============================================================================
+// Mixing
+// ============================================================================
+
+void AudioMixer::mix(const Inputs& inputs, int start)
+{
+    int end = std::min(inputs.beeperCount, MAX_FRAMES);
+    if (start < 0) start = 0;
+    if (start >= end) {
+        if (stereoEnabled_) frameCount_ = std::max(frameCount_, end);
+        return;
+    }
+
+    // The web front end plays the mono buffer and never enables stereo, so
+    // there this is the only stereo work done per frame
+    if (stereoEnabled_) mixStereo(inputs, start, end);
+
+    // Mono output, summed in the same order as before the mixer existed so
+    // that at unity gain it is unchanged
+    float beeperGain = gains_[SourceBeeper];
+    float ayGain = gains_[SourceAY];
+    float speechGain = gains_[SourceSpeech];
+    for (int i = start; i < end; i++) {
+        inputs.beeper[i] *= beeperGain;
+    }
+    if (inputs.ay) {
+        int ayEnd = std::min(inputs.ayCount, end);
+        for (int i = start; i < ayEnd; i++) {
+            inputs.beeper[i] += inputs.ay[i] * ayGain;
+        }
+    }
+    if (inputs.speech) {
+        int speechEnd = std::min(inputs.speechCount, end);
+        for (int i = start; i < speechEnd; i++) {
+            inputs.beeper[i] += inputs.speech[i] * speechGain;
+        }
+    }
+}
+
+// Beeper and speech are centred; the AY is panned. Reads the sources before
+// the mono mix scales the beeper in place.
+void AudioMixer::mixStereo(const Inputs& inputs, int start, int end)
+{
+    float beeperGain = gains_[SourceBeeper];
+    float speechGain = gains_[SourceSpeech];
+    int count = end - start;
+    float* left = left_ + start;
+    float* right = right_ + start;
+
+    for (int i = start; i < end; i++) {
+        float level = inputs.beeper[i] * beeperGain;
+        left_[i] = level;
+        right_[i] = level;
+    }
+    if (inputs.speech) {
+        int speechEnd = std::min(inputs.speechCount, end);
+        for (int i = start; i < speechEnd; i++) {
+            float level = inputs.speech[i] * speechGain;
+            left_[i] += level;
+            right_[i] += level;
+        }
+    }
+    if (inputs.ay) panAY(inputs, start, end);
+
+    if (dcBlockEnabled_) {
+        blockDC(left, count, 0);
+        blockDC(right, count, 1);
+    }
+    interleave(stereoBuffer_ + start * 2, left, right, count);
+    frameCount_ = end;
+}
+
+void AudioMixer::panAY(const Inputs& inputs, int start, int end)
+{
+    float gain = gains_[SourceAY];
+    int ayEnd = std::min(inputs.ayCount, end);
+
+    if (ayPanning_ == AYPanning::Mono || !inputs.ayChannels[0]) {
+        for (int i = start; i < ayEnd; i++) {
+            float level = inputs.ay[i] * gain;
+            left_[i] += level;
+            right_[i] += level;
+        }
+        return;
+    }
+
+    // Channel order left to right: ABC = A, B, C; ACB = A, C, B
+    const float* leftChannel = inputs.ayChannels[0];
+    const float* centreChannel = inputs.ayChannels[ayPanning_ == AYPanning::ABC ? 1 : 2];
+    const float* rightChannel = inputs.ayChannels[ayPanning_ == AYPanning::ABC ? 2 : 1];
+    float nearGain = PAN_NEAR * gain;
+    float farGain = PAN_FAR * gain;
+
+    for (int i = start; i < ayEnd; i++) {
+        float l = leftChannel[i];
+        float c = centreChannel[i] * gain;
+        float r = rightChannel[i];
+        left_[i] += l * nearGain + c + r * farGain;
+        right_[i] += r * nearGain + c + l * farGain;
+    }
+}
+
+void AudioMixer::blockDC(float* buf, int count, int side)
+{
+    float prevIn = dcInput_[side];
+    float prevOut = dcOutput_[side];
+    for (int i = 0; i < count; i++) {
+        float in = buf[i];
+        prevOut = in - prevIn + DC_BLOCK_R * prevOut;
+        prevIn = in;
+        buf[i] = prevOut;
+    }
+    dcInput_[side] = prevIn;
+    dcOutput_[side] = prevOut;
+}
+
+} // namespace zxspec
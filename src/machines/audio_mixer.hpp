@@ -0,0 +1,110 @@
+/*
+ * audio_mixer.hpp - Frame-end mixing of the beeper, AY and speech outputs
+ *
+ * Each sound source produces its own 48 kHz mono buffer during the frame.
+ * At frame end the mixer applies a per-source gain and sums them in place
+ * into the beeper buffer (the mono output that getAudioBuffer() has always
+ * returned). With stereo enabled it also mixes an interleaved float32
+ * stereo buffer with the AY channels panned ABC, ACB or centred and a
+ * DC-blocking filter on each side. Stereo is off until a consumer asks for
+ * it, so a front end that plays the mono buffer pays nothing for it.
+ */
+
+#pragma once
+
+#include "../core/state_stream.hpp"
+#include <array>
+#include <cstdint>
+
+namespace zxspec {
+
+class AudioMixer {
+public:
+    static constexpr int MAX_FRAMES = 2048;
+
+    enum Source {
+        SourceBeeper = 0,   // Beeper, tape EAR and SpecDrum
+        SourceAY,
+        SourceSpeech,       // Currah uSpeech SP0256
+        SourceCount
+    };
+
+    // Where the three AY channels sit in the stereo image. ABC is the
+    // Melodik / most 128K add-on wiring (A left, B centre, C right).
+    enum class AYPanning {
+        Mono = 0,
+        ABC,
+        ACB
+    };
+
+    // One frame's worth of source buffers, indexed by sample
+    struct Inputs {
+        float* beeper = nullptr;                    // Mono output is mixed into this in place
+        int beeperCount = 0;
+        const float* ay = nullptr;                  // nullptr when the AY is off
+        std::array<const float*, 3> ayChannels{};   // Per-channel AY, needed unless panning is Mono
+        int ayCount = 0;
+        const float* speech = nullptr;              // nullptr when the speech unit is off
+        int speechCount = 0;
+    };
+
+    void reset();
+
+    // DC blocker history and this frame's output; not the gains or panning
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
+    // Mix samples [start, inputs.beeperCount) of every source. start is the
+    // beeper count at the previous mix, so samples are never mixed twice.
+    void mix(const Inputs& inputs, int start);
+
+    void setGain(Source source, float gain);
+    float getGain(Source source) const;
+
+    void setAYPanning(AYPanning panning) { ayPanning_ = panning; }
+    AYPanning getAYPanning() const { return ayPanning_; }
+
+    void setDCBlockEnabled(bool enabled) { dcBlockEnabled_ = enabled; }
+    bool isDCBlockEnabled() const { return dcBlockEnabled_; }
+
+    // Whether mix() also produces the stereo buffer
+    void setStereoEnabled(bool enabled) { stereoEnabled_ = enabled; }
+    bool isStereoEnabled() const { return stereoEnabled_; }
+
+    // Interleaved L/R frames, one per mono sample (none while stereo is off)
+    const float* getStereoBuffer() const { return stereoBuffer_; }
+    int getFrameCount() const { return frameCount_; }
+    void resetBuffer() { frameCount_ = 0; }
+
+private:
+    // Share of a side channel that goes to its own side and to the other;
+    // a centred channel goes 1.0 to each, so every panning peaks at the
+    // same level as mono
+    static constexpr float PAN_NEAR = 1.75f;
+    static constexpr float PAN_FAR = 0.25f;
+
+    // One-pole high-pass, y[n] = x[n] - x[n-1] + R * y[n-1] (~38 Hz at 48 kHz)
+    static constexpr float DC_BLOCK_R = 0.995f;
+
+    std::array<float, SourceCount> gains_{ 1.0f, 1.0f, 1.0f };
+    AYPanning ayPanning_ = AYPanning::Mono;
+    bool dcBlockEnabled_ = true;
+    bool stereoEnabled_ = false;
+
+    // DC blocker state per side: previous input and output
+    float dcInput_[2]{};
+    float dcOutput_[2]{};
+
+    // Planar working buffers, interleaved into stereoBuffer_ at the end
+    float left_[MAX_FRAMES]{};
+    float right_[MAX_FRAMES]{};
+
+    float stereoBuffer_[MAX_FRAMES * 2]{};
+    int frameCount_ = 0;
+
+    void mixStereo(const Inputs& inputs, int start, int end);
+    void panAY(const Inputs& inputs, int start, int end);
+    void blockDC(float* buf, int count, int side);
+};
+
+} // namespace zxspec
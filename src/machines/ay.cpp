@@ -9,6 +9,9 @@
  */
 
 #include "ay.hpp"
+#include "../core/frame_profile.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 
 namespace zxspec {
@@ -57,11 +60,73 @@ void AY3_8912::reset()
     outputLevel_ = 0.0;
     ayTsCounter_ = 0.0;
     ayLevel_ = 0.0f;
+    channelOutput_.fill(0.0);
+    channelLevel_.fill(0.0f);
 
     waveformWritePos_ = 0;
     std::memset(waveformBuffers_, 0, sizeof(waveformBuffers_));
 }
 
+void AY3_8912::saveState(StateWriter& writer) const
+{
+    writer.write(regs_);
+    writer.write(selectedReg_);
+    writer.write(toneCounters_);
+    writer.write(toneOutput_);
+    writer.write(noiseCounter_);
+    writer.write(noiseLFSR_);
+    writer.write(envCounter_);
+    writer.write(envVolume_);
+    writer.write(envHolding_);
+    writer.write(envContinue_);
+    writer.write(envAttack_);
+    writer.write(envAlternate_);
+    writer.write(envHold_);
+    writer.write(tsCounter_);
+    writer.write(outputLevel_);
+    writer.write(ayTsCounter_);
+    writer.write(ayLevel_);
+    writer.write(channelOutput_);
+    writer.write(channelLevel_);
+    writer.write(sampleIndex_);
+    writer.write(sampleBuffer_);
+    writer.write(channelBuffers_);
+    writer.write(waveformWritePos_);
+    writer.write(waveformBuffers_);
+}
+
+bool AY3_8912::loadState(StateReader& reader)
+{
+    reader.read(regs_);
+    reader.read(selectedReg_);
+    reader.read(toneCounters_);
+    reader.read(toneOutput_);
+    reader.read(noiseCounter_);
+    reader.read(noiseLFSR_);
+    reader.read(envCounter_);
+    reader.read(envVolume_);
+    reader.read(envHolding_);
+    reader.read(envContinue_);
+    reader.read(envAttack_);
+    reader.read(envAlternate_);
+    reader.read(envHold_);
+    reader.read(tsCounter_);
+    reader.read(outputLevel_);
+    reader.read(ayTsCounter_);
+    reader.read(ayLevel_);
+    reader.read(channelOutput_);
+    reader.read(channelLevel_);
+    reader.read(sampleIndex_);
+    reader.read(sampleBuffer_);
+    reader.read(channelBuffers_);
+    reader.read(waveformWritePos_);
+    reader.read(waveformBuffers_);
+    selectedReg_ &= 0x0F;
+    sampleIndex_ = std::clamp(sampleIndex_, 0, MAX_SAMPLES_PER_FRAME);
+    waveformWritePos_ = std::clamp(waveformWritePos_, 0, WAVEFORM_BUFFER_SIZE - 1);
+    return reader.ok();
+}
+
 // ============================================================================
 // Port interface
 // ============================================================================
@@ -151,33 +216,80 @@ void AY3_8912::getWaveform(int ch, float* buf, int count) const
 }
 
 // ============================================================================
-// Per-T-state update (same pattern as beeper Audio::update)
+// Per-T-state update
 // ============================================================================
 
+// Advance the chip by the given number of T-states.
+//
+// The generators tick at about 0.063 ticks per T-state, and most ticks only
+// bump a counter. Rather than tick every generator and recompute the mixer
+// on each one, the number of ticks until any counter next reaches its period
+// is worked out up front. Ticks before then are just counted, and at that
+// tick the counters catch up in one step and the generators run their
+// normal tick, so toggles, LFSR shifts and envelope steps happen on exactly
+// the same tick as before. The mixer output can only change on those ticks
+// (or on a register write, before this call), so it is recomputed only then.
+//
+// The per-T-state tick phase and the 48 kHz averaging are accumulated exactly
+// as before, one T-state at a time, so the output is bit-identical. They are
+// kept in locals for the length of the call: as members every step was a
+// load and a store behind the sample buffer writes, which made the loop cost
+// about half as much again.
 void AY3_8912::update(int32_t tStates)
 {
+    ZXSPEC_PROFILE_SCOPE(Audio);
+
+    ayLevel_ = computeMixerOutput() * AY_VOLUME;
+    if (channelBuffersEnabled_) computeChannelLevels();
+    uint32_t ticksToEvent = ticksToNextEvent();
+    uint32_t pendingTicks = 0;
+
+    double ayTsCounter = ayTsCounter_;
+    double tsCounter = tsCounter_;
+    double outputLevel = outputLevel_;
+    double level = static_cast<double>(ayLevel_);
+
     for (int32_t i = 0; i < tStates; i++) {
         // Advance AY generators at exact PSG clock rate
-        ayTsCounter_ += AY_TICKS_PER_TSTATE;
-        while (ayTsCounter_ >= 1.0) {
-            ayTsCounter_ -= 1.0;
-            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
-                tickToneGenerator(ch);
+        ayTsCounter += AY_TICKS_PER_TSTATE;
+        while (ayTsCounter >= 1.0) {
+            ayTsCounter -= 1.0;
+            if (++pendingTicks == ticksToEvent) {
+                skipTicks(pendingTicks - 1);
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                    tickToneGenerator(ch);
+                }
+                tickNoiseGenerator();
+                tickEnvelopeGenerator();
+                pendingTicks = 0;
+
+                ayLevel_ = computeMixerOutput() * AY_VOLUME;
+                level = static_cast<double>(ayLevel_);
+                if (channelBuffersEnabled_) computeChannelLevels();
+                ticksToEvent = ticksToNextEvent();
             }
-            tickNoiseGenerator();
-            tickEnvelopeGenerator();
         }
-        ayLevel_ = computeMixerOutput() * AY_VOLUME;
 
         // Accumulate AY level every T-state
-        tsCounter_ += 1.0;
-        outputLevel_ += static_cast<double>(ayLevel_);
+        tsCounter += 1.0;
+        outputLevel += level;
+        if (channelBuffersEnabled_) {
+            for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                channelOutput_[ch] += static_cast<double>(channelLevel_[ch]);
+            }
+        }
 
         // Emit averaged sample at the same rate as the beeper
-        if (tsCounter_ >= tsStep_) {
+        if (tsCounter >= tsStep_) {
             if (sampleIndex_ < MAX_SAMPLES_PER_FRAME) {
+                if (channelBuffersEnabled_) {
+                    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                        channelBuffers_[ch][sampleIndex_] =
+                            static_cast<float>(channelOutput_[ch] / tsCounter);
+                    }
+                }
                 sampleBuffer_[sampleIndex_++] =
-                    static_cast<float>(outputLevel_ / tsCounter_);
+                    static_cast<float>(outputLevel / tsCounter);
 
                 // Store per-channel waveform samples at audio sample rate
                 for (int ch = 0; ch < 3; ch++) {
@@ -185,10 +297,21 @@ void AY3_8912::update(int32_t tStates)
                 }
                 waveformWritePos_ = (waveformWritePos_ + 1) % WAVEFORM_BUFFER_SIZE;
             }
-            tsCounter_ -= tsStep_;
-            outputLevel_ = static_cast<double>(ayLevel_) * tsCounter_;
+            tsCounter -= tsStep_;
+            outputLevel = level * tsCounter;
+            if (channelBuffersEnabled_) {
+                for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+                    channelOutput_[ch] = static_cast<double>(channelLevel_[ch]) * tsCounter;
+                }
+            }
         }
     }
+
+    // Leave the counters up to date for register writes and the next call
+    ayTsCounter_ = ayTsCounter;
+    tsCounter_ = tsCounter;
+    outputLevel_ = outputLevel;
+    skipTicks(pendingTicks);
 }
 
 void AY3_8912::frameEnd()
@@ -215,6 +338,42 @@ uint16_t AY3_8912::getEnvPeriod() const
     return regs_[11] | (regs_[12] << 8);
 }
 
+// Generator ticks until the next tone toggle, noise shift or envelope step.
+// A counter already at or past its period (after the period was lowered)
+// fires on the very next tick.
+uint32_t AY3_8912::ticksToNextEvent() const
+{
+    auto ticksUntil = [](uint32_t counter, uint32_t period) -> uint32_t {
+        return (counter + 1 >= period) ? 1 : period - counter;
+    };
+
+    uint32_t ticks = UINT32_MAX;
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        uint16_t period = getTonePeriod(ch);
+        ticks = std::min(ticks, ticksUntil(toneCounters_[ch], period ? period : 1));
+    }
+
+    uint8_t noisePeriod = getNoisePeriod();
+    ticks = std::min(ticks, ticksUntil(noiseCounter_, static_cast<uint32_t>(noisePeriod ? noisePeriod : 1) * 2));
+
+    if (!envHolding_) {
+        uint16_t envPeriod = getEnvPeriod();
+        ticks = std::min(ticks, ticksUntil(envCounter_, envPeriod ? envPeriod : 1));
+    }
+    return ticks;
+}
+
+// Advance every counter by a number of ticks that ends before any of them
+// reaches its period, so nothing toggles
+void AY3_8912::skipTicks(uint32_t ticks)
+{
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        toneCounters_[ch] += ticks;
+    }
+    noiseCounter_ += ticks;
+    if (!envHolding_) envCounter_ += ticks;
+}
+
 void AY3_8912::tickToneGenerator(int ch)
 {
     uint16_t period = getTonePeriod(ch);
@@ -347,4 +506,15 @@ float AY3_8912::computeMixerOutput() const
     return sample / 3.0f;
 }
 
+// Each channel's share of the mixed output, so the three sum to ayLevel_
+// (to within rounding) and a centred channel is as loud as in mono
+void AY3_8912::computeChannelLevels()
+{
+    for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+        channelLevel_[ch] = channelMuted_[ch]
+            ? 0.0f
+            : getChannelOutput(ch) / 3.0f * AY_VOLUME;
+    }
+}
+
 } // namespace zxspec
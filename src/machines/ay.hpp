@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "../core/state_stream.hpp"
 #include <cstdint>
 #include <array>
 
@@ -30,6 +31,10 @@ public:
     void setup(int sampleRate, double framesPerSecond, int tStatesPerFrame);
     void reset();
 
+    // Registers, generator counters and this frame's samples; not the mutes
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Called each instruction with the T-state delta
     void update(int32_t tStates);
     void frameEnd();
@@ -59,6 +64,13 @@ public:
     int getSampleCount() const { return sampleIndex_; }
     void resetBuffer() { sampleIndex_ = 0; }
 
+    // Per-channel output for stereo mixing. Off by default so the mono path
+    // pays nothing; when on, each channel is averaged into its own buffer
+    // alongside the mixed one, sharing its sample count.
+    void setChannelBuffersEnabled(bool enabled) { channelBuffersEnabled_ = enabled; }
+    bool getChannelBuffersEnabled() const { return channelBuffersEnabled_; }
+    const float* getChannelBuffer(int ch) const { return channelBuffers_[ch]; }
+
     // Internal state accessors (debug)
     bool getToneOutput(int ch) const;
     uint32_t getNoiseLFSR() const;
@@ -111,6 +123,12 @@ private:
     double ayTsCounter_ = 0.0;
     float ayLevel_ = 0.0f;
 
+    // Per-channel averaging, used only when channelBuffersEnabled_
+    bool channelBuffersEnabled_ = false;
+    float channelBuffers_[3][MAX_SAMPLES_PER_FRAME]{};
+    std::array<double, 3> channelOutput_{};
+    std::array<float, 3> channelLevel_{};
+
     // Per-channel waveform ring buffers for debug display
     float waveformBuffers_[3][WAVEFORM_BUFFER_SIZE]{};
     int waveformWritePos_ = 0;
@@ -119,11 +137,14 @@ private:
     uint16_t getTonePeriod(int ch) const;
     uint8_t getNoisePeriod() const;
     uint16_t getEnvPeriod() const;
+    uint32_t ticksToNextEvent() const;
+    void skipTicks(uint32_t ticks);
     void tickToneGenerator(int ch);
     void tickNoiseGenerator();
     void tickEnvelopeGenerator();
     void handleEnvelopeCycleEnd();
     float computeMixerOutput() const;
+    void computeChannelLevels();
 };
 
 } // namespace zxspec
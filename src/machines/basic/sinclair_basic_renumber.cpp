@@ -10,6 +10,7 @@
 #include "sinclair_basic_tokenizer.hpp"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <map>
 #include <sstream>
 #include <vector>
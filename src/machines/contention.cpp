@@ -70,6 +70,21 @@ uint32_t ULAContention::ioContention(uint32_t tstates) const
     return ioContentionTable_[tstates % tsPerFrame_];
 }
 
+// The contended windows are the 128 paper T-states of each of the 192
+// visible scanlines (see buildContentionTable)
+uint32_t ULAContention::contentionFreeUntil(uint32_t tstates) const
+{
+    if (tstates < cpuTsToContention_) return cpuTsToContention_;
+    if (tsPerScanline_ == 0) return tstates;
+
+    uint32_t line = (tstates - cpuTsToContention_) / tsPerScanline_;
+    uint32_t ts = (tstates - cpuTsToContention_) % tsPerScanline_;
+    if (line >= SCREEN_HEIGHT) return tsPerFrame_;
+    if (ts < TS_HORIZONTAL_DISPLAY) return tstates;
+    if (line + 1 >= SCREEN_HEIGHT) return tsPerFrame_;
+    return cpuTsToContention_ + (line + 1) * tsPerScanline_;
+}
+
 // Apply I/O contention to the Z80 for a port access.
 //
 // I/O contention depends on two factors:
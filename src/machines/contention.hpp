@@ -41,6 +41,11 @@ public:
     // the four possible patterns.
     void applyIOContention(Z80& z80, uint16_t address, bool contended) const;
 
+    // First T-state at or after tstates (within the same frame) where an
+    // access could be contended, or the frame length if there is none. Every
+    // memory and IO access before it costs exactly its uncontended T-states.
+    uint32_t contentionFreeUntil(uint32_t tstates) const;
+
 private:
     void buildContentionTable();
 
@@ -25,6 +25,18 @@ void CurrahSpeech::reset()
     sp0256_.reset();
 }
 
+void CurrahSpeech::saveState(StateWriter& writer) const
+{
+    writer.write(pagedIn_);
+    sp0256_.saveState(writer);
+}
+
+bool CurrahSpeech::loadState(StateReader& reader)
+{
+    reader.read(pagedIn_);
+    return sp0256_.loadState(reader);
+}
+
 void CurrahSpeech::loadROM(const uint8_t* data, uint32_t size)
 {
     if (!data || size == 0) return;
@@ -40,6 +40,10 @@ public:
     ~CurrahSpeech() = default;
 
     void reset();
+
+    // Paging and the SP0256; not the ROMs
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
     void loadROM(const uint8_t* data, uint32_t size);
     void loadAllophoneROM(const uint8_t* data, uint32_t size);
 
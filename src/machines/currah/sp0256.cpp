@@ -32,8 +32,11 @@
  */
 
 #include "sp0256.hpp"
+#include "../../core/frame_profile.hpp"
+#include <algorithm>
 #include <cstring>
 #include <cmath>
+#include <memory>
 
 namespace zxspec {
 
@@ -235,6 +238,7 @@ void SP0256::setup(int sampleRate, double framesPerSecond, int tStatesPerFrame)
     // The chip uses 7-bit PWM (128 steps) plus 28 padding steps = 156 total,
     // clocked at half the crystal frequency. This matches the datasheet.
     internalStep_ = cpuClock / (static_cast<double>(SP0256_CLOCK) / 312.0);
+    primeCachedClocks();
 }
 
 void SP0256::reset()
@@ -257,6 +261,102 @@ void SP0256::reset()
     internalCounter_ = 0.0;
     currentSample_ = 0.0f;
     highIntonation_ = false;
+
+    cachedAllophone_ = nullptr;
+    cachedPos_ = 0;
+    primeCachedClocks();
+}
+
+void SP0256::saveState(StateWriter& writer) const
+{
+    int8_t cachedAllophone = cachedAllophone_
+        ? static_cast<int8_t>(cachedAllophone_ - allophoneCache_.data()) : -1;
+
+    writer.write(pc_);
+    writer.write(page_);
+    writer.write(stack_);
+    writer.write(ald_);
+    writer.write(mode_);
+    writer.write(halted_);
+    writer.write(lrq_);
+    writer.write(silent_);
+    writer.write(filt_.rpt);
+    writer.write(filt_.cnt);
+    writer.write(filt_.per);
+    writer.write(filt_.rng);
+    writer.write(filt_.amp);
+    writer.write(filt_.f_coef);
+    writer.write(filt_.b_coef);
+    writer.write(filt_.z_data);
+    writer.write(filt_.r);
+    writer.write(filt_.interp);
+    writer.write(sampleIndex_);
+    writer.write(sampleBuffer_);
+    writer.write(tsCounter_);
+    writer.write(internalCounter_);
+    writer.write(currentSample_);
+    writer.write(highIntonation_);
+    writer.write(cachedMode_);
+    writer.write(cachedAllophone);
+    writer.write(cachedPos_);
+    writer.write(internalWait_);
+    writer.write(internalDue_);
+    writer.write(outputWait_);
+    writer.write(outputDue_);
+}
+
+bool SP0256::loadState(StateReader& reader)
+{
+    bool cachedMode = false;
+    int8_t cachedAllophone = -1;
+
+    reader.read(pc_);
+    reader.read(page_);
+    reader.read(stack_);
+    reader.read(ald_);
+    reader.read(mode_);
+    reader.read(halted_);
+    reader.read(lrq_);
+    reader.read(silent_);
+    reader.read(filt_.rpt);
+    reader.read(filt_.cnt);
+    reader.read(filt_.per);
+    reader.read(filt_.rng);
+    reader.read(filt_.amp);
+    reader.read(filt_.f_coef);
+    reader.read(filt_.b_coef);
+    reader.read(filt_.z_data);
+    reader.read(filt_.r);
+    reader.read(filt_.interp);
+    reader.read(sampleIndex_);
+    reader.read(sampleBuffer_);
+    reader.read(tsCounter_);
+    reader.read(internalCounter_);
+    reader.read(currentSample_);
+    reader.read(highIntonation_);
+    reader.read(cachedMode);
+    reader.read(cachedAllophone);
+    reader.read(cachedPos_);
+    reader.read(internalWait_);
+    reader.read(internalDue_);
+    reader.read(outputWait_);
+    reader.read(outputDue_);
+    sampleIndex_ = std::clamp(sampleIndex_, 0, MAX_SAMPLES);
+
+    cachedAllophone_ = nullptr;
+    if (cachedMode_ && cachedMode && cachedAllophone >= 0 && cachedAllophone < NUM_ALLOPHONES) {
+        cachedAllophone_ = &allophoneCache_[cachedAllophone];
+    } else if (cachedMode_ && !halted_) {
+        halted_ = true;
+        silent_ = true;
+    }
+
+    // Saved in the other mode: switch over as setCachedMode() would
+    if (cachedMode != cachedMode_) {
+        cachedMode_ = cachedMode;
+        setCachedMode(!cachedMode);
+    }
+    return reader.ok();
 }
 
 void SP0256::loadROM(const uint8_t* data, uint32_t size)
@@ -264,6 +364,31 @@ void SP0256::loadROM(const uint8_t* data, uint32_t size)
     if (!data || size == 0) return;
     uint32_t copySize = (size < ROM_SIZE) ? size : ROM_SIZE;
     std::memcpy(rom_.data(), data, copySize);
+    cacheBuilt_ = false;
+    if (cachedMode_) buildAllophoneCache();
+}
+
+void SP0256::setCachedMode(bool cached)
+{
+    if (cached == cachedMode_) return;
+    cachedMode_ = cached;
+
+    if (cached) {
+        if (!cacheBuilt_) buildAllophoneCache();
+        primeCachedClocks();
+    } else {
+        // Fold the T-states run since the last cached sample back in
+        internalCounter_ += internalWait_ - internalDue_;
+        tsCounter_ += outputWait_ - outputDue_;
+    }
+
+    // Drop whatever is being spoken; a queued allophone still plays
+    halted_ = true;
+    silent_ = true;
+    filt_.rpt = 0;
+    cachedAllophone_ = nullptr;
+    cachedPos_ = 0;
+    currentSample_ = 0.0f;
 }
 
 // ============================================================================
@@ -578,49 +703,159 @@ bool SP0256::lpc12_update(int16_t& out)
 
 void SP0256::update(int32_t tStates)
 {
+    ZXSPEC_PROFILE_SCOPE(Audio);
+
+    if (cachedMode_) {
+        updateCached(tStates);
+        return;
+    }
+
     for (int32_t t = 0; t < tStates; t++) {
         internalCounter_ += 1.0;
         if (internalCounter_ >= internalStep_) {
             internalCounter_ -= internalStep_;
+            stepExact();
+        }
 
-            // Generate one internal sample, matching MAME's approach:
-            // 1. If the repeat count expired, run the micro-sequencer
-            // 2. If we're in a silent state AND no repeat pending, output
-            //    zeros WITHOUT running the filter — this is the key to
-            //    preventing residual filter noise between allophones
-            // 3. Otherwise, run the LPC filter to produce a real sample
-            int16_t sample = 0;
+        tsCounter_ += 1.0;
+        if (tsCounter_ >= tsStep_) {
+            tsCounter_ -= tsStep_;
+            if (sampleIndex_ < MAX_SAMPLES)
+                sampleBuffer_[sampleIndex_++] = currentSample_;
+        }
+    }
+}
 
-            if (filt_.rpt <= 0)
-                micro();
+void SP0256::stepExact()
+{
+    // Generate one internal sample, matching MAME's approach:
+    // 1. If the repeat count expired, run the micro-sequencer
+    // 2. If we're in a silent state AND no repeat pending, output
+    //    zeros WITHOUT running the filter — this is the key to
+    //    preventing residual filter noise between allophones
+    // 3. Otherwise, run the LPC filter to produce a real sample
+    int16_t sample = 0;
+
+    if (filt_.rpt <= 0)
+        micro();
+
+    if (silent_ && filt_.rpt <= 0) {
+        sample = 0;
+    } else {
+        if (!lpc12_update(sample))
+            sample = 0;
+    }
 
-            if (silent_ && filt_.rpt <= 0) {
-                sample = 0;
-            } else {
-                if (!lpc12_update(sample))
-                    sample = 0;
-            }
+    // Output low-pass filter — the real Currah board has an RC
+    // filter on the SP0256 output that softens transients
+    // The LPC filter's impulse response is very peaky — the first
+    // few samples of each pitch period can be 10-30x louder than the
+    // steady state. Hard clipping sounds awful, so we use tanh() for
+    // soft saturation (like the analogue compression that happens
+    // naturally in the real hardware's output stage and speaker).
+    // The gain of 1.5 keeps steady-state speech at a good level,
+    // and tanh compresses the peaks smoothly.
+    float raw = static_cast<float>(sample) / 32768.0f * 16.0f;
+    float compressed = tanhf(raw) * 0.8f;
+    constexpr float lpAlpha = 0.12f;
+    currentSample_ = currentSample_ * (1.0f - lpAlpha) + compressed * lpAlpha;
+}
+
+// ============================================================================
+// Cached mode — the live chip loads a queued allophone on the first
+// internal sample after the previous one halts, and outputs silence while
+// halted, so replaying rendered PCM with the same rules gives the same
+// timing and the same busy line.
+// ============================================================================
+
+void SP0256::stepCached()
+{
+    if (!halted_ && cachedPos_ >= cachedAllophone_->size()) {
+        halted_ = true;
+        silent_ = true;
+        cachedAllophone_ = nullptr;
+    }
+
+    if (halted_ && !lrq_) {
+        cachedAllophone_ = &allophoneCache_[(ald_ >> 4) & 0x3F];
+        cachedPos_ = 0;
+        halted_ = false;
+        silent_ = false;
+        lrq_ = true;
+        ald_ = 0;
+    }
+
+    if (!halted_ && cachedPos_ < cachedAllophone_->size()) {
+        currentSample_ = (*cachedAllophone_)[cachedPos_++];
+    } else {
+        currentSample_ = 0.0f;
+    }
+}
 
-            // Output low-pass filter — the real Currah board has an RC
-            // filter on the SP0256 output that softens transients
-            // The LPC filter's impulse response is very peaky — the first
-            // few samples of each pitch period can be 10-30x louder than the
-            // steady state. Hard clipping sounds awful, so we use tanh() for
-            // soft saturation (like the analogue compression that happens
-            // naturally in the real hardware's output stage and speaker).
-            // The gain of 1.5 keeps steady-state speech at a good level,
-            // and tanh compresses the peaks smoothly.
-            float raw = static_cast<float>(sample) / 32768.0f * 16.0f;
-            float compressed = tanhf(raw) * 0.8f;
-            constexpr float lpAlpha = 0.12f;
-            currentSample_ = currentSample_ * (1.0f - lpAlpha) + compressed * lpAlpha;
+// Run one scratch chip from reset through each allophone in turn, recording
+// every internal sample until its program halts. Called when cached mode is
+// switched on or the ROM changes, never from update().
+void SP0256::buildAllophoneCache()
+{
+    // Longest allophone is a few hundred ms; this only guards against a
+    // corrupt ROM looping forever
+    constexpr size_t maxRenderSamples = 100000;
+
+    auto chip = std::make_unique<SP0256>();
+    chip->rom_ = rom_;
+
+    for (uint32_t allophone = 0; allophone < NUM_ALLOPHONES; allophone++) {
+        chip->reset();
+        chip->ald_ = (allophone << 4) | (0x1000 << 3);
+        chip->lrq_ = false;
+
+        std::vector<float>& pcm = allophoneCache_[allophone];
+        pcm.clear();
+        for (;;) {
+            chip->stepExact();
+            if (chip->halted_ || pcm.size() >= maxRenderSamples) break;
+            pcm.push_back(chip->currentSample_);
         }
+    }
+    cacheBuilt_ = true;
+}
 
-        tsCounter_ += 1.0;
-        if (tsCounter_ >= tsStep_) {
+// T-states until a counter stepping by one per T-state reaches step
+static int32_t ticksUntil(double counter, double step)
+{
+    double remaining = std::ceil(step - counter);
+    return remaining > 1.0 ? static_cast<int32_t>(remaining) : 1;
+}
+
+void SP0256::primeCachedClocks()
+{
+    internalWait_ = internalDue_ = ticksUntil(internalCounter_, internalStep_);
+    outputWait_ = outputDue_ = ticksUntil(tsCounter_, tsStep_);
+}
+
+// Same clocks as the exact loop, but counted down in whole T-states to
+// whichever of the internal sample or the next 48 kHz output is due first
+void SP0256::updateCached(int32_t tStates)
+{
+    while (tStates > 0) {
+        int32_t n = std::min({ tStates, internalDue_, outputDue_ });
+        internalDue_ -= n;
+        outputDue_ -= n;
+        tStates -= n;
+
+        if (internalDue_ == 0) {
+            internalCounter_ += internalWait_;
+            internalCounter_ -= internalStep_;
+            stepCached();
+            internalWait_ = internalDue_ = ticksUntil(internalCounter_, internalStep_);
+        }
+
+        if (outputDue_ == 0) {
+            tsCounter_ += outputWait_;
             tsCounter_ -= tsStep_;
             if (sampleIndex_ < MAX_SAMPLES)
                 sampleBuffer_[sampleIndex_++] = currentSample_;
+            outputWait_ = outputDue_ = ticksUntil(tsCounter_, tsStep_);
         }
     }
 }
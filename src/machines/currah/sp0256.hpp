@@ -25,8 +25,10 @@
 
 #pragma once
 
+#include "../../core/state_stream.hpp"
 #include <cstdint>
 #include <array>
+#include <vector>
 
 namespace zxspec {
 
@@ -35,6 +37,7 @@ public:
     static constexpr uint32_t ROM_SIZE = 2048;     // 2KB allophone ROM
     static constexpr int SP0256_CLOCK = 3120000;   // 3.12MHz crystal on the Currah board
     static constexpr int MAX_SAMPLES = 2048;
+    static constexpr int NUM_ALLOPHONES = 64;
 
     SP0256();
     ~SP0256() = default;
@@ -43,6 +46,11 @@ public:
     void reset();
     void loadROM(const uint8_t* data, uint32_t size);
 
+    // Sequencer, filter and output timing. The allophone being replayed in
+    // cached mode is saved by number.
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     void writeAllophone(uint8_t allophone);
     bool isBusy() const;
 
@@ -57,6 +65,23 @@ public:
     void setHighIntonation(bool high) { highIntonation_ = high; }
     bool isHighIntonation() const { return highIntonation_; }
 
+    // Cached mode: switching it on (or loading a ROM while it is on)
+    // renders all 64 allophones once through the full emulation, each from
+    // a reset chip, and keeps them as PCM at the chip's internal rate.
+    // Allophones are then replayed from the cache with the same start/busy
+    // timing as the live chip, and update() jumps from sample to sample
+    // instead of stepping every T-state. Exact mode (the default) runs the
+    // micro-sequencer and LPC filter live.
+    //
+    // The live chip clears its filter and registers when it loads an
+    // allophone, so the only state it carries from one allophone to the
+    // next is the noise LFSR. Timing, the busy line and every voiced sample
+    // therefore match exact mode bit for bit; noise-excited (unvoiced)
+    // samples have the same envelope but a noise sequence that restarts
+    // from the reset seed each allophone.
+    void setCachedMode(bool cached);
+    bool isCachedMode() const { return cachedMode_; }
+
 private:
     std::array<uint8_t, ROM_SIZE> rom_{};
 
@@ -99,10 +124,31 @@ private:
     float    currentSample_ = 0.0f;
     bool     highIntonation_ = false;
 
+    // Cached mode. halted_, lrq_ and ald_ keep their live meaning so the
+    // host interface and isBusy() are shared with exact mode.
+    bool     cachedMode_ = false;
+    std::array<std::vector<float>, NUM_ALLOPHONES> allophoneCache_;
+    bool     cacheBuilt_ = false;
+    const std::vector<float>* cachedAllophone_ = nullptr;
+    uint32_t cachedPos_ = 0;
+
+    // Cached-mode clocks: T-states from the last internal / output sample
+    // to the next one, and how many of those are still to run. The double
+    // counters above are brought up to date only when a sample is due.
+    int32_t  internalWait_ = 1;
+    int32_t  internalDue_ = 1;
+    int32_t  outputWait_ = 1;
+    int32_t  outputDue_ = 1;
+
     uint32_t getb(int len);         // Read bits from ROM at current PC
     void     micro();               // Execute micro-sequencer until filter has work
     bool     lpc12_update(int16_t& out);  // Generate one 10kHz sample
     void     regdec();              // Decode register file into filter coefficients
+    void     stepExact();           // Produce the next internal sample live
+    void     stepCached();          // Produce the next internal sample from the cache
+    void     updateCached(int32_t tStates);
+    void     primeCachedClocks();
+    void     buildAllophoneCache();
 };
 
 } // namespace zxspec
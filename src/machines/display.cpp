@@ -7,11 +7,88 @@
 
 #include "display.hpp"
 #include "../core/palette.hpp"
+#include "../core/frame_profile.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
 namespace zxspec {
 
+// Expand one bitmap byte into 8 RGBA pixels and 8 composite signal bytes,
+// taking ink where a bit is set and paper where it is clear (bit 7 is the
+// leftmost pixel). The vector paths build a per-lane mask from the bitmap
+// byte and blend all 8 pixels at once; the scalar path is the fallback.
+static inline void expandCell(uint32_t* pixels, uint8_t* signal, uint8_t bitmap,
+                              uint32_t ink, uint32_t paper,
+                              const uint8_t* inkSignal, const uint8_t* paperSignal)
+{
+#if defined(__SSE2__)
+    const __m128i bits = _mm_set1_epi32(bitmap);
+    const __m128i bitsLo = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+    const __m128i bitsHi = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+    const __m128i maskLo = _mm_cmpeq_epi32(_mm_and_si128(bits, bitsLo), bitsLo);
+    const __m128i maskHi = _mm_cmpeq_epi32(_mm_and_si128(bits, bitsHi), bitsHi);
+    const __m128i inkV = _mm_set1_epi32(static_cast<int>(ink));
+    const __m128i paperV = _mm_set1_epi32(static_cast<int>(paper));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels),
+                     _mm_or_si128(_mm_and_si128(maskLo, inkV), _mm_andnot_si128(maskLo, paperV)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4),
+                     _mm_or_si128(_mm_and_si128(maskHi, inkV), _mm_andnot_si128(maskHi, paperV)));
+
+    const __m128i bitsB = _mm_set_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+                                       0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80));
+    const __m128i maskB = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(static_cast<char>(bitmap)), bitsB), bitsB);
+    const __m128i inkS = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(inkSignal));
+    const __m128i paperS = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(paperSignal));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(signal),
+                     _mm_or_si128(_mm_and_si128(maskB, inkS), _mm_andnot_si128(maskB, paperS)));
+#elif defined(__ARM_NEON)
+    static const uint32_t bitsLo[4] = { 0x80, 0x40, 0x20, 0x10 };
+    static const uint32_t bitsHi[4] = { 0x08, 0x04, 0x02, 0x01 };
+    static const uint8_t bitsB[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    const uint32x4_t bits = vdupq_n_u32(bitmap);
+    const uint32x4_t inkV = vdupq_n_u32(ink);
+    const uint32x4_t paperV = vdupq_n_u32(paper);
+    vst1q_u32(pixels, vbslq_u32(vtstq_u32(bits, vld1q_u32(bitsLo)), inkV, paperV));
+    vst1q_u32(pixels + 4, vbslq_u32(vtstq_u32(bits, vld1q_u32(bitsHi)), inkV, paperV));
+
+    const uint8x8_t maskB = vtst_u8(vdup_n_u8(bitmap), vld1_u8(bitsB));
+    vst1_u8(signal, vbsl_u8(maskB, vld1_u8(inkSignal), vld1_u8(paperSignal)));
+#elif defined(__wasm_simd128__)
+    const v128_t bits = wasm_i32x4_splat(bitmap);
+    const v128_t bitsLo = wasm_i32x4_make(0x80, 0x40, 0x20, 0x10);
+    const v128_t bitsHi = wasm_i32x4_make(0x08, 0x04, 0x02, 0x01);
+    const v128_t inkV = wasm_i32x4_splat(static_cast<int32_t>(ink));
+    const v128_t paperV = wasm_i32x4_splat(static_cast<int32_t>(paper));
+    wasm_v128_store(pixels, wasm_v128_bitselect(inkV, paperV,
+                    wasm_i32x4_eq(wasm_v128_and(bits, bitsLo), bitsLo)));
+    wasm_v128_store(pixels + 4, wasm_v128_bitselect(inkV, paperV,
+                    wasm_i32x4_eq(wasm_v128_and(bits, bitsHi), bitsHi)));
+
+    const v128_t bitsB = wasm_i8x16_make(static_cast<int8_t>(0x80), 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+    const v128_t maskB = wasm_i8x16_eq(wasm_v128_and(wasm_i8x16_splat(static_cast<int8_t>(bitmap)), bitsB), bitsB);
+    const v128_t blended = wasm_v128_bitselect(wasm_v128_load64_zero(inkSignal),
+                                               wasm_v128_load64_zero(paperSignal), maskB);
+    wasm_v128_store64_lane(signal, blended, 0);
+#else
+    for (int p = 0; p < 8; p++)
+    {
+        bool isInk = (bitmap & (0x80 >> p)) != 0;
+        pixels[p] = isInk ? ink : paper;
+        signal[p] = isInk ? inkSignal[p] : paperSignal[p];
+    }
+#endif
+}
+
 void Display::init(const MachineInfo& info)
 {
     scanlines_ = info.pxVerticalTotal;
@@ -26,28 +103,90 @@ void Display::init(const MachineInfo& info)
     ulaTsToDisplay_ = info.ulaTsToDisplay;
     tsPerFrame_ = info.tsPerFrame;
     buildLineAddressTable();
-    buildTsTable();
-    buildYUVTable();
+    buildSpanList();
+    firstVisibleLine_ = paperStartLine_ - PX_EMU_BORDER_TOP;
+    buildSignalTable();
+    invalidate();
     frameReset();
 }
 
 void Display::frameReset()
 {
+    // A frame left part drawn may have passed the start of a line whose
+    // later cells were written and never drawn
+    if (currentDisplayTs_ > 0 && currentDisplayTs_ < tsPerFrame_) markScreenChanged();
     currentDisplayTs_ = 0;
     bufferIndex_ = 0;
-    currentLine_ = 0;
-    sinPhase_ = 0.0f;
-    cosPhase_ = 1.0f;
+    spanIndex_ = 0;
+}
+
+void Display::saveState(StateWriter& writer) const
+{
+    writer.write(currentDisplayTs_);
+    writer.write(bufferIndex_);
+    writer.write(spanIndex_);
+    writer.write(framebuffer_);
+    writer.write(signalBuffer_);
+    writer.write(borderShadow_);
+    writer.write(paperShadow_);
+    writer.write(dirtyRows_);
+}
+
+bool Display::loadState(StateReader& reader)
+{
+    reader.read(currentDisplayTs_);
+    reader.read(bufferIndex_);
+    reader.read(spanIndex_);
+    reader.read(framebuffer_);
+    reader.read(signalBuffer_);
+    reader.read(borderShadow_);
+    reader.read(paperShadow_);
+    reader.read(dirtyRows_);
+    if (spanIndex_ > spans_.size()) spanIndex_ = 0;
+    markScreenChanged();
+    return reader.ok();
 }
 
 void Display::clearFramebuffer()
 {
     framebuffer_.fill(0);
     signalBuffer_.fill(0);
+    invalidate();
 }
 
-void Display::buildYUVTable()
+// Forget what the framebuffer shows so every cell is drawn again, and report
+// every row as changed
+void Display::invalidate()
 {
+    std::memset(borderShadow_, 0xFF, sizeof(borderShadow_));
+    std::memset(paperShadow_, 0xFF, sizeof(paperShadow_));
+    dirtyRows_.fill(0xFFFFFFFF);
+    markScreenChanged();
+}
+
+// Build the PAL composite encoding table.
+//
+// Each pixel's signal is Y + U·sin(φ) ± V·cos(φ), where φ advances by the
+// subcarrier-to-pixel-clock ratio per pixel from zero at the start of every
+// scanline and the sign of V alternates line by line (the PAL switch). With
+// only 16 colours, two line parities and TOTAL_WIDTH pixel positions, every
+// possible output byte is computed once here and rendering becomes a lookup.
+// The phase is stepped with the same sin/cos recurrence the renderer used to
+// run per pixel, so the encoded bytes are unchanged.
+void Display::buildSignalTable()
+{
+    // PAL subcarrier phase increment per pixel:
+    // PAL subcarrier = 4.43361875 MHz, pixel clock = 7 MHz (2 pixels per T-state)
+    // phase_inc = 2π × 4433618.75 / 7000000 ≈ 3.9793 rad/pixel
+    constexpr float PHASE_INC = 2.0f * 3.14159265f * 4433618.75f / 7000000.0f;
+    const float COS_INC = cosf(PHASE_INC);
+    const float SIN_INC = sinf(PHASE_INC);
+
+    // Signal encoding range: maps analog signal to 0-255 byte
+    constexpr float SIGNAL_OFFSET = 0.4f;
+    constexpr float SIGNAL_SCALE = 170.0f;
+
+    float yuv[16][3];
     for (int i = 0; i < 16; i++)
     {
         uint32_t color = SPECTRUM_COLORS[i];
@@ -56,9 +195,31 @@ void Display::buildYUVTable()
         float g = static_cast<float>((color >> 8) & 0xFF) / 255.0f;
         float b = static_cast<float>((color >> 16) & 0xFF) / 255.0f;
 
-        yuvTable_[i][0] = 0.299f * r + 0.587f * g + 0.114f * b;         // Y
-        yuvTable_[i][1] = -0.147f * r - 0.289f * g + 0.436f * b;        // U
-        yuvTable_[i][2] = 0.615f * r - 0.515f * g - 0.100f * b;         // V
+        yuv[i][0] = 0.299f * r + 0.587f * g + 0.114f * b;         // Y
+        yuv[i][1] = -0.147f * r - 0.289f * g + 0.436f * b;        // U
+        yuv[i][2] = 0.615f * r - 0.515f * g - 0.100f * b;         // V
+    }
+
+    float sinPhase = 0.0f;
+    float cosPhase = 1.0f;
+    for (uint32_t x = 0; x < TOTAL_WIDTH; x++)
+    {
+        for (int parity = 0; parity < 2; parity++)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                float V = parity ? -yuv[i][2] : yuv[i][2];
+                float signal = yuv[i][0] + yuv[i][1] * sinPhase + V * cosPhase;
+                int encoded = static_cast<int>((signal + SIGNAL_OFFSET) * SIGNAL_SCALE);
+                signalTable_[parity][i][x] = static_cast<uint8_t>(
+                    encoded < 0 ? 0 : (encoded > 255 ? 255 : encoded));
+            }
+        }
+
+        float newSin = sinPhase * COS_INC + cosPhase * SIN_INC;
+        float newCos = cosPhase * COS_INC - sinPhase * SIN_INC;
+        sinPhase = newSin;
+        cosPhase = newCos;
     }
 }
 
@@ -96,9 +257,9 @@ void Display::buildLineAddressTable()
     }
 }
 
-// Build the per-T-state action table for the entire frame.
+// Build the span list for the entire frame.
 //
-// For every (scanline, T-state) position we pre-calculate whether the ULA is:
+// For every character cell (4 T-states) in the frame we work out whether the ULA is:
 //   - DISPLAY_RETRACE : in vertical or horizontal blanking (no visible output)
 //   - DISPLAY_BORDER  : drawing the border area around the screen
 //   - DISPLAY_PAPER   : drawing the 256×192 pixel display from screen memory
@@ -113,21 +274,22 @@ void Display::buildLineAddressTable()
 //
 // Within each scanline, the horizontal regions (in T-states) are:
 //
-//   [0 .. tsLeftBorderEnd)                           : left border (16 T-states = 32 pixels)
+//   [0 .. tsLeftBorderEnd)                           : left border (24 T-states = 48 pixels)
 //   [tsLeftBorderEnd .. tsRightBorderStart)          : paper (128 T-states = 256 pixels)
-//   [tsRightBorderStart .. tsRightBorderEnd)         : right border (16 T-states = 32 pixels)
+//   [tsRightBorderStart .. tsRightBorderEnd)         : right border (24 T-states = 48 pixels)
 //   [tsRightBorderEnd .. tsPerScanline)              : horizontal retrace (no output)
 //
-// Note: each T-state position in this table represents 4 actual T-states
-// (one character cell = 8 pixels), since updateWithTs advances by TSTATES_PER_CHAR.
-void Display::buildTsTable()
+// Consecutive cells with the same action are merged into one span, so a
+// scanline is at most five spans and the blanking between the end of one
+// visible line and the start of the next is a single retrace span. The
+// renderer walks this list instead of classifying every cell, which lets it
+// skip retrace outright and fill border runs in one go.
+void Display::buildSpanList()
 {
-    std::memset(tstateTable_, 0, sizeof(tstateTable_));
-
-    // Horizontal boundaries in T-state units (each unit = 4 T-states = 8 pixels)
-    constexpr uint32_t tsLeftBorderEnd = PX_EMU_BORDER_H / 2;                         // 16
-    constexpr uint32_t tsRightBorderStart = tsLeftBorderEnd + TS_HORIZONTAL_DISPLAY;   // 144
-    constexpr uint32_t tsRightBorderEnd = tsRightBorderStart + (PX_EMU_BORDER_H / 2);  // 160
+    // Horizontal boundaries in T-states
+    constexpr uint32_t tsLeftBorderEnd = PX_EMU_BORDER_H / 2;                         // 24
+    constexpr uint32_t tsRightBorderStart = tsLeftBorderEnd + TS_HORIZONTAL_DISPLAY;   // 152
+    constexpr uint32_t tsRightBorderEnd = tsRightBorderStart + (PX_EMU_BORDER_H / 2);  // 176
 
     // Vertical boundaries in scanlines
     uint32_t pxLinePaperStart = paperStartLine_;
@@ -135,57 +297,60 @@ void Display::buildTsTable()
     uint32_t pxLineBottomBorderEnd = pxLinePaperEnd + PX_EMU_BORDER_BOTTOM;
     uint32_t pxLineTopBorderVisible = pxLinePaperStart - PX_EMU_BORDER_TOP;
 
+    spans_.clear();
+
     for (uint32_t line = 0; line < scanlines_; line++)
     {
-        for (uint32_t ts = 0; ts < tsPerScanline_; ts++)
+        for (uint32_t ts = 0; ts < tsPerScanline_; ts += TSTATES_PER_CHAR)
         {
-            tstateTable_[line][ts] = DISPLAY_RETRACE;
+            uint32_t action = DISPLAY_RETRACE;
 
-            // Vertical blank — no visible output
             if (line < pxVerticalBlank_)
             {
-                continue;
+                // Vertical blank — no visible output
             }
-
-            // Top border region (between vblank and paper)
-            if (line >= pxVerticalBlank_ && line < pxLinePaperStart)
+            else if (line < pxLinePaperStart)
             {
-                // Only draw the visible portion of the top border (last 32 lines)
-                // and only within the horizontal visible area
-                if (ts >= tsRightBorderEnd || line < pxLineTopBorderVisible)
+                // Top border: only the visible portion (last 48 lines) within
+                // the horizontal visible area
+                if (ts < tsRightBorderEnd && line >= pxLineTopBorderVisible)
                 {
-                    continue;
+                    action = DISPLAY_BORDER;
                 }
-                tstateTable_[line][ts] = DISPLAY_BORDER;
             }
-            // Paper region (192 visible scanlines)
-            else if (line >= pxLinePaperStart && line < pxLinePaperEnd)
+            else if (line < pxLinePaperEnd)
             {
                 if (ts < tsLeftBorderEnd || (ts >= tsRightBorderStart && ts < tsRightBorderEnd))
                 {
                     // Left or right border alongside the paper area
-                    tstateTable_[line][ts] = DISPLAY_BORDER;
+                    action = DISPLAY_BORDER;
                 }
-                else if (ts >= tsRightBorderEnd)
+                else if (ts < tsRightBorderEnd)
                 {
-                    // Horizontal retrace — no output
-                    continue;
+                    // Active paper area — draw from screen memory
+                    action = DISPLAY_PAPER;
                 }
-                else
+            }
+            else if (line < pxLineBottomBorderEnd)
+            {
+                if (ts < tsRightBorderEnd)
                 {
-                    // Active paper area — draw from screen memory
-                    tstateTable_[line][ts] = DISPLAY_PAPER;
+                    action = DISPLAY_BORDER;
                 }
             }
-            // Bottom border region
-            else if (line >= pxLinePaperEnd && line < pxLineBottomBorderEnd)
+
+            uint32_t frameTs = line * tsPerScanline_ + ts;
+            if (!spans_.empty())
             {
-                if (ts >= tsRightBorderEnd)
+                DisplaySpan& last = spans_.back();
+                if (last.action == action && (action == DISPLAY_RETRACE || last.line == line))
                 {
+                    last.endTs = frameTs + TSTATES_PER_CHAR;
                     continue;
                 }
-                tstateTable_[line][ts] = DISPLAY_BORDER;
             }
+            spans_.push_back({ frameTs, frameTs + TSTATES_PER_CHAR,
+                               static_cast<uint16_t>(line), static_cast<uint16_t>(ts), action });
         }
     }
 }
@@ -193,19 +358,23 @@ void Display::buildTsTable()
 // Render pixels for the given number of T-states, advancing the display position.
 //
 // This is the core rendering loop, called after each CPU instruction to keep the
-// framebuffer in sync with the ULA's beam position. Each iteration handles one
-// character cell (4 T-states = 8 pixels):
+// framebuffer in sync with the ULA's beam position. The display advances in whole
+// character cells (4 T-states = 8 pixels) and each iteration handles the part of
+// one span that falls inside this update:
 //
-//   DISPLAY_RETRACE — the beam is in blanking; skip, no pixels written.
-//   DISPLAY_BORDER  — write 8 pixels of the current border colour.
-//   DISPLAY_PAPER   — fetch a bitmap byte and attribute byte from screen memory,
-//                     decode ink/paper/bright/flash, and write 8 coloured pixels.
+//   DISPLAY_RETRACE — the beam is in blanking; skip the lot, no pixels written.
+//   DISPLAY_BORDER  — fill the cells with the current border colour.
+//   DISPLAY_PAPER   — for each cell, fetch a bitmap byte and attribute byte from
+//                     screen memory, decode ink/paper/bright/flash, and write 8
+//                     coloured pixels.
 //
 // The `memory` pointer must point to the screen RAM bank (the 16K at 0x4000),
 // i.e. offset 0 in this array corresponds to address 0x4000.
 void Display::updateWithTs(int32_t tStates, const uint8_t* memory,
                            uint8_t borderColor, uint32_t frameCounter)
 {
+    ZXSPEC_PROFILE_SCOPE(Display);
+
     uint32_t* pixels = reinterpret_cast<uint32_t*>(framebuffer_.data());
 
     // Flash toggles every 16 frames (bit 4 of the frame counter). When active,
@@ -216,138 +385,129 @@ void Display::updateWithTs(int32_t tStates, const uint8_t* memory,
     const uint32_t yAdjust = paperStartLine_;
     constexpr uint32_t tsLeftBorderEnd = PX_EMU_BORDER_H / 2;
 
-    // PAL subcarrier phase increment per pixel:
-    // PAL subcarrier = 4.43361875 MHz, pixel clock = 7 MHz (2 pixels per T-state)
-    // phase_inc = 2π × 4433618.75 / 7000000 ≈ 3.9793 rad/pixel
-    static constexpr float PHASE_INC = 2.0f * 3.14159265f * 4433618.75f / 7000000.0f;
-    static const float COS_INC = cosf(PHASE_INC);
-    static const float SIN_INC = sinf(PHASE_INC);
-
-    // Signal encoding range: maps analog signal to 0-255 byte
-    static constexpr float SIGNAL_OFFSET = 0.4f;
-    static constexpr float SIGNAL_SCALE = 170.0f;
+    if (tStates <= 0 || !renderingEnabled_)
+    {
+        return;
+    }
 
-    while (tStates > 0)
+    // Every line needs comparing after a screen bank switch, and lines with
+    // FLASH cells after a flash toggle
+    if (memory != shownMemory_ || flashMask != shownFlashMask_)
     {
-        // Convert the current display T-state into a scanline and horizontal position
-        uint32_t line = currentDisplayTs_ / tsPerScanline_;
-        uint32_t ts = currentDisplayTs_ % tsPerScanline_;
+        markScreenChanged();
+        shownMemory_ = memory;
+        shownFlashMask_ = flashMask;
+    }
 
-        if (line >= scanlines_)
-        {
-            break;
-        }
+    // Render whole character cells up to the one containing the last T-state,
+    // stopping at the end of the frame
+    uint32_t cells = (static_cast<uint32_t>(tStates) + TSTATES_PER_CHAR - 1) / TSTATES_PER_CHAR;
+    uint32_t targetTs = currentDisplayTs_ + cells * TSTATES_PER_CHAR;
+    const DisplaySpan* spans = spans_.data();
+    const uint32_t spanCount = static_cast<uint32_t>(spans_.size());
 
-        // Reset phase at each new scanline
-        if (line != currentLine_)
+    while (currentDisplayTs_ < targetTs && spanIndex_ < spanCount)
+    {
+        const DisplaySpan& span = spans[spanIndex_];
+        if (currentDisplayTs_ >= span.endTs)
         {
-            currentLine_ = line;
-            sinPhase_ = 0.0f;
-            cosPhase_ = 1.0f;
+            spanIndex_++;
+            continue;
         }
 
-        // Look up the pre-calculated action for this beam position
-        uint32_t action = tstateTable_[line][ts];
+        uint32_t endTs = span.endTs < targetTs ? span.endTs : targetTs;
+        uint32_t line = span.line;
+        uint32_t ts = span.lineTs + (currentDisplayTs_ - span.startTs);
 
-        switch (action)
+        switch (span.action)
         {
             case DISPLAY_BORDER:
             {
-                // Write 8 pixels of solid border colour
-                uint32_t color = SPECTRUM_COLORS[borderColor];
+                // The border colour is fixed for the whole call, so the span
+                // is one solid fill, skipped if those cells already show it.
+                // Visible output starts at T-state 0 of the line, 2 pixels per
+                // T-state, so its signal is one table run.
+                uint32_t count = (endTs - currentDisplayTs_) * 2;
                 uint32_t idx = bufferIndex_;
-                pixels[idx]     = color;
-                pixels[idx + 1] = color;
-                pixels[idx + 2] = color;
-                pixels[idx + 3] = color;
-                pixels[idx + 4] = color;
-                pixels[idx + 5] = color;
-                pixels[idx + 6] = color;
-                pixels[idx + 7] = color;
-
-                // Encode PAL composite signal for border pixels
+                uint8_t* shadow = &borderShadow_[line - firstVisibleLine_][ts / TSTATES_PER_CHAR];
+                uint32_t cellCount = count / 8;
+                if (!std::all_of(shadow, shadow + cellCount, [=](uint8_t c) { return c == borderColor; }))
                 {
-                    const float* yuv = yuvTable_[borderColor & 0x07];
-                    float Y = yuv[0], U = yuv[1], V = yuv[2];
-                    bool palFlip = (line & 1) != 0;
-
-                    for (int p = 0; p < 8; p++)
-                    {
-                        float signal = Y + U * sinPhase_ + (palFlip ? -V : V) * cosPhase_;
-                        int encoded = static_cast<int>((signal + SIGNAL_OFFSET) * SIGNAL_SCALE);
-                        signalBuffer_[idx + p] = static_cast<uint8_t>(
-                            encoded < 0 ? 0 : (encoded > 255 ? 255 : encoded));
-
-                        float newSin = sinPhase_ * COS_INC + cosPhase_ * SIN_INC;
-                        float newCos = cosPhase_ * COS_INC - sinPhase_ * SIN_INC;
-                        sinPhase_ = newSin;
-                        cosPhase_ = newCos;
-                    }
+                    std::fill_n(pixels + idx, count, SPECTRUM_COLORS[borderColor]);
+                    std::memcpy(&signalBuffer_[idx], &signalTable_[line & 1][borderColor & 0x07][ts * 2], count);
+                    std::memset(shadow, borderColor, cellCount);
+                    markRowDirty(line);
                 }
-
-                bufferIndex_ += 8;
+                bufferIndex_ += count;
                 break;
             }
 
             case DISPLAY_PAPER:
             {
-                // Calculate which character cell we're rendering:
-                //   y = pixel row within the paper area (0-191)
-                //   x = character column (0-31)
+                // y = pixel row within the paper area (0-191). A line whose
+                // screen bytes nobody wrote still shows what its shadow says.
                 uint32_t y = line - yAdjust;
-                uint32_t x = (ts / TSTATES_PER_CHAR) - (tsLeftBorderEnd / TSTATES_PER_CHAR);
-
-                // Fetch the bitmap byte using the interleaved screen address table
-                // and the attribute byte from the 768-byte attribute area (at offset 6144)
-                uint16_t pixelAddr = lineAddrTable_[y] + x;
-                uint16_t attrAddr = 6144 + ((y >> 3) << 5) + x;  // 6144 + (char_row * 32) + x
-
-                uint8_t pixelByte = memory[pixelAddr];
-                uint8_t attrByte = memory[attrAddr];
+                uint32_t& written = writtenLines_[y >> 5];
+                uint32_t lineBit = 1u << (y & 31);
+                bool compare = (written & lineBit) != 0;
+                if (currentDisplayTs_ == span.startTs) written &= ~lineBit;
+                if (!compare)
+                {
+                    bufferIndex_ += (endTs - currentDisplayTs_) * 2;
+                    break;
+                }
 
-                // Decode the attribute byte
-                bool flash = (attrByte & 0x80) != 0;
-                bool bright = (attrByte & 0x40) != 0;
-                uint8_t ink = attrByte & 0x07;
-                uint8_t paper = (attrByte >> 3) & 0x07;
+                // The bitmap row and attribute row only change from line to
+                // line
+                const uint8_t* bitmapRow = memory + lineAddrTable_[y];
+                const uint8_t* attrRow = memory + 6144 + ((y >> 3) << 5);  // 6144 + (char_row * 32)
+                const uint8_t* lineSignal = &signalTable_[line & 1][0][0];
+                uint16_t* shadowRow = paperShadow_[y];
 
-                if (flash && flashMask)
+                for (uint32_t cellTs = ts; currentDisplayTs_ < endTs;
+                     cellTs += TSTATES_PER_CHAR, currentDisplayTs_ += TSTATES_PER_CHAR)
                 {
-                    uint8_t tmp = ink;
-                    ink = paper;
-                    paper = tmp;
-                }
+                    // x = character column (0-31)
+                    uint32_t x = (cellTs / TSTATES_PER_CHAR) - (tsLeftBorderEnd / TSTATES_PER_CHAR);
 
-                // Look up RGBA colours (bright variants are at indices 8-15)
-                uint8_t inkIdx = ink + (bright ? 8 : 0);
-                uint8_t paperIdx = paper + (bright ? 8 : 0);
-                uint32_t inkRGBA = SPECTRUM_COLORS[inkIdx];
-                uint32_t paperRGBA = SPECTRUM_COLORS[paperIdx];
+                    uint8_t pixelByte = bitmapRow[x];
+                    uint8_t attrByte = attrRow[x];
 
-                // Render 8 pixels and encode PAL composite signal
-                uint32_t idx = bufferIndex_;
-                bool palFlip = (line & 1) != 0;
+                    // Decode the attribute byte
+                    bool flash = (attrByte & 0x80) != 0;
+                    bool bright = (attrByte & 0x40) != 0;
+                    uint8_t ink = attrByte & 0x07;
+                    uint8_t paper = (attrByte >> 3) & 0x07;
 
-                for (int bit = 7; bit >= 0; bit--)
-                {
-                    bool isInk = (pixelByte & (1 << bit)) != 0;
-                    pixels[idx] = isInk ? inkRGBA : paperRGBA;
-
-                    uint8_t palIdx = isInk ? inkIdx : paperIdx;
-                    const float* yuv = yuvTable_[palIdx];
-                    float signal = yuv[0] + yuv[1] * sinPhase_ + (palFlip ? -yuv[2] : yuv[2]) * cosPhase_;
-                    int encoded = static_cast<int>((signal + SIGNAL_OFFSET) * SIGNAL_SCALE);
-                    signalBuffer_[idx] = static_cast<uint8_t>(
-                        encoded < 0 ? 0 : (encoded > 255 ? 255 : encoded));
-
-                    float newSin = sinPhase_ * COS_INC + cosPhase_ * SIN_INC;
-                    float newCos = cosPhase_ * COS_INC - sinPhase_ * SIN_INC;
-                    sinPhase_ = newSin;
-                    cosPhase_ = newCos;
-
-                    idx++;
+                    if (flash && flashMask)
+                    {
+                        uint8_t tmp = ink;
+                        ink = paper;
+                        paper = tmp;
+                    }
+
+                    // Skip cells that already show this bitmap and colouring
+                    uint32_t idx = bufferIndex_;
+                    bufferIndex_ += 8;
+                    uint16_t shown = static_cast<uint16_t>(
+                        (pixelByte << 8) | (attrByte & 0x40) | (paper << 3) | ink);
+                    if (shadowRow[x] == shown)
+                    {
+                        continue;
+                    }
+                    shadowRow[x] = shown;
+                    markRowDirty(line);
+
+                    // Look up RGBA colours (bright variants are at indices 8-15)
+                    uint8_t inkIdx = ink + (bright ? 8 : 0);
+                    uint8_t paperIdx = paper + (bright ? 8 : 0);
+
+                    // Render 8 pixels and their PAL composite signal
+                    expandCell(pixels + idx, &signalBuffer_[idx], pixelByte,
+                               SPECTRUM_COLORS[inkIdx], SPECTRUM_COLORS[paperIdx],
+                               lineSignal + inkIdx * TOTAL_WIDTH + cellTs * 2,
+                               lineSignal + paperIdx * TOTAL_WIDTH + cellTs * 2);
                 }
-                bufferIndex_ += 8;
                 break;
             }
 
@@ -356,9 +516,7 @@ void Display::updateWithTs(int32_t tStates, const uint8_t* memory,
                 break;
         }
 
-        // Advance by one character cell (4 T-states = 8 pixels)
-        currentDisplayTs_ += TSTATES_PER_CHAR;
-        tStates -= TSTATES_PER_CHAR;
+        currentDisplayTs_ = endTs;
     }
 }
 
@@ -18,8 +18,10 @@
 #pragma once
 
 #include "machine_info.hpp"
+#include "../core/state_stream.hpp"
 #include <array>
 #include <cstdint>
+#include <vector>
 
 namespace zxspec {
 
@@ -29,6 +31,10 @@ public:
     void frameReset();
     void clearFramebuffer();
 
+    // Beam position, framebuffers and the shadows of what they show
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Render pixels for the given number of T-states, advancing the internal
     // display position. Called after each CPU instruction (or group) to keep
     // the framebuffer in sync with the CPU's progress through the frame.
@@ -41,6 +47,18 @@ public:
     const uint8_t* getSignalBuffer() const;
     int getSignalBufferSize() const;
 
+    // Bitmap of framebuffer rows whose pixels changed since the last
+    // clearDirtyRows(): bit (row & 31) of word (row >> 5), DIRTY_ROW_WORDS
+    // words. The signal buffer changes on exactly the same rows.
+    static constexpr uint32_t DIRTY_ROW_WORDS = (TOTAL_HEIGHT + 31) / 32;
+    const uint32_t* getDirtyRows() const { return dirtyRows_.data(); }
+    void clearDirtyRows() { dirtyRows_.fill(0); }
+
+    // While disabled, updateWithTs() draws nothing and leaves the display
+    // position alone. Used for the frames turbo mode runs but never shows;
+    // the framebuffer and its shadows stay as the last drawn frame left them.
+    void setRenderingEnabled(bool enabled) { renderingEnabled_ = enabled; }
+
     // Returns the T-state position the display has been rendered up to so far
     // in the current frame. Used by the machine to calculate how many T-states
     // of display need catching up after a CPU instruction.
@@ -67,10 +85,77 @@ public:
     // fetching screen data.
     uint8_t floatingBus(uint32_t cpuTStates, const uint8_t* memory) const;
 
+    // Whether a write to screen memory offset (bitmap or attribute byte) has
+    // to be preceded by catching the display up to display T-state ts. Only
+    // cells showing the byte that are due before ts but not yet drawn need
+    // the old value; drawn cells keep it until next frame, and cells from ts
+    // onwards should read the new one. An attribute covers 8 lines of cells.
+    bool isCellPending(uint32_t offset, uint32_t ts) const
+    {
+        if (offset >= BITMAP_SIZE + ATTR_SIZE) return false;
+
+        uint32_t line;
+        uint32_t lines = 1;
+        if (offset < BITMAP_SIZE)
+        {
+            line = bitmapLine(offset);
+        }
+        else
+        {
+            line = ((offset - BITMAP_SIZE) >> 5) * 8;
+            lines = 8;
+        }
+
+        uint32_t cellTs = (paperStartLine_ + line) * tsPerScanline_
+                        + PX_EMU_BORDER_H / 2 + (offset & 0x1F) * TSTATES_PER_CHAR;
+        for (uint32_t i = 0; i < lines && cellTs < ts; i++, cellTs += tsPerScanline_)
+        {
+            if (cellTs >= currentDisplayTs_) return true;
+        }
+        return false;
+    }
+
+    // Note a write to screen memory offset, after any catch-up for it, so
+    // the paper lines showing the byte are compared against their shadow
+    // when next drawn. Lines nobody wrote are skipped outright.
+    void markScreenWrite(uint32_t offset)
+    {
+        if (offset < BITMAP_SIZE)
+        {
+            uint32_t line = bitmapLine(offset);
+            writtenLines_[line >> 5] |= 1u << (line & 31);
+        }
+        else if (offset < BITMAP_SIZE + ATTR_SIZE)
+        {
+            // An attribute row is 8 lines starting on a multiple of 8, so
+            // they share a word
+            uint32_t line = ((offset - BITMAP_SIZE) >> 5) * 8;
+            writtenLines_[line >> 5] |= 0xFFu << (line & 31);
+        }
+    }
+
+    // The screen may have changed anywhere (a bulk load or restore)
+    void markScreenChanged() { writtenLines_.fill(0xFFFFFFFF); }
+
 private:
-    void buildTsTable();
+    static constexpr uint32_t BITMAP_SIZE = (SCREEN_WIDTH / 8) * SCREEN_HEIGHT;
+    static constexpr uint32_t ATTR_SIZE = BITMAP_SIZE / 8;
+
+    // Paper line (0-191) shown by bitmap offset; see buildLineAddressTable()
+    static uint32_t bitmapLine(uint32_t offset)
+    {
+        return ((offset >> 5) & 0xC0) | ((offset >> 8) & 0x07) | ((offset >> 2) & 0x38);
+    }
+
+    void buildSpanList();
     void buildLineAddressTable();
-    void buildYUVTable();
+    void buildSignalTable();
+    void invalidate();
+    void markRowDirty(uint32_t line)
+    {
+        uint32_t row = line - firstVisibleLine_;
+        dirtyRows_[row >> 5] |= 1u << (row & 31);
+    }
 
     // The RGBA framebuffer: 352×304 pixels × 4 bytes per pixel.
     // Written to progressively during each frame and read by the WebGL renderer.
@@ -81,17 +166,15 @@ private:
     // The GPU decode shader demodulates and separates luma/chroma.
     std::array<uint8_t, SIGNAL_BUFFER_SIZE> signalBuffer_{};
 
-    // Pre-computed YUV values for each of the 16 Spectrum palette colours
-    float yuvTable_[16][3]{};
-
-    // Phase state for PAL subcarrier oscillator (sin/cos recurrence)
-    uint32_t currentLine_ = 0;
-    float sinPhase_ = 0.0f;
-    float cosPhase_ = 1.0f;
+    // Pre-encoded PAL composite byte for every [line parity][palette colour]
+    // [pixel x]. The subcarrier phase restarts at the left edge of each
+    // scanline, so the encoded signal depends only on these three values.
+    uint8_t signalTable_[2][16][TOTAL_WIDTH]{};
 
     // How far through the frame the display has been rendered (in T-states).
     // Advances in steps of TSTATES_PER_CHAR (4) as each 8-pixel block is drawn.
     uint32_t currentDisplayTs_ = 0;
+    bool renderingEnabled_ = true;
 
     // Write position in the framebuffer (in pixels, not bytes).
     // Only advances for visible pixels (border + paper), not during retrace.
@@ -107,10 +190,39 @@ private:
     uint32_t ulaTsToDisplay_ = 0;       // T-state when ULA begins screen fetch
     uint32_t tsPerFrame_ = 0;           // Total T-states per frame
 
-    // Pre-calculated action for every (scanline, T-state) position in the frame.
-    // Values are DISPLAY_RETRACE, DISPLAY_BORDER, or DISPLAY_PAPER. This avoids
-    // per-pixel branching in the hot rendering loop.
-    uint32_t tstateTable_[MAX_SCANLINES][MAX_TS_PER_LINE]{};
+    // A run of character cells in one scanline that all get the same action
+    // (DISPLAY_RETRACE, DISPLAY_BORDER or DISPLAY_PAPER). Retrace runs may
+    // continue across scanlines, so vertical blank is a single span.
+    struct DisplaySpan {
+        uint32_t startTs;       // Frame T-state of the first cell
+        uint32_t endTs;         // Frame T-state just past the last cell
+        uint16_t line;          // Scanline of the first cell
+        uint16_t lineTs;        // T-state of the first cell within its scanline
+        uint32_t action;
+    };
+
+    // The whole frame as consecutive spans, built once at init, and the span
+    // containing currentDisplayTs_
+    std::vector<DisplaySpan> spans_;
+    uint32_t spanIndex_ = 0;
+
+    // What each character cell of the framebuffer currently shows, so a cell
+    // whose inputs match is not redrawn. Border cells hold the border colour
+    // and paper cells hold (bitmap << 8) | attribute with FLASH already
+    // applied. 0xFF / 0xFFFF (never produced) mark a cell as unknown.
+    uint8_t borderShadow_[TOTAL_HEIGHT][TOTAL_WIDTH / 8]{};
+    uint16_t paperShadow_[SCREEN_HEIGHT][SCREEN_WIDTH / 8]{};
+    std::array<uint32_t, DIRTY_ROW_WORDS> dirtyRows_{};
+    uint32_t firstVisibleLine_ = 0;     // Scanline drawn into framebuffer row 0
+
+    // Paper lines whose screen bytes were written since the line was last
+    // drawn, one bit per line, set by markScreenWrite(). A line is compared
+    // cell by cell only if its bit is set; the bit is cleared as the line
+    // starts, so a write behind the beam is still seen next frame. A new
+    // screen bank or flash phase sets every bit.
+    std::array<uint32_t, SCREEN_HEIGHT / 32> writtenLines_{};
+    const uint8_t* shownMemory_ = nullptr;
+    uint8_t shownFlashMask_ = 0;
 
     // Pre-calculated screen memory offset for each of the 192 paper lines.
     // The ZX Spectrum's screen memory layout is not linear — see buildLineAddressTable().
@@ -81,6 +81,94 @@ void UPD765A::reset()
     seekResultST0_[1] = 0xC1;  // Abnormal termination (ready line changed), drive 1
 }
 
+void UPD765A::saveState(StateWriter& writer) const
+{
+    writer.write(phase_);
+    writer.write(motorOn_);
+    writer.write(commandBuffer_);
+    writer.write(commandParamCount_);
+    writer.write(currentCommand_);
+    writer.write(resultBuffer_);
+    writer.write(resultIndex_);
+    writer.write(dataBuffer_);
+    writer.write(dataIndex_);
+    writer.write(executionRead_);
+    writer.write(xferDrive_);
+    writer.write(xferTrack_);
+    writer.write(xferSide_);
+    writer.write(xferSector_);
+    writer.write(xferSizeCode_);
+    writer.write(xferEOT_);
+    writer.write(xferMultiTrack_);
+    writer.write(xferDeletedData_);
+    writer.write(xferSkip_);
+    writer.write(xferWeakSector_);
+    writer.write(xferCMTerminate_);
+    writer.write(xferST1_);
+    writer.write(xferST2_);
+    writer.write(lastSectorC_);
+    writer.write(lastSectorH_);
+    writer.write(lastSectorR_);
+    writer.write(lastSectorN_);
+    writer.write(formatSectorsRemaining_);
+    writer.write(formatSizeCode_);
+    writer.write(formatSectorsPerTrack_);
+    writer.write(formatGap3_);
+    writer.write(formatFiller_);
+    writer.write(formatIdBuffer_);
+    writer.write(currentTrack_);
+    writer.write(readIdIndex_);
+    writer.write(msrPollCount_);
+    writer.write(seekCompleted_);
+    writer.write(seekResultST0_);
+}
+
+bool UPD765A::loadState(StateReader& reader)
+{
+    reader.read(phase_, Phase::Result);
+    reader.read(motorOn_);
+    reader.read(commandBuffer_);
+    reader.read(commandParamCount_);
+    reader.read(currentCommand_);
+    reader.read(resultBuffer_);
+    reader.read(resultIndex_);
+    reader.read(dataBuffer_);
+    reader.read(dataIndex_);
+    reader.read(executionRead_);
+    reader.read(xferDrive_);
+    reader.read(xferTrack_);
+    reader.read(xferSide_);
+    reader.read(xferSector_);
+    reader.read(xferSizeCode_);
+    reader.read(xferEOT_);
+    reader.read(xferMultiTrack_);
+    reader.read(xferDeletedData_);
+    reader.read(xferSkip_);
+    reader.read(xferWeakSector_);
+    reader.read(xferCMTerminate_);
+    reader.read(xferST1_);
+    reader.read(xferST2_);
+    reader.read(lastSectorC_);
+    reader.read(lastSectorH_);
+    reader.read(lastSectorR_);
+    reader.read(lastSectorN_);
+    reader.read(formatSectorsRemaining_);
+    reader.read(formatSizeCode_);
+    reader.read(formatSectorsPerTrack_);
+    reader.read(formatGap3_);
+    reader.read(formatFiller_);
+    reader.read(formatIdBuffer_);
+    reader.read(currentTrack_);
+    reader.read(readIdIndex_);
+    reader.read(msrPollCount_);
+    reader.read(seekCompleted_);
+    reader.read(seekResultST0_);
+    xferDrive_ &= 1;
+    if (resultIndex_ < 0 || static_cast<size_t>(resultIndex_) > resultBuffer_.size()) resultIndex_ = 0;
+    if (dataIndex_ < 0 || static_cast<size_t>(dataIndex_) > dataBuffer_.size()) dataIndex_ = 0;
+    return reader.ok();
+}
+
 void UPD765A::insertDisk(int drive, DiskImage* image)
 {
     if (drive >= 0 && drive <= 1) {
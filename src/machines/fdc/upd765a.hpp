@@ -17,6 +17,7 @@
 #pragma once
 
 #include "disk_image.hpp"
+#include "../../core/state_stream.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -28,6 +29,10 @@ public:
 
     void reset();
 
+    // Every register and transfer in progress; not the inserted disks
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Connect a disk image to drive A (drive 0) or B (drive 1).
     // The +3 only has drive A, but we support B for completeness.
     void insertDisk(int drive, DiskImage* image);
@@ -0,0 +1,48 @@
+/*
+ * input_journal.cpp - Log of the inputs fed to a machine
+ */
+
+#include "input_journal.hpp"
+#include <algorithm>
+
+namespace zxspec {
+
+void InputJournal::record(uint32_t frame, uint32_t ts, EventType type, uint8_t a, uint8_t b)
+{
+    commitResume();
+
+    // An event from before the newest one replaces the old future
+    while (!events_.empty() &&
+           (events_.back().frame > frame || (events_.back().frame == frame && events_.back().ts > ts)))
+    {
+        events_.pop_back();
+    }
+
+    events_.push_back(Event{ nextSequence_++, frame, ts, type, a, b });
+}
+
+void InputJournal::commitResume()
+{
+    if (!resumePending_) return;
+    resumePending_ = false;
+    truncateFrom(resumeFrame_);
+}
+
+void InputJournal::truncateFrom(uint32_t frame)
+{
+    events_.erase(events_.begin() + static_cast<std::ptrdiff_t>(firstAtFrame(frame)), events_.end());
+}
+
+void InputJournal::dropBefore(uint32_t frame)
+{
+    events_.erase(events_.begin(), events_.begin() + static_cast<std::ptrdiff_t>(firstAtFrame(frame)));
+}
+
+size_t InputJournal::firstAtFrame(uint32_t frame) const
+{
+    auto it = std::lower_bound(events_.begin(), events_.end(), frame,
+        [](const Event& event, uint32_t f) { return event.frame < f; });
+    return static_cast<size_t>(it - events_.begin());
+}
+
+} // namespace zxspec
@@ -0,0 +1,80 @@
+/*
+ * input_journal.hpp - Log of the inputs fed to a machine
+ *
+ * The machine's inputs are logged with the frame counter and T-state they
+ * arrived at: keyboard matrix changes, the Kempston port and tape transport
+ * buttons. Emulation is otherwise deterministic, so restoring a snapshot
+ * and re-applying the logged inputs at the same points reproduces any later
+ * frame exactly (see ZXSpectrum::replayInputTo). Edits from outside the
+ * machine (memory pokes, register writes, an NMI) are not logged; the
+ * front end drops the time-travel history before making one instead.
+ *
+ * Events must arrive in time order. One stamped earlier than the newest
+ * event starts a new timeline, and the events after it are dropped. After
+ * a rewind, resumeAt() defers that cut: the later events stay available
+ * for replay until the next event is recorded or commitResume() is called.
+ *
+ * Every event also gets a sequence number, increasing in recording order.
+ * Several events can share a frame and T-state with a snapshot taken
+ * between them; nextSequence() taken with the snapshot tells them apart.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace zxspec {
+
+class InputJournal {
+public:
+    enum class EventType : uint8_t {
+        KeyDown,            // a = row, b = bit
+        KeyUp,              // a = row, b = bit
+        Kempston,           // a = port value
+        TapePlay,
+        TapeStop,
+        TapeRewind,
+        TapeRewindBlock,
+        TapeForwardBlock,
+    };
+
+    struct Event {
+        uint64_t sequence;
+        uint32_t frame;
+        uint32_t ts;
+        EventType type;
+        uint8_t a;
+        uint8_t b;
+    };
+
+    void record(uint32_t frame, uint32_t ts, EventType type, uint8_t a = 0, uint8_t b = 0);
+    void clear() { events_.clear(); resumePending_ = false; }
+
+    // The machine was rewound to frame. The events from there on are the
+    // old future, dropped by the next record() or commitResume().
+    void resumeAt(uint32_t frame) { resumePending_ = true; resumeFrame_ = frame; }
+    void commitResume();
+
+    // Drop the events stamped at or after frame (a new timeline from there)
+    void truncateFrom(uint32_t frame);
+    // Drop the events stamped before frame (history no longer reachable)
+    void dropBefore(uint32_t frame);
+
+    // Index of the first event stamped at or after frame
+    size_t firstAtFrame(uint32_t frame) const;
+
+    uint64_t nextSequence() const { return nextSequence_; }
+
+    size_t size() const { return events_.size(); }
+    const Event& operator[](size_t index) const { return events_[index]; }
+
+private:
+    std::deque<Event> events_;
+    uint64_t nextSequence_ = 0;
+    bool resumePending_ = false;
+    uint32_t resumeFrame_ = 0;
+};
+
+} // namespace zxspec
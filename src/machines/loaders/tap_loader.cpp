@@ -39,17 +39,12 @@ bool TAPLoader::load(ZXSpectrum& machine, const uint8_t* data, uint32_t size)
         metadata.totalDataBytes += static_cast<uint32_t>(block.data.size());
     }
 
-    // Generate pulse sequences reusing TZX standard timing
-    std::vector<uint32_t> pulses;
-    std::vector<size_t> blockPulseStarts;
-    TZXLoader::generatePulses(blocks, pulses, blockPulseStarts);
-
     // Store in machine (base class members, accessed via friend)
     machine.tapeBlocks_ = std::move(blocks);
     machine.tapeBlockIndex_ = 0;
     machine.tapeActive_ = true;
-    machine.tapePulses_ = std::move(pulses);
-    machine.tapePulseBlockStarts_ = std::move(blockPulseStarts);
+    machine.tapeChanges_++;
+    machine.tapePulses_.build(machine.tapeBlocks_);
     machine.tapePulseIndex_ = 0;
     machine.tapePulseRemaining_ = 0;
     machine.tapeEarLevel_ = false;
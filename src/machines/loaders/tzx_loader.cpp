@@ -43,17 +43,12 @@ bool TZXLoader::load(ZXSpectrum& machine, const uint8_t* data, uint32_t size)
         metadata.totalDataBytes += static_cast<uint32_t>(block.data.size());
     }
 
-    // Generate pulse sequences for EAR bit playback
-    std::vector<uint32_t> pulses;
-    std::vector<size_t> blockPulseStarts;
-    generatePulses(blocks, pulses, blockPulseStarts);
-
     // Store in machine (base class members, accessed via friend)
     machine.tapeBlocks_ = std::move(blocks);
     machine.tapeBlockIndex_ = 0;
     machine.tapeActive_ = true;
-    machine.tapePulses_ = std::move(pulses);
-    machine.tapePulseBlockStarts_ = std::move(blockPulseStarts);
+    machine.tapeChanges_++;
+    machine.tapePulses_.build(machine.tapeBlocks_);
     machine.tapePulseIndex_ = 0;
     machine.tapePulseRemaining_ = 0;
     machine.tapeEarLevel_ = false;
@@ -66,57 +61,6 @@ bool TZXLoader::load(ZXSpectrum& machine, const uint8_t* data, uint32_t size)
     return true;
 }
 
-void TZXLoader::generatePulses(const std::vector<TapeBlock>& blocks,
-                               std::vector<uint32_t>& pulses,
-                               std::vector<size_t>& blockPulseStarts)
-{
-    for (size_t bi = 0; bi < blocks.size(); bi++)
-    {
-        const auto& block = blocks[bi];
-        blockPulseStarts.push_back(pulses.size());
-
-        if (block.data.empty()) continue;
-
-        // Pilot tone
-        if (block.hasPilot)
-        {
-            uint16_t pilotCount = block.pilotCount;
-            if (pilotCount == 0)
-            {
-                pilotCount = (block.data[0] < 128) ? 8063 : 3223;
-            }
-            for (uint16_t i = 0; i < pilotCount; i++)
-                pulses.push_back(block.pilotPulse);
-
-            pulses.push_back(block.sync1);
-            pulses.push_back(block.sync2);
-        }
-
-        // Data bits
-        size_t totalBytes = block.data.size();
-        for (size_t b = 0; b < totalBytes; b++)
-        {
-            uint8_t byte = block.data[b];
-            int bits = (b == totalBytes - 1) ? block.usedBitsLastByte : 8;
-            for (int bit = 7; bit >= 8 - bits; bit--)
-            {
-                uint32_t pulse = (byte & (1 << bit)) ? block.onePulse : block.zeroPulse;
-                pulses.push_back(pulse);
-                pulses.push_back(pulse);
-            }
-        }
-
-        // Pause after block
-        if (block.pauseMs > 0)
-        {
-            uint32_t pauseTs = static_cast<uint32_t>(block.pauseMs) * 3500;
-            pulses.push_back(pauseTs);
-        }
-    }
-
-    blockPulseStarts.push_back(pulses.size());
-}
-
 bool TZXLoader::parseBlocks(const uint8_t* data, uint32_t size,
                             std::vector<TapeBlock>& blocks, TapeMetadata& metadata)
 {
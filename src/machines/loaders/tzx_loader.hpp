@@ -19,9 +19,6 @@ class ZXSpectrum;
 class TZXLoader {
 public:
     static bool load(ZXSpectrum& machine, const uint8_t* data, uint32_t size);
-    static void generatePulses(const std::vector<TapeBlock>& blocks,
-                               std::vector<uint32_t>& pulses,
-                               std::vector<size_t>& blockPulseStarts);
 
 private:
     static bool parseBlocks(const uint8_t* data, uint32_t size,
@@ -1,8 +1,9 @@
 /*
  * z80_saver.cpp - Z80 v3 snapshot format writer for ZX Spectrum
  *
- * Writes a Z80 v3 format snapshot. Memory pages are stored uncompressed
- * (compressedLength = 0xFFFF) for simplicity and reliability.
+ * Writes a Z80 v3 format snapshot. Memory pages are compressed with the
+ * format's ED ED RLE straight into the output buffer; a page that doesn't
+ * shrink below 16K is stored uncompressed (compressedLength = 0xFFFF).
  *
  * Written by
  *  Mike Daley <michael_daley@icloud.com>
@@ -11,6 +12,7 @@
 #include "z80_saver.hpp"
 #include "../zx_spectrum.hpp"
 #include "../machine_info.hpp"
+#include <algorithm>
 #include <cstring>
 
 namespace zxspec {
@@ -21,24 +23,18 @@ static void writeLE16(uint8_t* dst, uint16_t value)
     dst[1] = (value >> 8) & 0xFF;
 }
 
-uint32_t Z80Saver::save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t bufferSize)
+uint32_t Z80Saver::saveHeader(const ZXSpectrum& machine, uint8_t* buffer, uint32_t bufferSize)
 {
     const Z80* cpu = machine.getCPU();
     if (!cpu) return 0;
 
     int machineId = machine.getId();
-    bool is128K = machineId != eZXSpectrum48;
     bool isPlus2AOrPlus3 = (machineId == eZXSpectrum128_2A || machineId == eZXSpectrum128_3);
 
     // +2A/+3 use a 55-byte additional header (extra byte for port 0x1FFD)
     uint32_t additionalHeaderSize = isPlus2AOrPlus3 ? ADDITIONAL_HEADER_SIZE_PLUS3 : ADDITIONAL_HEADER_SIZE_STD;
     uint32_t totalHeaderSize = MAIN_HEADER_SIZE + 2 + additionalHeaderSize;
-
-    // Calculate required size: header + pages
-    // Each page: 3 bytes header + 16384 bytes data (uncompressed)
-    uint32_t pageCount = is128K ? 8 : 3;
-    uint32_t requiredSize = totalHeaderSize + pageCount * (3 + MEM_PAGE_SIZE);
-    if (requiredSize > bufferSize) return 0;
+    if (totalHeaderSize > bufferSize) return 0;
 
     std::memset(buffer, 0, totalHeaderSize);
 
@@ -60,7 +56,8 @@ uint32_t Z80Saver::save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t buf
     uint8_t r = machine.getR();
     buffer[11] = r & 0x7F;
 
-    // Byte 12: bit 0 = R bit 7, bits 1-3 = border colour, bit 5 = 0 (uncompressed pages)
+    // Byte 12: bit 0 = R bit 7, bits 1-3 = border colour (bit 5, compression,
+    // only applies to v1; v3 pages carry their own length)
     uint8_t byte12 = (r >> 7) & 0x01;
     byte12 |= (machine.getBorderColor() << 1) & 0x0E;
     buffer[12] = byte12;
@@ -136,23 +133,96 @@ uint32_t Z80Saver::save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t buf
 
     // Bytes 59-85: zeros (unused) - already zeroed by memset
 
+    return totalHeaderSize;
+}
+
+// ED ED RLE: runs of five or more identical bytes, and any run of ED
+// bytes longer than one, become ED ED count value. The byte following a
+// lone ED is always written as is. Returns the compressed length, or 0 if
+// it would reach limit bytes.
+static uint32_t compressPage(const uint8_t* page, uint8_t* dst, uint32_t limit)
+{
+    uint32_t out = 0;
+    uint32_t i = 0;
+    while (i < MEM_PAGE_SIZE)
+    {
+        uint8_t value = page[i];
+        uint32_t run = 1;
+        while (i + run < MEM_PAGE_SIZE && run < 255 && page[i + run] == value) run++;
+
+        if (run >= 5 || (value == 0xED && run >= 2))
+        {
+            if (out + 4 >= limit) return 0;
+            dst[out++] = 0xED;
+            dst[out++] = 0xED;
+            dst[out++] = static_cast<uint8_t>(run);
+            dst[out++] = value;
+            i += run;
+        }
+        else if (value == 0xED)
+        {
+            // A lone ED takes the next byte with it uncompressed
+            uint32_t take = (i + 1 < MEM_PAGE_SIZE) ? 2 : 1;
+            if (out + take >= limit) return 0;
+            for (uint32_t k = 0; k < take; k++) dst[out++] = page[i + k];
+            i += take;
+        }
+        else
+        {
+            if (out + run >= limit) return 0;
+            for (uint32_t k = 0; k < run; k++) dst[out++] = value;
+            i += run;
+        }
+    }
+    return out;
+}
+
+// Write one page block at offset: compressed if that saves space and fits,
+// otherwise raw. Returns the bytes written, or 0 if the buffer is full.
+static uint32_t writePage(const uint8_t* page, uint8_t pageId, uint8_t* buffer, uint32_t offset, uint32_t bufferSize)
+{
+    if (bufferSize - offset < 3) return 0;
+    uint32_t room = bufferSize - offset - 3;
+
+    uint32_t length = compressPage(page, buffer + offset + 3, std::min(room + 1, MEM_PAGE_SIZE));
+    if (length > 0)
+    {
+        writeLE16(buffer + offset, static_cast<uint16_t>(length));
+    }
+    else
+    {
+        if (room < MEM_PAGE_SIZE) return 0;
+        std::memcpy(buffer + offset + 3, page, MEM_PAGE_SIZE);
+        writeLE16(buffer + offset, 0xFFFF);  // Uncompressed marker
+        length = MEM_PAGE_SIZE;
+    }
+    buffer[offset + 2] = pageId;
+    return 3 + length;
+}
+
+uint32_t Z80Saver::save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t bufferSize)
+{
+    bool is128K = machine.getId() != eZXSpectrum48;
+
+    uint32_t totalHeaderSize = saveHeader(machine, buffer, bufferSize);
+    if (totalHeaderSize == 0) return 0;
+
     // --- Memory pages ---
     uint32_t offset = totalHeaderSize;
+    uint8_t page[MEM_PAGE_SIZE];
 
     if (is128K)
     {
         // 128K: 8 pages, pageId 3-10 = RAM banks 0-7
         for (uint8_t bank = 0; bank < 8; bank++)
         {
-            writeLE16(buffer + offset, 0xFFFF);  // Uncompressed marker
-            buffer[offset + 2] = bank + 3;        // Page ID
-            offset += 3;
-
             for (uint32_t i = 0; i < MEM_PAGE_SIZE; i++)
             {
-                buffer[offset + i] = machine.readRamBank(bank, static_cast<uint16_t>(i));
+                page[i] = machine.readRamBank(bank, static_cast<uint16_t>(i));
             }
-            offset += MEM_PAGE_SIZE;
+            uint32_t written = writePage(page, bank + 3, buffer, offset, bufferSize);
+            if (written == 0) return 0;
+            offset += written;
         }
     }
     else
@@ -168,17 +238,15 @@ uint32_t Z80Saver::save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t buf
             { 5, 2 },
         };
 
-        for (const auto& page : pages)
+        for (const auto& def : pages)
         {
-            writeLE16(buffer + offset, 0xFFFF);  // Uncompressed marker
-            buffer[offset + 2] = page.pageId;
-            offset += 3;
-
             for (uint32_t i = 0; i < MEM_PAGE_SIZE; i++)
             {
-                buffer[offset + i] = machine.readRamBank(page.ramBank, static_cast<uint16_t>(i));
+                page[i] = machine.readRamBank(def.ramBank, static_cast<uint16_t>(i));
             }
-            offset += MEM_PAGE_SIZE;
+            uint32_t written = writePage(page, def.pageId, buffer, offset, bufferSize);
+            if (written == 0) return 0;
+            offset += written;
         }
     }
 
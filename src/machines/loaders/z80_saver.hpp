@@ -17,10 +17,18 @@ class Z80Saver {
 public:
     static uint32_t save(const ZXSpectrum& machine, uint8_t* buffer, uint32_t bufferSize);
 
+    // Write just the header (registers, paging, AY, T-states) with no memory
+    // pages. Loading it restores everything but RAM. Returns its length, at
+    // most MAX_HEADER_SIZE, or 0 if the buffer is too small.
+    static uint32_t saveHeader(const ZXSpectrum& machine, uint8_t* buffer, uint32_t bufferSize);
+
 private:
     static constexpr uint32_t MAIN_HEADER_SIZE = 30;
     static constexpr uint32_t ADDITIONAL_HEADER_SIZE_STD = 54;
     static constexpr uint32_t ADDITIONAL_HEADER_SIZE_PLUS3 = 55;  // +2A/+3: extra byte for 0x1FFD
+
+public:
+    static constexpr uint32_t MAX_HEADER_SIZE = MAIN_HEADER_SIZE + 2 + ADDITIONAL_HEADER_SIZE_PLUS3;
 };
 
 } // namespace zxspec
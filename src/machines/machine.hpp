@@ -31,10 +31,25 @@ public:
     virtual int getFramebufferSize() const = 0;
     virtual const uint8_t* getSignalBuffer() const = 0;
     virtual int getSignalBufferSize() const = 0;
+
+    // Bitmap of framebuffer rows changed since clearDirtyRows() (bit n of
+    // word n / 32 = row n), or nullptr if the machine does not track them
+    // and every row should be treated as changed
+    virtual const uint32_t* getDirtyRows() const { return nullptr; }
+    virtual void clearDirtyRows() {}
     virtual const float* getAudioBuffer() const = 0;
     virtual int getAudioSampleCount() const = 0;
     virtual void resetAudioBuffer() = 0;
 
+    // Interleaved float32 L/R frames, or nullptr if the machine only has
+    // mono output or stereo output is off. Reset along with the mono buffer
+    // by resetAudioBuffer().
+    virtual const float* getStereoAudioBuffer() const { return nullptr; }
+    virtual int getStereoAudioFrameCount() const { return 0; }
+
+    // Stereo output is mixed only while enabled (off by default)
+    virtual void setStereoOutputEnabled(bool /*enabled*/) {}
+
     virtual void keyDown(int row, int bit) = 0;
     virtual void keyUp(int row, int bit) = 0;
     virtual uint8_t getKeyboardRow(int row) const = 0;
@@ -128,7 +128,7 @@ constexpr double   CPU_CLOCK_HZ         = 3500000.0;
 // Memory
 constexpr uint32_t MEM_PAGE_SIZE        = 16384;
 
-// Display action types for T-state table
+// Display actions for the spans of a frame (see Display::buildSpanList)
 constexpr uint32_t DISPLAY_RETRACE      = 0;
 constexpr uint32_t DISPLAY_BORDER       = 1;
 constexpr uint32_t DISPLAY_PAPER        = 2;
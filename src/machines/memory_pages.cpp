@@ -0,0 +1,62 @@
+/*
+ * memory_pages.cpp - Reference-counted 16K memory pages
+ */
+
+#include "memory_pages.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace zxspec {
+
+void MemoryPages::allocate(uint32_t size)
+{
+    size_ = size;
+    pages_.clear();
+    for (uint32_t at = 0; at < size; at += MEM_PAGE_SIZE) {
+        pages_.emplace_back(new uint8_t[MEM_PAGE_SIZE]());
+    }
+}
+
+uint8_t* MemoryPages::writable(uint32_t index)
+{
+    std::shared_ptr<uint8_t[]>& page = pages_[index];
+    if (page.use_count() > 1) {
+        std::shared_ptr<uint8_t[]> copy(new uint8_t[MEM_PAGE_SIZE]);
+        std::memcpy(copy.get(), page.get(), MEM_PAGE_SIZE);
+        page = std::move(copy);
+    } else {
+        // A fork on another thread may have just let go of the page; its
+        // reads must be done before we write
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return page.get();
+}
+
+void MemoryPages::write(uint32_t address, const uint8_t* data, uint32_t size)
+{
+    while (size > 0) {
+        uint32_t offset = address % MEM_PAGE_SIZE;
+        uint32_t count = std::min(size, MEM_PAGE_SIZE - offset);
+        std::memcpy(writable(address / MEM_PAGE_SIZE) + offset, data, count);
+        address += count;
+        data += count;
+        size -= count;
+    }
+}
+
+void MemoryPages::share(const MemoryPages& other)
+{
+    pages_ = other.pages_;
+    size_ = other.size_;
+}
+
+void MemoryPages::copyTo(uint8_t* dst) const
+{
+    for (uint32_t i = 0; i < pageCount(); i++) {
+        uint32_t at = i * MEM_PAGE_SIZE;
+        std::memcpy(dst + at, page(i), std::min(MEM_PAGE_SIZE, size_ - at));
+    }
+}
+
+} // namespace zxspec
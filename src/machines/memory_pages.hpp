@@ -0,0 +1,59 @@
+/*
+ * memory_pages.hpp - Reference-counted 16K memory pages
+ *
+ * A machine's RAM and ROM are held as separate 16K pages, each owned
+ * through a shared_ptr. share() makes another set refer to the same pages,
+ * so a forked machine starts without copying any memory; a page is only
+ * copied when one of its holders is about to write it (writable()).
+ *
+ * Variants point their pageRead_ tables straight at page(). A pageWrite_
+ * entry points at a bank only while the bank isn't shared, and is null
+ * otherwise, so the first write to a shared bank takes the ROM-protection
+ * branch, which copies it and rebuilds the tables (remapMemory()). Copying
+ * replaces the page, so any code that takes writable() on a shared page
+ * must rebuild the tables too.
+ */
+
+#pragma once
+
+#include "machine_info.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zxspec {
+
+class MemoryPages {
+public:
+    // Fresh, zeroed, unshared pages covering size bytes
+    void allocate(uint32_t size);
+
+    uint32_t size() const { return size_; }
+    uint32_t pageCount() const { return static_cast<uint32_t>(pages_.size()); }
+
+    const uint8_t* page(uint32_t index) const { return pages_[index].get(); }
+    uint8_t operator[](uint32_t address) const
+    {
+        return pages_[address / MEM_PAGE_SIZE][address % MEM_PAGE_SIZE];
+    }
+
+    bool isShared(uint32_t index) const { return pages_[index].use_count() > 1; }
+
+    // The page, copied first if another set shares it
+    uint8_t* writable(uint32_t index);
+
+    // Copy size bytes in from address on, across pages as needed
+    void write(uint32_t address, const uint8_t* data, uint32_t size);
+
+    // Refer to other's pages, discarding this set's own
+    void share(const MemoryPages& other);
+
+    // Every byte, in address order
+    void copyTo(uint8_t* dst) const;
+
+private:
+    std::vector<std::shared_ptr<uint8_t[]>> pages_;
+    uint32_t size_ = 0;
+};
+
+} // namespace zxspec
@@ -41,6 +41,30 @@ void OpusDiscovery::reset()
     fdc_.insertDisk(1, &diskB_);
 }
 
+void OpusDiscovery::saveState(StateWriter& writer) const
+{
+    writer.write(ram_);
+    writer.write(controlLatch_);
+    writer.write(piaDataA_);
+    writer.write(piaControlA_);
+    writer.write(piaDataB_);
+    writer.write(piaControlB_);
+    writer.write(pagedIn_);
+    fdc_.saveState(writer);
+}
+
+bool OpusDiscovery::loadState(StateReader& reader)
+{
+    reader.read(ram_);
+    reader.read(controlLatch_);
+    reader.read(piaDataA_);
+    reader.read(piaControlA_);
+    reader.read(piaDataB_);
+    reader.read(piaControlB_);
+    reader.read(pagedIn_);
+    return fdc_.loadState(reader);
+}
+
 void OpusDiscovery::loadROM(const uint8_t* data, uint32_t size)
 {
     if (!data || size == 0) return;
@@ -249,6 +273,13 @@ bool OpusDiscovery::shouldPageOut(uint16_t address) const
 // Disk image management
 // ============================================================================
 
+void OpusDiscovery::copyMediaFrom(const OpusDiscovery& other)
+{
+    rom_ = other.rom_;
+    diskA_ = other.diskA_;
+    diskB_ = other.diskB_;
+}
+
 void OpusDiscovery::insertDisk(int drive, const uint8_t* data, uint32_t size)
 {
     DiskImage* disk = (drive == 0) ? &diskA_ : &diskB_;
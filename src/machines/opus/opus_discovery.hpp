@@ -49,9 +49,16 @@ public:
 
     void reset();
 
+    // RAM, paging, PIA and the WD1770; not the ROM or the inserted disks
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Load Opus ROM data and pre-initialize RAM tables
     void loadROM(const uint8_t* data, uint32_t size);
 
+    // Take other's ROM and inserted disks, the parts saveState() leaves out
+    void copyMediaFrom(const OpusDiscovery& other);
+
     // Memory access (full 0x0000-0x3FFF overlay when paged in)
     uint8_t memoryRead(uint16_t address);
     void memoryWrite(uint16_t address, uint8_t data);
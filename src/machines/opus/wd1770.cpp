@@ -39,6 +39,56 @@ void WD1770::reset()
     physicalTrack_[1] = 0;
 }
 
+void WD1770::saveState(StateWriter& writer) const
+{
+    writer.write(statusRegister_);
+    writer.write(trackRegister_);
+    writer.write(sectorRegister_);
+    writer.write(dataRegister_);
+    writer.write(selectedDrive_);
+    writer.write(selectedSide_);
+    writer.write(stepDirection_);
+    writer.write(motorOn_);
+    writer.write(motorTimeoutFrames_);
+    writer.write(lastCommandType_);
+    writer.write(dataBuffer_);
+    writer.write(dataIndex_);
+    writer.write(dataReading_);
+    writer.write(dataWriting_);
+    writer.write(multiSector_);
+    writer.write(drqNmiPending_);
+    writer.write(pendingComplete_);
+    writer.write(nextBytePending_);
+    writer.write(physicalTrack_);
+}
+
+bool WD1770::loadState(StateReader& reader)
+{
+    reader.read(statusRegister_);
+    reader.read(trackRegister_);
+    reader.read(sectorRegister_);
+    reader.read(dataRegister_);
+    reader.read(selectedDrive_);
+    reader.read(selectedSide_);
+    reader.read(stepDirection_);
+    reader.read(motorOn_);
+    reader.read(motorTimeoutFrames_);
+    reader.read(lastCommandType_, CommandType::TYPE_IV);
+    reader.read(dataBuffer_);
+    reader.read(dataIndex_);
+    reader.read(dataReading_);
+    reader.read(dataWriting_);
+    reader.read(multiSector_);
+    reader.read(drqNmiPending_);
+    reader.read(pendingComplete_);
+    reader.read(nextBytePending_);
+    reader.read(physicalTrack_);
+    selectedDrive_ &= 1;
+    selectedSide_ &= 1;
+    if (dataIndex_ < 0 || static_cast<size_t>(dataIndex_) > dataBuffer_.size()) dataIndex_ = 0;
+    return reader.ok();
+}
+
 void WD1770::insertDisk(int drive, DiskImage* image)
 {
     if (drive >= 0 && drive < 2) {
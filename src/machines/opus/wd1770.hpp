@@ -18,6 +18,7 @@
 #pragma once
 
 #include "../fdc/disk_image.hpp"
+#include "../../core/state_stream.hpp"
 #include <cstdint>
 #include <vector>
 
@@ -29,6 +30,10 @@ public:
 
     void reset();
 
+    // Every register and transfer in progress; not the inserted disks
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Connect/disconnect disk images (up to 2 drives)
     void insertDisk(int drive, DiskImage* image);
     void ejectDisk(int drive);
@@ -0,0 +1,167 @@
+/*
+ * resampler.cpp - Polyphase sample-rate converter for the audio output
+ */
+
+#include "resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace zxspec {
+
+// Output frame n is at input time position_. With base = floor(position_)
+// and the taps centred on it, tap j reads history frame base - CENTRE + j.
+static constexpr int CENTRE = Resampler::TAPS / 2 - 1;
+
+// Partial sums per dot product; TAPS is a multiple of this
+static constexpr int LANES = 8;
+static_assert(Resampler::TAPS % LANES == 0, "TAPS must be a multiple of LANES");
+
+void Resampler::setup(int inputRate, int outputRate, int channels, int maxInputFrames)
+{
+    inputRate_ = std::max(1, inputRate);
+    outputRate_ = std::max(1, outputRate);
+    channels_ = std::clamp(channels, 1, MAX_CHANNELS);
+    maxInputFrames_ = std::max(1, maxInputFrames);
+
+    for (auto& history : history_) {
+        history.assign(static_cast<size_t>(TAPS + maxInputFrames_), 0.0f);
+    }
+
+    // Room for the largest step adjustment plus the rounding of the phase
+    double maxRatio = static_cast<double>(outputRate_) / inputRate_ * (1.0 + MAX_ADJUSTMENT_PPM / 1e6);
+    maxOutputFrames_ = static_cast<int>(std::ceil(maxInputFrames_ * maxRatio)) + 2;
+    output_.assign(static_cast<size_t>(maxOutputFrames_ * channels_), 0.0f);
+
+    buildFilter();
+    updateStep();
+    reset();
+}
+
+void Resampler::reset()
+{
+    for (auto& history : history_) {
+        std::fill(history.begin(), history.end(), 0.0f);
+    }
+    historyFrames_ = TAPS - 1;
+    position_ = CENTRE;
+    outputFrames_ = 0;
+}
+
+void Resampler::setRateAdjustment(double ppm)
+{
+    adjustmentPpm_ = std::clamp(ppm, -MAX_ADJUSTMENT_PPM, MAX_ADJUSTMENT_PPM);
+    updateStep();
+}
+
+void Resampler::updateStep()
+{
+    step_ = static_cast<double>(inputRate_) /
+            (static_cast<double>(outputRate_) * (1.0 + adjustmentPpm_ / 1e6));
+}
+
+// Blackman-windowed sinc, cut off at 0.45 of the lower of the two rates,
+// tabulated for PHASES + 1 fractional offsets so the interpolation between
+// rows never runs off the end. Each row is normalised to unity DC gain.
+void Resampler::buildFilter()
+{
+    constexpr double pi = 3.14159265358979323846;
+    double cutoff = 0.45 * std::min(1.0, static_cast<double>(outputRate_) / inputRate_);
+
+    filter_.assign(static_cast<size_t>((PHASES + 1) * TAPS), 0.0f);
+    for (int p = 0; p <= PHASES; p++)
+    {
+        double frac = static_cast<double>(p) / PHASES;
+        double row[TAPS];
+        double total = 0.0;
+        for (int j = 0; j < TAPS; j++)
+        {
+            double t = (j - CENTRE) - frac;
+            double x = 2.0 * pi * cutoff * t;
+            double sinc = (t == 0.0) ? 1.0 : std::sin(x) / x;
+            double w = (t + TAPS / 2.0) / TAPS;
+            double window = 0.42 - 0.5 * std::cos(2.0 * pi * w) + 0.08 * std::cos(4.0 * pi * w);
+            row[j] = sinc * window;
+            total += row[j];
+        }
+        for (int j = 0; j < TAPS; j++) {
+            filter_[p * TAPS + j] = static_cast<float>(row[j] / total);
+        }
+    }
+}
+
+// ============================================================================
+// Conversion
+// ============================================================================
+
+void Resampler::process(const float* input, int frames)
+{
+    while (frames > 0)
+    {
+        int chunk = std::min(frames, maxInputFrames_);
+
+        // Append the chunk to the planar history
+        for (int c = 0; c < channels_; c++) {
+            float* dst = history_[c].data() + historyFrames_;
+            for (int i = 0; i < chunk; i++) {
+                dst[i] = input[i * channels_ + c];
+            }
+        }
+        historyFrames_ += chunk;
+        input += chunk * channels_;
+        frames -= chunk;
+
+        // Emit every output frame whose taps are all available
+        for (;;)
+        {
+            int base = static_cast<int>(position_);
+            if (base - CENTRE + TAPS > historyFrames_) break;
+
+            double phase = (position_ - base) * PHASES;
+            int p = static_cast<int>(phase);
+            float blend = static_cast<float>(phase - p);
+            const float* c0 = filter_.data() + p * TAPS;
+            const float* c1 = c0 + TAPS;
+
+            if (outputFrames_ < maxOutputFrames_) {
+                float* out = output_.data() + outputFrames_ * channels_;
+                for (int c = 0; c < channels_; c++) {
+                    const float* x = history_[c].data() + base - CENTRE;
+                    // Eight independent partial sums, so the compiler can
+                    // keep them in vector lanes without reassociating
+                    float acc0[LANES] = {};
+                    float acc1[LANES] = {};
+                    for (int j = 0; j < TAPS; j += LANES) {
+                        for (int k = 0; k < LANES; k++) {
+                            acc0[k] += c0[j + k] * x[j + k];
+                            acc1[k] += c1[j + k] * x[j + k];
+                        }
+                    }
+                    float sum0 = 0.0f;
+                    float sum1 = 0.0f;
+                    for (int k = 0; k < LANES; k++) {
+                        sum0 += acc0[k];
+                        sum1 += acc1[k];
+                    }
+                    out[c] = sum0 + blend * (sum1 - sum0);
+                }
+                outputFrames_++;
+            }
+            position_ += step_;
+        }
+
+        // Drop the frames no future output can reach
+        int consumed = std::min(static_cast<int>(position_) - CENTRE, historyFrames_);
+        if (consumed > 0) {
+            int keep = historyFrames_ - consumed;
+            for (int c = 0; c < channels_; c++) {
+                float* h = history_[c].data();
+                std::memmove(h, h + consumed, static_cast<size_t>(keep) * sizeof(float));
+            }
+            historyFrames_ = keep;
+            position_ -= consumed;
+        }
+    }
+}
+
+} // namespace zxspec
@@ -0,0 +1,80 @@
+/*
+ * resampler.hpp - Polyphase sample-rate converter for the audio output
+ *
+ * The sound sources all run at AUDIO_SAMPLE_RATE. When the host wants a
+ * different rate the mixed output is converted here in one pass, so the
+ * host does not need to resample again. Each output frame is a TAPS-point
+ * dot product of the input with a Blackman-windowed sinc picked from a
+ * table of PHASES fractional offsets (linearly interpolated between the
+ * two nearest), with the cutoff lowered when downsampling so nothing
+ * aliases. The taps are contiguous floats of a fixed count, so the inner
+ * loop vectorises.
+ *
+ * The step between output frames can be nudged by a few thousand ppm so
+ * the audio clock can follow the host's display clock: a host whose queue
+ * is running low asks for a little more output per frame, and vice versa.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace zxspec {
+
+class Resampler {
+public:
+    static constexpr int TAPS = 32;
+    static constexpr int PHASES = 128;
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr double MAX_ADJUSTMENT_PPM = 10000.0;
+
+    // maxInputFrames is the most frames passed to a single process() call;
+    // the output holds everything produced from that much input
+    void setup(int inputRate, int outputRate, int channels, int maxInputFrames);
+
+    // Clear the filter history and any pending output
+    void reset();
+
+    int getInputRate() const { return inputRate_; }
+    int getOutputRate() const { return outputRate_; }
+
+    // Positive values produce more output frames per input frame
+    void setRateAdjustment(double ppm);
+    double getRateAdjustment() const { return adjustmentPpm_; }
+
+    // Convert interleaved input frames, appending to the output. Output is
+    // delayed by TAPS / 2 input frames.
+    void process(const float* input, int frames);
+
+    // Interleaved output frames produced since resetOutput()
+    const float* getOutput() const { return output_.data(); }
+    int getFrameCount() const { return outputFrames_; }
+    void resetOutput() { outputFrames_ = 0; }
+
+private:
+    int inputRate_ = 48000;
+    int outputRate_ = 48000;
+    int channels_ = 1;
+    int maxInputFrames_ = 0;
+    double adjustmentPpm_ = 0.0;
+    double step_ = 1.0;             // Input frames per output frame
+
+    // (PHASES + 1) rows of TAPS coefficients, row p for offset p / PHASES
+    std::vector<float> filter_;
+
+    // Planar input per channel: the last TAPS - 1 frames already used,
+    // then the frames not yet consumed
+    std::vector<float> history_[MAX_CHANNELS];
+    int historyFrames_ = 0;
+    double position_ = 0.0;         // Next output time, in history frames
+
+    std::vector<float> output_;
+    int outputFrames_ = 0;
+    int maxOutputFrames_ = 0;
+
+    void buildFilter();
+    void updateStep();
+};
+
+} // namespace zxspec
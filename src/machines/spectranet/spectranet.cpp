@@ -38,6 +38,48 @@ void Spectranet::reset()
     w5100_.reset();
 }
 
+void Spectranet::saveState(StateWriter& writer) const
+{
+    writer.write(pageA_);
+    writer.write(pageB_);
+    writer.write(progTrapAddr_);
+    writer.write(trapAddrLSBWritten_);
+    writer.write(trapAddrLSB_);
+    writer.write(controlReg_);
+    writer.write(pagedIn_);
+    writer.write(trapEnabled_);
+    writer.write(denyA15_);
+    writer.write(trapInhibit_);
+    writer.write(pagedInViaIO_);
+    writer.write(nmiPageInPending_);
+    writer.write(nmiFlipFlop_);
+    writer.write(flashState_);
+    writer.write(flash_);
+    writer.write(sram_);
+    w5100_.saveState(writer);
+}
+
+bool Spectranet::loadState(StateReader& reader)
+{
+    reader.read(pageA_);
+    reader.read(pageB_);
+    reader.read(progTrapAddr_);
+    reader.read(trapAddrLSBWritten_);
+    reader.read(trapAddrLSB_);
+    reader.read(controlReg_);
+    reader.read(pagedIn_);
+    reader.read(trapEnabled_);
+    reader.read(denyA15_);
+    reader.read(trapInhibit_);
+    reader.read(pagedInViaIO_);
+    reader.read(nmiPageInPending_);
+    reader.read(nmiFlipFlop_);
+    reader.read(flashState_, FlashState::AUTOSELECT);
+    reader.read(flash_);
+    reader.read(sram_);
+    return w5100_.loadState(reader);
+}
+
 void Spectranet::loadROM(const uint8_t* data, uint32_t size)
 {
     if (!data || size == 0) return;
@@ -53,6 +53,10 @@ public:
 
     void reset();
 
+    // Paging and trap registers, flash, SRAM and the W5100
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Load Spectranet ROM into flash (up to 128KB)
     void loadROM(const uint8_t* data, uint32_t size);
 
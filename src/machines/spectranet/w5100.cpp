@@ -48,6 +48,26 @@ void W5100::reset()
     }
 }
 
+void W5100::saveState(StateWriter& writer) const
+{
+    writer.write(commonRegs_);
+    writer.write(socketRegs_);
+    writer.write(txBuffer_);
+    writer.write(rxBuffer_);
+    writer.write(oldRxRd_);
+}
+
+bool W5100::loadState(StateReader& reader)
+{
+    reader.read(commonRegs_);
+    reader.read(socketRegs_);
+    reader.read(txBuffer_);
+    reader.read(rxBuffer_);
+    reader.read(oldRxRd_);
+    commandQueue_.clear();
+    return reader.ok();
+}
+
 uint8_t W5100::read(uint16_t address) const
 {
     // Common registers
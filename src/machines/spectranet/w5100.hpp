@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include "../../core/state_stream.hpp"
 #include <cstdint>
 #include <cstring>
 #include <array>
@@ -115,6 +116,11 @@ public:
 
     void reset();
 
+    // Registers and socket buffers. Commands queued for the host are not
+    // machine state; the host answers them again after a restore.
+    void saveState(StateWriter& writer) const;
+    bool loadState(StateReader& reader);
+
     // Register/buffer access (32KB address space: 0x0000-0x7FFF)
     uint8_t read(uint16_t address) const;
     void write(uint16_t address, uint8_t data);
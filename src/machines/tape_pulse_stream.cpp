@@ -0,0 +1,111 @@
+/*
+ * tape_pulse_stream.cpp - Run-length description of a tape's EAR pulses
+ */
+
+#include "tape_pulse_stream.hpp"
+#include <algorithm>
+
+namespace zxspec {
+
+void TapePulseStream::clear()
+{
+    segments_.clear();
+    blockStarts_.clear();
+    totalPulses_ = 0;
+    lastSegment_ = 0;
+}
+
+void TapePulseStream::addRun(uint32_t length, size_t count)
+{
+    if (count == 0) return;
+
+    // Merge with the previous run when the lengths match
+    if (!segments_.empty()) {
+        Segment& last = segments_.back();
+        if (!last.data && last.length == length) {
+            last.count += count;
+            totalPulses_ += count;
+            return;
+        }
+    }
+    segments_.push_back({ totalPulses_, count, length, 0, 0, false });
+    totalPulses_ += count;
+}
+
+void TapePulseStream::build(const std::vector<TapeBlock>& blocks)
+{
+    clear();
+
+    for (size_t bi = 0; bi < blocks.size(); bi++)
+    {
+        const auto& block = blocks[bi];
+        blockStarts_.push_back(totalPulses_);
+
+        if (block.data.empty()) continue;
+
+        // Pilot tone and sync pulses
+        if (block.hasPilot)
+        {
+            uint16_t pilotCount = block.pilotCount;
+            if (pilotCount == 0)
+            {
+                pilotCount = (block.data[0] < 128) ? 8063 : 3223;
+            }
+            addRun(block.pilotPulse, pilotCount);
+            addRun(block.sync1, 1);
+            addRun(block.sync2, 1);
+        }
+
+        // Data bits, two pulses each
+        int lastBits = std::min<int>(block.usedBitsLastByte, 8);
+        size_t bits = (block.data.size() - 1) * 8 + static_cast<size_t>(lastBits);
+        if (bits > 0)
+        {
+            segments_.push_back({ totalPulses_, bits * 2, block.zeroPulse, block.onePulse,
+                                  static_cast<uint32_t>(bi), true });
+            totalPulses_ += bits * 2;
+        }
+
+        // Pause after block
+        if (block.pauseMs > 0)
+        {
+            addRun(static_cast<uint32_t>(block.pauseMs) * 3500, 1);
+        }
+    }
+
+    blockStarts_.push_back(totalPulses_);
+}
+
+size_t TapePulseStream::findSegment(size_t index) const
+{
+    // Playback walks forwards, so try the current and next segment first
+    size_t s = lastSegment_;
+    if (s < segments_.size() && index >= segments_[s].start)
+    {
+        if (index < segments_[s].start + segments_[s].count) return s;
+        if (s + 1 < segments_.size() && index < segments_[s + 1].start + segments_[s + 1].count)
+        {
+            lastSegment_ = s + 1;
+            return s + 1;
+        }
+    }
+
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), index,
+        [](size_t i, const Segment& seg) { return i < seg.start; });
+    lastSegment_ = static_cast<size_t>(it - segments_.begin()) - 1;
+    return lastSegment_;
+}
+
+uint32_t TapePulseStream::pulseAt(size_t index, const std::vector<TapeBlock>& blocks) const
+{
+    if (index >= totalPulses_) return 0;
+
+    const Segment& seg = segments_[findSegment(index)];
+    if (!seg.data) return seg.length;
+
+    size_t bit = (index - seg.start) / 2;
+    uint8_t byte = blocks[seg.block].data[bit / 8];
+    return (byte & (0x80 >> (bit % 8))) ? seg.oneLength : seg.length;
+}
+
+} // namespace zxspec
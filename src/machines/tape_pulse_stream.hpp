@@ -0,0 +1,62 @@
+/*
+ * tape_pulse_stream.hpp - Run-length description of a tape's EAR pulses
+ *
+ * A loaded tape plays back as a sequence of pulses, each toggling the EAR
+ * level after its length in T-states. Rather than expand every pulse into
+ * memory (8063 identical pilot pulses per header, two per data bit), the
+ * stream holds a handful of segments per block: runs of identical pulses
+ * (pilot tone, sync pulses, pause) and data segments whose pulse lengths
+ * are read from the block's bytes as they are played. Pulses keep the same
+ * global numbering the expanded list had, so tape positions saved by
+ * tapeSnapshotState() are unchanged.
+ */
+
+#pragma once
+
+#include "tape_block.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zxspec {
+
+class TapePulseStream {
+public:
+    // Describe the pulses for blocks. The stream refers back to the blocks'
+    // data, so the same vector must be passed to pulseAt().
+    void build(const std::vector<TapeBlock>& blocks);
+    void clear();
+
+    // Total pulse count
+    size_t size() const { return totalPulses_; }
+    bool empty() const { return totalPulses_ == 0; }
+
+    // Index of the first pulse of each block, with one extra entry for the
+    // end of the tape (so blockStartCount() is the block count plus one)
+    size_t blockStartCount() const { return blockStarts_.size(); }
+    size_t blockStart(size_t block) const { return blockStarts_[block]; }
+
+    // Length in T-states of pulse index. Sequential lookups are constant
+    // time; a jump elsewhere costs a binary search over the segments.
+    uint32_t pulseAt(size_t index, const std::vector<TapeBlock>& blocks) const;
+
+private:
+    struct Segment {
+        size_t   start;         // Index of the segment's first pulse
+        size_t   count;         // Pulses in the segment
+        uint32_t length;        // Run: every pulse. Data: a 0 bit's pulses.
+        uint32_t oneLength;     // Data: a 1 bit's pulses
+        uint32_t block;         // Data: block whose bytes are played, MSB first
+        bool     data;
+    };
+
+    std::vector<Segment> segments_;
+    std::vector<size_t> blockStarts_;
+    size_t totalPulses_ = 0;
+    mutable size_t lastSegment_ = 0;
+
+    void addRun(uint32_t length, size_t count);
+    size_t findSegment(size_t index) const;
+};
+
+} // namespace zxspec
@@ -0,0 +1,358 @@
+/*
+ * time_travel.cpp - Frame history for the time-travel scrubber
+ *
+ * Record layout in the arena:
+ *   state block  header length(1), Z80 header (MAX_HEADER_SIZE), tape,
+ *                FDC, frame counter(4), CPU flags(1), keyboard matrix(8),
+ *                Kempston(1): what a .z80 header leaves out, and the input
+ *                replay starts from
+ *   keyframe     every RAM bank, LZ compressed (lz_codec.hpp)
+ *   delta        runs of bank(1), offset(2), length(2), data; bank 0xFF ends
+ */
+
+#include "time_travel.hpp"
+#include "zx_spectrum.hpp"
+#include "loaders/z80_saver.hpp"
+#include "../core/lz_codec.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace zxspec {
+
+static constexpr uint32_t TAPE_OFFSET = 1 + Z80Saver::MAX_HEADER_SIZE;
+static constexpr uint32_t FDC_OFFSET = TAPE_OFFSET + ZXSpectrum::TAPE_SNAPSHOT_SIZE;
+static constexpr uint32_t EXTRA_OFFSET = FDC_OFFSET + ZXSpectrum::FDC_SNAPSHOT_SIZE;
+static constexpr uint32_t INPUT_OFFSET = EXTRA_OFFSET + 5;
+static constexpr uint32_t STATE_SIZE = INPUT_OFFSET + 9;
+
+static constexpr uint8_t CPU_INT_REQ = 0x01;
+static constexpr uint8_t CPU_HALTED = 0x02;
+static constexpr uint8_t END_OF_RUNS = 0xFF;
+static constexpr uint32_t MAX_RAM_SIZE = 8 * MEM_PAGE_SIZE;
+
+void TimeTravel::configure(size_t arenaBytes, uint32_t maxFrames, uint32_t keyframeInterval)
+{
+    arena_.assign(arenaBytes, 0);
+    records_.assign(std::max<uint32_t>(maxFrames, 1), Record{});
+    shadow_.assign(MAX_RAM_SIZE, 0);
+
+    // Worst case delta: one run covering every bank. Runs are separated
+    // by at least one unchanged 8-byte word, which outweighs a run header.
+    size_t worstRam = std::max<size_t>(MAX_RAM_SIZE + 8 * 5 + 1, LZEncoder::maxEncodedSize(MAX_RAM_SIZE));
+    scratch_.assign(STATE_SIZE + worstRam, 0);
+
+    keyframeInterval_ = std::max<uint32_t>(keyframeInterval, 1);
+    clear();
+}
+
+void TimeTravel::clear()
+{
+    writePos_ = 0;
+    bytesUsed_ = 0;
+    recordHead_ = 0;
+    recordCount_ = 0;
+    shadowValid_ = false;
+    sinceKeyframe_ = 0;
+    currentFrame_ = 0;
+}
+
+bool TimeTravel::capture(ZXSpectrum& machine)
+{
+    if (arena_.empty() || machine.getId() == eZX81) return false;
+    if (machine.memoryRam_.size() > MAX_RAM_SIZE) return false;
+
+    // The W5100's sockets and buffers aren't recorded, so a network session
+    // can't be rewound
+    if (machine.isSpectranetEnabled()) {
+        clear();
+        machine.setInputJournalEnabled(false);
+        return false;
+    }
+
+    InputJournal& journal = machine.getInputJournal();
+    machine.setInputJournalEnabled(true);
+
+    // Nor is the tape: the records' tape positions only fit the tape they
+    // were taken with
+    if (machine.tapeGetChangeCount() != tapeChanges_) {
+        clear();
+        journal.clear();
+        tapeChanges_ = machine.tapeGetChangeCount();
+    }
+
+    // Resuming from a seek: the old future is gone
+    if (recordCount_ > 0 && currentFrame_ < newestFrame()) {
+        truncateAfter(currentFrame_);
+    }
+    journal.commitResume();
+
+    uint32_t frame = machine.getFrameCounter();
+    if (recordCount_ > 0) {
+        if (frame == newestFrame()) return true;
+        if (frame < newestFrame()) {
+            clear();
+            journal.clear();
+        }
+    }
+    currentFrame_ = frame;
+
+    // Deltas need the shadow to hold the newest record's RAM, from the
+    // same machine
+    bool keyframe = recordCount_ == 0
+        || !shadowValid_
+        || shadowFrame_ != newestFrame()
+        || record(recordCount_ - 1).machineId != machine.getId()
+        || sinceKeyframe_ + 1 >= keyframeInterval_;
+
+    uint32_t size = encode(machine, keyframe);
+    size_t offset = 0;
+    if (!makeRoom(size, offset)) {
+        shadowValid_ = false;
+        return false;
+    }
+
+    // Evicting made room by dropping the delta's own group
+    if (!keyframe && recordCount_ == 0) {
+        keyframe = true;
+        size = encode(machine, true);
+        if (!makeRoom(size, offset)) {
+            shadowValid_ = false;
+            return false;
+        }
+    }
+
+    std::memcpy(arena_.data() + offset, scratch_.data(), size);
+    writePos_ = offset + size;
+    bytesUsed_ += size;
+
+    Record& rec = record(recordCount_++);
+    rec.offset = offset;
+    rec.size = size;
+    rec.frame = currentFrame_;
+    rec.journalSequence = journal.nextSequence();
+    rec.machineId = static_cast<uint8_t>(machine.getId());
+    rec.keyframe = keyframe;
+
+    sinceKeyframe_ = keyframe ? 0 : sinceKeyframe_ + 1;
+    shadowFrame_ = currentFrame_;
+    shadowValid_ = true;
+
+    // Input before the oldest record can never be replayed
+    journal.dropBefore(oldestFrame());
+    return true;
+}
+
+uint32_t TimeTravel::encode(ZXSpectrum& machine, bool keyframe)
+{
+    uint8_t* out = scratch_.data();
+    std::memset(out, 0, STATE_SIZE);
+    out[0] = static_cast<uint8_t>(Z80Saver::saveHeader(machine, out + 1, Z80Saver::MAX_HEADER_SIZE));
+    machine.tapeSnapshotState(out + TAPE_OFFSET);
+    machine.fdcSnapshotState(out + FDC_OFFSET);
+
+    // Captures follow a frame end, which leaves the next interrupt pending
+    uint32_t frameCounter = machine.getFrameCounter();
+    for (int i = 0; i < 4; i++) out[EXTRA_OFFSET + i] = (frameCounter >> (i * 8)) & 0xFF;
+    const Z80* cpu = machine.getCPU();
+    out[EXTRA_OFFSET + 4] = (cpu->isInterruptRequesting() ? CPU_INT_REQ : 0)
+                          | (cpu->getHalted() ? CPU_HALTED : 0);
+    std::memcpy(out + INPUT_OFFSET, machine.keyboardMatrix_.data(), 8);
+    out[INPUT_OFFSET + 8] = machine.kempstonJoystick_;
+
+    const MemoryPages& ram = machine.memoryRam_;
+    uint32_t ramSize = ram.size();
+    uint32_t dirty = machine.takeDirtyRamBanks();
+    uint32_t pos = STATE_SIZE;
+
+    if (keyframe) {
+        // RAM is held in separate pages; gather it into the shadow and
+        // compress from there
+        ram.copyTo(shadow_.data());
+        for (uint32_t at = 0; at < ramSize; at += LZEncoder::BLOCK_SIZE) {
+            uint32_t size = std::min(ramSize - at, LZEncoder::BLOCK_SIZE);
+            pos += static_cast<uint32_t>(LZEncoder::encodeBlock(shadow_.data() + at, size, out + pos));
+        }
+        return pos;
+    }
+
+    for (uint32_t bank = 0; bank < ramSize / MEM_PAGE_SIZE; bank++) {
+        if (!(dirty & (1u << bank))) continue;
+
+        const uint8_t* cur = ram.page(bank);
+        uint8_t* old = shadow_.data() + bank * MEM_PAGE_SIZE;
+        uint32_t i = 0;
+        while (i < MEM_PAGE_SIZE) {
+            if (std::memcmp(cur + i, old + i, 8) == 0) {
+                i += 8;
+                continue;
+            }
+            uint32_t start = i;
+            do {
+                i += 8;
+            } while (i < MEM_PAGE_SIZE && std::memcmp(cur + i, old + i, 8) != 0);
+
+            uint32_t len = i - start;
+            out[pos++] = static_cast<uint8_t>(bank);
+            out[pos++] = start & 0xFF;
+            out[pos++] = (start >> 8) & 0xFF;
+            out[pos++] = len & 0xFF;
+            out[pos++] = (len >> 8) & 0xFF;
+            std::memcpy(out + pos, cur + start, len);
+            std::memcpy(old + start, cur + start, len);
+            pos += len;
+        }
+    }
+    out[pos++] = END_OF_RUNS;
+    return pos;
+}
+
+bool TimeTravel::makeRoom(uint32_t size, size_t& offset)
+{
+    if (size > arena_.size()) return false;
+
+    for (;;) {
+        if (recordCount_ == 0) {
+            offset = 0;
+            return true;
+        }
+        if (recordCount_ < records_.size()) {
+            // Live data runs from the oldest record round to writePos_
+            size_t front = record(0).offset;
+            if (writePos_ > front) {
+                if (arena_.size() - writePos_ >= size) { offset = writePos_; return true; }
+                if (front >= size) { offset = 0; return true; }
+            } else if (front - writePos_ >= size) {
+                offset = writePos_;
+                return true;
+            }
+        }
+        dropOldestGroup();
+    }
+}
+
+void TimeTravel::dropOldestGroup()
+{
+    do {
+        bytesUsed_ -= record(0).size;
+        recordHead_ = (recordHead_ + 1) % records_.size();
+        recordCount_--;
+    } while (recordCount_ > 0 && !record(0).keyframe);
+}
+
+void TimeTravel::truncateAfter(uint32_t frame)
+{
+    while (recordCount_ > 0 && record(recordCount_ - 1).frame > frame) {
+        bytesUsed_ -= record(recordCount_ - 1).size;
+        recordCount_--;
+    }
+
+    if (recordCount_ == 0) {
+        writePos_ = 0;
+        sinceKeyframe_ = 0;
+        return;
+    }
+
+    const Record& back = record(recordCount_ - 1);
+    writePos_ = back.offset + back.size;
+
+    sinceKeyframe_ = 0;
+    for (uint32_t i = recordCount_ - 1; !record(i).keyframe; i--) {
+        sinceKeyframe_++;
+    }
+}
+
+uint32_t TimeTravel::frameAt(uint32_t index) const
+{
+    return index < recordCount_ ? record(index).frame : 0;
+}
+
+int TimeTravel::findRecord(uint32_t frame) const
+{
+    // Last record at or before frame
+    uint32_t lo = 0;
+    uint32_t hi = recordCount_;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (record(mid).frame <= frame) lo = mid + 1;
+        else hi = mid;
+    }
+    return static_cast<int>(lo) - 1;
+}
+
+bool TimeTravel::applyRam(const Record& rec, size_t ramSize)
+{
+    const uint8_t* in = arena_.data() + rec.offset + STATE_SIZE;
+
+    if (rec.keyframe) {
+        return lzDecode(in, rec.size - STATE_SIZE, shadow_.data(), ramSize);
+    }
+
+    while (*in != END_OF_RUNS) {
+        uint32_t bank = in[0];
+        uint32_t start = in[1] | (in[2] << 8);
+        uint32_t len = in[3] | (in[4] << 8);
+        std::memcpy(shadow_.data() + bank * MEM_PAGE_SIZE + start, in + 5, len);
+        in += 5 + len;
+    }
+    return true;
+}
+
+bool TimeTravel::seekToFrame(ZXSpectrum& machine, uint32_t frame)
+{
+    if (recordCount_ == 0 || frame > newestFrame()) return false;
+    if (machine.isSpectranetEnabled() || machine.tapeGetChangeCount() != tapeChanges_) return false;
+    int index = findRecord(frame);
+    if (index < 0) return false;
+
+    const Record& target = record(static_cast<uint32_t>(index));
+    if (target.machineId != machine.getId()) return false;
+
+    // Rebuild RAM in the shadow from the group's keyframe forwards
+    uint32_t first = static_cast<uint32_t>(index);
+    while (!record(first).keyframe) first--;
+    size_t ramSize = machine.memoryRam_.size();
+    const Record& key = record(first);
+    if (lzDecodedSize(arena_.data() + key.offset + STATE_SIZE, key.size - STATE_SIZE) != ramSize) return false;
+    for (uint32_t i = first; i <= static_cast<uint32_t>(index); i++) {
+        if (!applyRam(record(i), ramSize)) {
+            shadowValid_ = false;
+            return false;
+        }
+    }
+
+    bool paused = machine.isPaused();
+    const uint8_t* state = arena_.data() + target.offset;
+    machine.loadZ80(state + 1, state[0]);
+    machine.tapeRestoreState(state + TAPE_OFFSET);
+    machine.fdcRestoreState(state + FDC_OFFSET);
+
+    uint32_t frameCounter = 0;
+    for (int i = 0; i < 4; i++) frameCounter |= static_cast<uint32_t>(state[EXTRA_OFFSET + i]) << (i * 8);
+    machine.setFrameCounter(frameCounter);
+    Z80* cpu = machine.getCPU();
+    if (state[EXTRA_OFFSET + 4] & CPU_INT_REQ) cpu->signalInterrupt();
+    cpu->setHalted((state[EXTRA_OFFSET + 4] & CPU_HALTED) != 0);
+    std::memcpy(machine.keyboardMatrix_.data(), state + INPUT_OFFSET, 8);
+    machine.kempstonJoystick_ = state[INPUT_OFFSET + 8];
+    for (uint32_t bank = 0; bank < machine.memoryRam_.pageCount(); bank++) {
+        std::memcpy(machine.memoryRam_.writable(bank), shadow_.data() + bank * MEM_PAGE_SIZE, MEM_PAGE_SIZE);
+    }
+    machine.remapMemory();
+    machine.takeDirtyRamBanks();
+    machine.display_.markScreenChanged();
+
+    // The shadow stays at the record; the banks the replay writes are marked
+    // dirty again, ready for the next delta
+    shadowFrame_ = target.frame;
+    shadowValid_ = true;
+    if (target.frame < frame) {
+        machine.replayInputTo(frame, target.journalSequence);
+    }
+    machine.setPaused(paused);
+
+    currentFrame_ = machine.getFrameCounter();
+    machine.getInputJournal().resumeAt(currentFrame_);
+    return true;
+}
+
+} // namespace zxspec
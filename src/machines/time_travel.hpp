@@ -0,0 +1,107 @@
+/*
+ * time_travel.hpp - Frame history for the time-travel scrubber
+ *
+ * Records the machine's state at the end of each frame into a fixed arena
+ * allocated by configure(), so capturing never allocates. Records come in
+ * groups: a keyframe holding all of RAM, LZ compressed, followed by deltas
+ * holding only the bytes that changed since the previous record. Only the
+ * 16K banks the variants marked dirty on write are compared, and within
+ * those only the changed runs are stored, so a typical frame costs a few
+ * KB instead of a full snapshot. Every record also carries the Z80
+ * snapshot header (CPU, paging, AY, T-states) and the tape and disk
+ * controller state.
+ *
+ * Records are numbered by the machine's frame counter and need not be
+ * taken every frame. They hold the tape position but not the tape itself,
+ * and nothing of the Spectranet, so changing the tape discards the history
+ * and nothing is recorded while the Spectranet is enabled. Capturing
+ * switches on the machine's input journal, so a seek to a frame between
+ * records restores the record before it and replays the journalled input
+ * up to the frame (ZXSpectrum::replayInputTo).
+ *
+ * When the arena or the record slots run out, the oldest group is dropped.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zxspec {
+
+class ZXSpectrum;
+
+class TimeTravel {
+public:
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 50;
+
+    // Allocate the arena and record slots, discarding any history
+    void configure(size_t arenaBytes, uint32_t maxFrames,
+                   uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    void clear();
+
+    // Record the machine's state at its current frame. After a seek, the
+    // history beyond the seeked frame is dropped first; a frame counter that
+    // went backwards (reset or snapshot load) or a changed tape starts a new
+    // history. Returns false if nothing was recorded (not configured, a ZX81,
+    // the Spectranet enabled, or a keyframe bigger than the arena).
+    bool capture(ZXSpectrum& machine);
+
+    // Restore the machine to any frame from the oldest record to the newest:
+    // the nearest record at or before it (its keyframe's RAM plus each delta
+    // up to it, then its CPU, tape and disk state), replaying input from
+    // there to the frame. The machine's paused state is kept. Fails if the
+    // tape changed since the newest record or the Spectranet is enabled.
+    bool seekToFrame(ZXSpectrum& machine, uint32_t frame);
+
+    // Drop every record after frame
+    void truncateAfter(uint32_t frame);
+
+    uint32_t count() const { return recordCount_; }
+    uint32_t frameAt(uint32_t index) const;
+    uint32_t oldestFrame() const { return recordCount_ ? record(0).frame : 0; }
+    uint32_t newestFrame() const { return recordCount_ ? record(recordCount_ - 1).frame : 0; }
+    size_t bytesUsed() const { return bytesUsed_; }
+    size_t arenaSize() const { return arena_.size(); }
+
+private:
+    struct Record {
+        size_t   offset;        // Start in arena_
+        uint32_t size;
+        uint32_t frame;
+        uint64_t journalSequence;   // First input event after the record
+        uint8_t  machineId;
+        bool     keyframe;
+    };
+
+    std::vector<uint8_t> arena_;
+    size_t writePos_ = 0;
+    size_t bytesUsed_ = 0;
+
+    std::vector<Record> records_;   // Ring of record slots, oldest at recordHead_
+    uint32_t recordHead_ = 0;
+    uint32_t recordCount_ = 0;
+
+    // RAM as of shadowFrame_; deltas are taken against it
+    std::vector<uint8_t> shadow_;
+    uint32_t shadowFrame_ = 0;
+    bool shadowValid_ = false;
+
+    std::vector<uint8_t> scratch_;
+    uint32_t keyframeInterval_ = DEFAULT_KEYFRAME_INTERVAL;
+    uint32_t sinceKeyframe_ = 0;
+    uint32_t currentFrame_ = 0;     // Frame last captured or seeked to
+    uint32_t tapeChanges_ = 0;      // Machine's tape change count when recorded
+
+    Record& record(uint32_t index) { return records_[(recordHead_ + index) % records_.size()]; }
+    const Record& record(uint32_t index) const { return records_[(recordHead_ + index) % records_.size()]; }
+
+    uint32_t encode(ZXSpectrum& machine, bool keyframe);
+    bool applyRam(const Record& rec, size_t ramSize);
+    bool makeRoom(uint32_t size, size_t& offset);
+    void dropOldestGroup();
+    int findRecord(uint32_t frame) const;
+};
+
+} // namespace zxspec
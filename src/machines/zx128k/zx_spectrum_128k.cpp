@@ -34,15 +34,16 @@ void ZXSpectrum128::init()
 
     // Base class allocates memory and wires up Z80
     baseInit();
+    z80_->bindBus<CpuBus<ZXSpectrum128>>(this);
 
     // Load both ROMs (ROM 0 = 128K editor, ROM 1 = 48K BASIC)
     if (roms::ROM_128K_0_SIZE > 0 && roms::ROM_128K_0_SIZE <= MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_128K_0, roms::ROM_128K_0_SIZE);
+        std::memcpy(memoryRom_.writable(0), roms::ROM_128K_0, roms::ROM_128K_0_SIZE);
     }
     if (roms::ROM_128K_1_SIZE > 0 && roms::ROM_128K_1_SIZE <= MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data() + MEM_PAGE_SIZE, roms::ROM_128K_1, roms::ROM_128K_1_SIZE);
+        std::memcpy(memoryRom_.writable(1), roms::ROM_128K_1, roms::ROM_128K_1_SIZE);
     }
 
     // Load Spectranet ROM into flash if available
@@ -89,21 +90,37 @@ void ZXSpectrum128::updatePaging()
 {
     // ROM select: bit 4 of paging register (0 = ROM 0, 1 = ROM 1)
     uint8_t romBank = (pagingRegister_ & 0x10) ? 1 : 0;
-    pageRead_[0] = memoryRom_.data() + (romBank * MEM_PAGE_SIZE);
+    pageRead_[0] = memoryRom_.page(romBank);
     pageWrite_[0] = nullptr;  // ROM is read-only
+    pageBank_[0] = -1;
 
-    // Slot 1: always RAM bank 5
-    pageRead_[1] = &memoryRam_[5 * MEM_PAGE_SIZE];
-    pageWrite_[1] = &memoryRam_[5 * MEM_PAGE_SIZE];
+    // Slot 1: always RAM bank 5; slot 2: always RAM bank 2; slot 3: RAM
+    // bank selected by bits 0-2
+    mapRamBank(1, 5);
+    mapRamBank(2, 2);
+    mapRamBank(3, pagingRegister_ & 0x07);
+}
 
-    // Slot 2: always RAM bank 2
-    pageRead_[2] = &memoryRam_[2 * MEM_PAGE_SIZE];
-    pageWrite_[2] = &memoryRam_[2 * MEM_PAGE_SIZE];
+void ZXSpectrum128::mapRamBank(int slot, uint8_t bank)
+{
+    pageRead_[slot] = memoryRam_.page(bank);
+    pageWrite_[slot] = ramWritePage(bank);
+    pageBank_[slot] = static_cast<int8_t>(bank);
+}
 
-    // Slot 3: RAM bank selected by bits 0-2
-    uint8_t ramBank = pagingRegister_ & 0x07;
-    pageRead_[3] = &memoryRam_[ramBank * MEM_PAGE_SIZE];
-    pageWrite_[3] = &memoryRam_[ramBank * MEM_PAGE_SIZE];
+// A null write page is ROM, or a RAM bank shared with a fork: copy the
+// bank and point the tables at the copy
+bool ZXSpectrum128::copyOnWrite(int slot)
+{
+    if (pageBank_[slot] < 0) return false;
+    memoryRam_.writable(pageBank_[slot]);
+    updatePaging();
+    return true;
+}
+
+std::unique_ptr<ZXSpectrum> ZXSpectrum128::newInstance() const
+{
+    return std::make_unique<ZXSpectrum128>();
 }
 
 void ZXSpectrum128::setPagingRegister(uint8_t value)
@@ -117,7 +134,9 @@ void ZXSpectrum128::writeRamBank(uint8_t bank, uint16_t offset, uint8_t data)
 {
     if (bank < 8 && offset < MEM_PAGE_SIZE)
     {
-        memoryRam_[bank * MEM_PAGE_SIZE + offset] = data;
+        markRamDirty(bank);
+        ramBankForWrite(bank)[offset] = data;
+        if (memoryRam_.page(bank) == screenMemory()) display_.markScreenWrite(offset);
     }
 }
 
@@ -138,13 +157,13 @@ uint8_t* ZXSpectrum128::getScreenMemory()
 {
     // Bit 3 of paging register selects screen bank: 0 = bank 5, 1 = bank 7
     uint8_t screenBank = (pagingRegister_ & 0x08) ? 7 : 5;
-    return &memoryRam_[screenBank * MEM_PAGE_SIZE];
+    return ramBankForWrite(screenBank);
 }
 
 const uint8_t* ZXSpectrum128::getScreenMemory() const
 {
     uint8_t screenBank = (pagingRegister_ & 0x08) ? 7 : 5;
-    return &memoryRam_[screenBank * MEM_PAGE_SIZE];
+    return memoryRam_.page(screenBank);
 }
 
 // ============================================================================
@@ -173,28 +192,39 @@ void ZXSpectrum128::coreMemoryWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (!pageWrite_[slot]) return;  // ROM protection
+    if (!pageWrite_[slot] && !copyOnWrite(slot)) return;  // ROM protection
+    markRamDirty(pageBank_[slot]);
 
-    // Slot 1 (bank 5) always gets display catch-up unconditionally,
-    // matching SpectREMCPP behaviour. This is simpler and correct because
-    // bank 5 is the default screen and writes anywhere in it could affect
-    // the display (pixel data or attributes).
-    if (slot == 1 && !tapeAccelerating_)
+    // Catch up the display before a write to the displayed screen bank
+    // (bank 5 through slot 1, or bank 7 through slot 3), but only when the
+    // byte lands in the display file on a cell the beam has passed and the
+    // display has not drawn yet. Code and data in bank 5 above 0x5AFF, and
+    // cells already drawn or still ahead of the beam, need no catch-up.
+    // Either way the display notes the write so the lines showing it are
+    // compared.
+    if (pageRead_[slot] == screenMemory())
     {
-        display_.updateWithTs(
-            static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.paperDrawingOffset),
-            getScreenMemory(), borderColor_, frameCounter_);
+        uint32_t targetTs = z80_->getTStates() + machineInfo_.paperDrawingOffset;
+        if (!tapeAccelerating_ && display_.isCellPending(address & 0x3FFF, targetTs))
+        {
+            display_.updateWithTs(
+                static_cast<int32_t>(targetTs - display_.getCurrentDisplayTs()),
+                screenMemory(), borderColor_, frameCounter_);
+        }
+        display_.markScreenWrite(address & 0x3FFF);
     }
 
-    // Capture old value before writing for UDG screen patching
-    uint8_t oldValue = pageWrite_[slot][address & 0x3FFF];
-    pageWrite_[slot][address & 0x3FFF] = data;
-
-    // Auto-patch screen memory when UDG data is modified
-    if (!tapeAccelerating_)
+    // Auto-patch screen memory when UDG data is modified, only while the
+    // UDG editor is open
+    if (getUdgScreenPatching() && !tapeAccelerating_)
     {
+        uint8_t oldValue = pageWrite_[slot][address & 0x3FFF];
+        pageWrite_[slot][address & 0x3FFF] = data;
         patchScreenForUdgWrite(address, oldValue, data);
+        return;
     }
+
+    pageWrite_[slot][address & 0x3FFF] = data;
 }
 
 // ============================================================================
@@ -221,9 +251,11 @@ void ZXSpectrum128::coreDebugWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (pageWrite_[slot])
+    if (pageWrite_[slot] || copyOnWrite(slot))
     {
+        markRamDirty(pageBank_[slot]);
         pageWrite_[slot][address & 0x3FFF] = data;
+        if (pageRead_[slot] == screenMemory()) display_.markScreenWrite(address & 0x3FFF);
     }
 }
 
@@ -328,7 +360,7 @@ uint8_t ZXSpectrum128::coreIORead(uint16_t address)
             {
                 display_.updateWithTs(
                     static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                    getScreenMemory(), borderColor_, frameCounter_);
+                    screenMemory(), borderColor_, frameCounter_);
             }
             pagingRegister_ = floatingBusData;
             if (floatingBusData & 0x20) pagingDisabled_ = true;
@@ -397,7 +429,7 @@ void ZXSpectrum128::coreIOWrite(uint16_t address, uint8_t data)
         {
             display_.updateWithTs(
                 static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
         pagingRegister_ = data;
         if (data & 0x20) pagingDisabled_ = true;
@@ -413,6 +445,7 @@ void ZXSpectrum128::coreIOWrite(uint16_t address, uint8_t data)
     // Data write: port 0xBFFD -- (address & 0xC002) == 0x8000
     if ((address & 0xC002) == 0x8000)
     {
+        syncPeripherals();
         ay_.writeData(data);
     }
 
@@ -423,8 +456,9 @@ void ZXSpectrum128::coreIOWrite(uint16_t address, uint8_t data)
         {
             display_.updateWithTs(
                 static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
+        syncPeripherals();
         audio_.setEarBit((data >> 4) & 1);
         audio_.setMicBit((data >> 3) & 1);
         if (tapeRecording_) {
@@ -73,12 +73,20 @@ public:
         return (pagingRegister_ & 0x10) ? 0x1303 : 0x0322;
     }
 
+protected:
+    std::unique_ptr<ZXSpectrum> newInstance() const override;
+    void remapMemory() override { updatePaging(); }
+
 private:
     void updatePaging();
+    void mapRamBank(int slot, uint8_t bank);
+    bool copyOnWrite(int slot);
 
-    // Page pointers for fast address translation
-    uint8_t* pageRead_[4]{};
+    // Page pointers for fast address translation, and the RAM bank behind
+    // each slot (-1 for ROM)
+    const uint8_t* pageRead_[4]{};
     uint8_t* pageWrite_[4]{};
+    int8_t pageBank_[4]{};
 
     // 128K paging state
     uint8_t pagingRegister_ = 0;    // Last value written to port 0x7FFD
@@ -34,11 +34,12 @@ void ZXSpectrum48::init()
 
     // Base class allocates memory and wires up Z80
     baseInit();
+    z80_->bindBus<CpuBus<ZXSpectrum48>>(this);
 
     // Load ROM
     if (roms::ROM_48K_SIZE > 0 && roms::ROM_48K_SIZE <= memoryRom_.size())
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_48K, roms::ROM_48K_SIZE);
+        std::memcpy(memoryRom_.writable(0), roms::ROM_48K, roms::ROM_48K_SIZE);
     }
 
     // Load Spectranet ROM into flash if available
@@ -100,16 +101,32 @@ void ZXSpectrum48::reloadCurrahSpeechROM()
 
 void ZXSpectrum48::setupPaging()
 {
-    // 48K layout: ROM at page 0, RAM at pages 1/2/3
-    pageRead_[0] = memoryRom_.data();
-    pageRead_[1] = &memoryRam_[0 * MEM_PAGE_SIZE];
-    pageRead_[2] = &memoryRam_[1 * MEM_PAGE_SIZE];
-    pageRead_[3] = &memoryRam_[2 * MEM_PAGE_SIZE];
-
+    // 48K layout: ROM at page 0, RAM banks 0-2 at pages 1/2/3
+    pageRead_[0] = memoryRom_.page(0);
     pageWrite_[0] = nullptr;  // ROM is read-only
-    pageWrite_[1] = &memoryRam_[0 * MEM_PAGE_SIZE];
-    pageWrite_[2] = &memoryRam_[1 * MEM_PAGE_SIZE];
-    pageWrite_[3] = &memoryRam_[2 * MEM_PAGE_SIZE];
+    pageBank_[0] = -1;
+
+    for (int slot = 1; slot < 4; slot++)
+    {
+        pageRead_[slot] = memoryRam_.page(slot - 1);
+        pageWrite_[slot] = ramWritePage(slot - 1);
+        pageBank_[slot] = static_cast<int8_t>(slot - 1);
+    }
+}
+
+// A null write page is ROM, or a RAM bank shared with a fork: copy the
+// bank and point the tables at the copy
+bool ZXSpectrum48::copyOnWrite(int slot)
+{
+    if (pageBank_[slot] < 0) return false;
+    memoryRam_.writable(pageBank_[slot]);
+    setupPaging();
+    return true;
+}
+
+std::unique_ptr<ZXSpectrum> ZXSpectrum48::newInstance() const
+{
+    return std::make_unique<ZXSpectrum48>();
 }
 
 // ============================================================================
@@ -128,12 +145,12 @@ uint8_t ZXSpectrum48::readRamBank(uint8_t bank, uint16_t offset) const
 
 uint8_t* ZXSpectrum48::getScreenMemory()
 {
-    return &memoryRam_[0];
+    return ramBankForWrite(0);
 }
 
 const uint8_t* ZXSpectrum48::getScreenMemory() const
 {
-    return &memoryRam_[0];
+    return memoryRam_.page(0);
 }
 
 // ============================================================================
@@ -146,6 +163,8 @@ uint8_t ZXSpectrum48::coreMemoryRead(uint16_t address)
 
     // Currah uSpeech ROM overlay (0x0000-0x1FFF when paged in)
     if (slot == 0 && currahSpeechEnabled_ && currahSpeech_.isPagedIn() && address < 0x2000) {
+        // 0x1000-0x1FFF reads the SP0256 busy flag
+        if (address >= 0x1000) syncPeripherals();
         return currahSpeech_.memoryRead(address);
     }
 
@@ -170,6 +189,7 @@ void ZXSpectrum48::coreMemoryWrite(uint16_t address, uint8_t data)
     if (slot == 0 && currahSpeechEnabled_ && currahSpeech_.isPagedIn()) {
         if ((address >= 0x1000 && address < 0x2000) ||
             (address >= 0x3000 && address < 0x4000)) {
+            syncPeripherals();
             currahSpeech_.memoryWrite(address, data);
             return;
         }
@@ -187,33 +207,39 @@ void ZXSpectrum48::coreMemoryWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (!pageWrite_[slot]) return;  // ROM protection
+    if (!pageWrite_[slot] && !copyOnWrite(slot)) return;  // ROM protection
+    markRamDirty(pageBank_[slot]);
 
     // If the CPU is writing to the screen memory area (bitmap: 0x4000-0x57FF,
     // attributes: 0x5800-0x5AFF — total 6912 bytes), catch up the display
     // rendering to the current T-state before the write lands. This ensures
     // the old pixel data is rendered for all scanlines up to this point, and
-    // the new data only takes effect from here forward.
-    if (!tapeAccelerating_)
+    // the new data only takes effect from here forward. Writes whose cells
+    // are already drawn, or not reached yet, need no catch-up. Either way the
+    // display notes the write so the lines showing it are compared.
+    if (slot == 1)
     {
-        uint16_t offset = address & 0x3FFF;
-        if (slot == 1 && offset < 6912)
+        uint32_t targetTs = z80_->getTStates() + machineInfo_.paperDrawingOffset;
+        if (!tapeAccelerating_ && display_.isCellPending(address & 0x3FFF, targetTs))
         {
             display_.updateWithTs(
-                static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.paperDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                static_cast<int32_t>(targetTs - display_.getCurrentDisplayTs()),
+                screenMemory(), borderColor_, frameCounter_);
         }
+        display_.markScreenWrite(address & 0x3FFF);
     }
 
-    // Capture old value before writing for UDG screen patching
-    uint8_t oldValue = pageWrite_[slot][address & 0x3FFF];
-    pageWrite_[slot][address & 0x3FFF] = data;
-
-    // Auto-patch screen memory when UDG data is modified
-    if (!tapeAccelerating_)
+    // Auto-patch screen memory when UDG data is modified, only while the
+    // UDG editor is open
+    if (getUdgScreenPatching() && !tapeAccelerating_)
     {
+        uint8_t oldValue = pageWrite_[slot][address & 0x3FFF];
+        pageWrite_[slot][address & 0x3FFF] = data;
         patchScreenForUdgWrite(address, oldValue, data);
+        return;
     }
+
+    pageWrite_[slot][address & 0x3FFF] = data;
 }
 
 // ============================================================================
@@ -249,9 +275,11 @@ void ZXSpectrum48::coreDebugWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (pageWrite_[slot])
+    if (pageWrite_[slot] || copyOnWrite(slot))
     {
+        markRamDirty(pageBank_[slot]);
         pageWrite_[slot][address & 0x3FFF] = data;
+        if (slot == 1) display_.markScreenWrite(address & 0x3FFF);
     }
 }
 
@@ -395,6 +423,7 @@ void ZXSpectrum48::coreIOWrite(uint16_t address, uint8_t data)
         }
         // Data write: port 0xBFFD — (address & 0xC002) == 0x8000
         if ((address & 0xC002) == 0x8000) {
+            syncPeripherals();
             ay_.writeData(data);
         }
     }
@@ -406,8 +435,9 @@ void ZXSpectrum48::coreIOWrite(uint16_t address, uint8_t data)
         {
             display_.updateWithTs(
                 static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
+        syncPeripherals();
         audio_.setEarBit((data >> 4) & 1);
         audio_.setMicBit((data >> 3) & 1);
         if (tapeRecording_) {
@@ -55,12 +55,19 @@ public:
     uint8_t* getScreenMemory() override;
     const uint8_t* getScreenMemory() const override;
 
+protected:
+    std::unique_ptr<ZXSpectrum> newInstance() const override;
+    void remapMemory() override { setupPaging(); }
+
 private:
     void setupPaging();
+    bool copyOnWrite(int slot);
 
-    // Page pointers for fast address translation
-    uint8_t* pageRead_[4]{};
+    // Page pointers for fast address translation, and the RAM bank behind
+    // each slot (-1 for ROM)
+    const uint8_t* pageRead_[4]{};
     uint8_t* pageWrite_[4]{};
+    int8_t pageBank_[4]{};
 };
 
 } // namespace zxspec::zx48k
@@ -43,31 +43,20 @@ void ZX81::init()
     // Re-setup audio with correct ZX81 clock (3.25 MHz, not 3.5 MHz)
     double fps = ZX81_CPU_CLOCK_HZ / static_cast<double>(machineInfo_.tsPerFrame);
     audio_.setup(AUDIO_SAMPLE_RATE, fps, machineInfo_.tsPerFrame);
+    frameRate_ = fps;
 
     // Load 8KB ROM
     if (roms::ROM_ZX81_SIZE > 0 && roms::ROM_ZX81_SIZE <= memoryRom_.size())
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_ZX81, roms::ROM_ZX81_SIZE);
+        std::memcpy(memoryRom_.writable(0), roms::ROM_ZX81, roms::ROM_ZX81_SIZE);
     }
 
-    // Register ZX81 opcode fetch callback for character generation.
-    // When the CPU fetches an opcode from an address with A15 high
-    // (display file area), the ULA intercepts: bytes with bit 6 low
-    // are display characters (replaced with NOP), bytes with bit 6
-    // high are real opcodes (e.g., HALT = 0x76).
-    z80_->registerOpcodeFetchCallback(
-        [](uint16_t address, void* param) -> uint8_t {
-            auto* self = static_cast<ZX81*>(param);
-            uint8_t byte = self->coreMemoryRead(address);
-            if (address & 0x8000) {
-                // Display file area: bit 6 low = character (return NOP)
-                if ((byte & 0x40) == 0) {
-                    return 0x00;  // NOP
-                }
-            }
-            return byte;
-        }
-    );
+    // Bind the ZX81 bus, which substitutes NOPs for display file
+    // characters on opcode fetch (see ZX81Bus)
+    z80_->bindBus<ZX81Bus>(this);
+
+    // The Spectrum edge-loop skip knows nothing of the NMI generator
+    tapeEdgeSkip_ = false;
 
     // Clear framebuffer to white (ZX81 default background)
     for (uint32_t i = 0; i < FRAMEBUFFER_SIZE; i += 4)
@@ -192,7 +181,8 @@ void ZX81::runFrame()
 
     z80_->resetTStates(machineInfo_.tsPerFrame);
 
-    audio_.frameEnd();
+    if (turboSkipDisplay_) audio_.skipFrame();
+    else audio_.frameEnd();
 
     if (muteFrames_ > 0)
     {
@@ -201,7 +191,7 @@ void ZX81::runFrame()
     }
 
     // Render the ZX81 character display
-    renderZX81Display();
+    if (!turboSkipDisplay_) renderZX81Display();
     frameCounter_++;
 }
 
@@ -216,6 +206,8 @@ void ZX81::renderDisplay()
 
 void ZX81::renderZX81Display()
 {
+    ZXSPEC_PROFILE_SCOPE(Display);
+
     // Fill entire framebuffer with white (border + background)
     for (uint32_t i = 0; i < FRAMEBUFFER_SIZE; i += 4)
     {
@@ -369,12 +361,17 @@ int ZX81::getSignalBufferSize() const
 
 uint8_t* ZX81::getScreenMemory()
 {
-    return memoryRam_.data();
+    return memoryRam_.writable(0);
 }
 
 const uint8_t* ZX81::getScreenMemory() const
 {
-    return memoryRam_.data();
+    return memoryRam_.page(0);
+}
+
+std::unique_ptr<ZXSpectrum> ZX81::newInstance() const
+{
+    return std::make_unique<ZX81>();
 }
 
 // ============================================================================
@@ -393,12 +390,12 @@ void ZX81::coreMemoryWrite(uint16_t address, uint8_t data)
     {
         uint16_t offset = address - 0x4000;
         if (offset < memoryRam_.size())
-            memoryRam_[offset] = data;
+            memoryRam_.writable(0)[offset] = data;
     }
     else if (address >= 0xC000)
     {
         uint16_t offset = (address - 0xC000) % static_cast<uint16_t>(memoryRam_.size());
-        memoryRam_[offset] = data;
+        memoryRam_.writable(0)[offset] = data;
     }
     // Writes to ROM area (0x0000-0x3FFF, 0x8000-0xBFFF) are ignored
 }
@@ -418,12 +415,12 @@ void ZX81::coreDebugWrite(uint16_t address, uint8_t data)
     {
         uint16_t offset = address - 0x4000;
         if (offset < memoryRam_.size())
-            memoryRam_[offset] = data;
+            memoryRam_.writable(0)[offset] = data;
     }
     else if (address >= 0xC000)
     {
         uint16_t offset = (address - 0xC000) % static_cast<uint16_t>(memoryRam_.size());
-        memoryRam_[offset] = data;
+        memoryRam_.writable(0)[offset] = data;
     }
 }
 
@@ -577,29 +574,30 @@ void ZX81::loadP(const uint8_t* data, uint32_t size)
     // to the end of the program/variables area.
     // Load it directly into RAM without running the ROM init loop,
     // which would require proper NMI/INT generation to complete.
+    uint8_t* ram = memoryRam_.writable(0);
     uint16_t loadAddr = 0x4009;
     for (uint32_t i = 0; i < size && (loadAddr + i) < 0x8000; i++)
     {
-        memoryRam_[loadAddr - 0x4000 + i] = data[i];
+        ram[loadAddr - 0x4000 + i] = data[i];
     }
 
     // Set up system variables 0x4000-0x4008 (not included in .P file)
-    memoryRam_[0x0000] = 0xFF;  // ERR_NR: no error (-1)
-    memoryRam_[0x0001] = 0x80;  // FLAGS: bit 7 set (refresh display)
-    memoryRam_[0x0004] = 0xFF;  // RAMTOP low  (0x7FFF for 16K)
-    memoryRam_[0x0005] = 0x7F;  // RAMTOP high
-    memoryRam_[0x0006] = 0x02;  // MODE: SLOW
-    memoryRam_[0x0007] = 0x00;  // PPC low
-    memoryRam_[0x0008] = 0x00;  // PPC high
+    ram[0x0000] = 0xFF;  // ERR_NR: no error (-1)
+    ram[0x0001] = 0x80;  // FLAGS: bit 7 set (refresh display)
+    ram[0x0004] = 0xFF;  // RAMTOP low  (0x7FFF for 16K)
+    ram[0x0005] = 0x7F;  // RAMTOP high
+    ram[0x0006] = 0x02;  // MODE: SLOW
+    ram[0x0007] = 0x00;  // PPC low
+    ram[0x0008] = 0x00;  // PPC high
 
     // ERR_SP: the ROM pushes the error handler return address (0x1BB)
     // at RAMTOP-1/RAMTOP-2, then sets ERR_SP to point there.
     uint16_t ramtop = 0x7FFF;
-    memoryRam_[ramtop - 0x4000]     = 0x07;  // Error return address high (0x0207)
-    memoryRam_[ramtop - 0x4000 - 1] = 0x02;  // Error return address low
+    ram[ramtop - 0x4000]     = 0x07;  // Error return address high (0x0207)
+    ram[ramtop - 0x4000 - 1] = 0x02;  // Error return address low
     uint16_t errSp = ramtop - 2;
-    memoryRam_[0x0002] = errSp & 0xFF;        // ERR_SP low
-    memoryRam_[0x0003] = (errSp >> 8) & 0xFF; // ERR_SP high
+    ram[0x0002] = errSp & 0xFF;        // ERR_SP low
+    ram[0x0003] = (errSp >> 8) & 0xFF; // ERR_SP high
 
     // Set up CPU registers to match post-initialization state
     z80_->setRegister(Z80::ByteReg::I, 0x1E);      // Character set at 0x1E00
@@ -40,6 +40,11 @@ public:
     const uint8_t* getSignalBuffer() const override;
     int getSignalBufferSize() const override;
 
+    // The ZX81 draws through its own framebuffer, not display_, so it has
+    // no dirty-row tracking: report every row as changed
+    const uint32_t* getDirtyRows() const override { return nullptr; }
+    void clearDirtyRows() override {}
+
     // Snapshot loaders (ZX81 formats - stubs for now)
     void loadSNA(const uint8_t* data, uint32_t size) override;
     void loadZ80(const uint8_t* data, uint32_t size) override;
@@ -73,7 +78,26 @@ public:
     uint16_t getStmtLoopAddr() const override { return 0xFFFF; }
     uint16_t getMainReportAddr() const override { return 0xFFFF; }
 
+protected:
+    std::unique_ptr<ZXSpectrum> newInstance() const override;
+
 private:
+    // Z80 bus: the shared Spectrum bus plus the ULA's opcode fetch intercept.
+    // When the CPU fetches an opcode from an address with A15 high
+    // (display file area), the ULA intercepts: bytes with bit 6 low
+    // are display characters (replaced with NOP), bytes with bit 6
+    // high are real opcodes (e.g., HALT = 0x76).
+    struct ZX81Bus : CpuBus<ZX81> {
+        static uint8_t opcodeFetch(uint16_t address, void* param)
+        {
+            uint8_t byte = static_cast<ZX81*>(param)->ZX81::coreMemoryRead(address);
+            if ((address & 0x8000) && (byte & 0x40) == 0) {
+                return 0x00;  // NOP
+            }
+            return byte;
+        }
+    };
+
     // Render the ZX81 character display from D-FILE into the framebuffer
     void renderZX81Display();
 
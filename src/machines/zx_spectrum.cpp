@@ -8,6 +8,8 @@
 #include "zx_spectrum.hpp"
 #include "loaders/tzx_loader.hpp"
 #include "basic/sinclair_basic.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <random>
 #include <cstdio>
@@ -43,13 +45,7 @@ uint8_t ZXSpectrum::ioReadCallback(uint16_t addr, void* param)
 void ZXSpectrum::ioWriteCallback(uint16_t addr, uint8_t data, void* param)
 {
     auto* self = static_cast<ZXSpectrum*>(param);
-
-    // SpecDrum DAC: all ports ending in 0xDF
-    if (self->specdrumEnabled_ && (addr & 0xFF) == 0xDF)
-    {
-        self->audio_.setSpecdrumLevel(((static_cast<float>(data) / 255.0f) * 2.0f - 1.0f) * 0.5f);
-    }
-
+    self->specdrumWrite(addr, data);
     self->coreIOWrite(addr, data);
 }
 
@@ -81,9 +77,12 @@ ZXSpectrum::~ZXSpectrum() = default;
 
 void ZXSpectrum::baseInit()
 {
-    // Allocate memory
-    memoryRom_.resize(machineInfo_.romSize, 0);
-    memoryRam_.resize(machineInfo_.ramSize, 0);
+    // Allocate memory. A fork arrives with its source's RAM already shared
+    // and its tables copied or about to be (see fork()), and skips building
+    // them and the power-on contents below.
+    bool forked = memoryRam_.size() == machineInfo_.ramSize;
+    memoryRom_.allocate(machineInfo_.romSize);
+    if (!forked) memoryRam_.allocate(machineInfo_.ramSize);
 
     // Wire Z80 callbacks through static functions → virtual methods
     z80_->initialise(
@@ -107,38 +106,43 @@ void ZXSpectrum::baseInit()
     // For the 48K: 3,500,000 / 69,888 ≈ 50.08 Hz (not exactly 50 Hz).
     // For 128K:    3,500,000 / 70,908 ≈ 49.36 Hz.
     double fps = CPU_CLOCK_HZ / static_cast<double>(machineInfo_.tsPerFrame);
+    frameRate_ = fps;
 
     audio_.setup(AUDIO_SAMPLE_RATE, fps, machineInfo_.tsPerFrame);
     ay_.setup(AUDIO_SAMPLE_RATE, fps, machineInfo_.tsPerFrame);
     currahSpeech_.getSP0256().setup(AUDIO_SAMPLE_RATE, fps, machineInfo_.tsPerFrame);
-    contention_.init(machineInfo_);
-    display_.init(machineInfo_);
+    if (!forked) {
+        setAudioOutputRate(AUDIO_SAMPLE_RATE);
+        contention_.init(machineInfo_);
+        display_.init(machineInfo_);
+    }
 
     // 128K machines have AY built-in
     if (machineInfo_.hasAY) {
         ayEnabled_ = true;
     }
 
-    // Fill RAM with random data (mimics real hardware power-on state).
-    // This only happens at power-on, not on reset — a real Spectrum
-    // preserves RAM contents across a reset.
-    std::random_device rd;
-    std::mt19937 rng(rd());
-    std::uniform_int_distribution<int> dist(0, 255);
-    for (auto& byte : memoryRam_) {
-        byte = static_cast<uint8_t>(dist(rng));
-    }
-
-    // Zero the system variables area in bank 5 (0x5B00-0x5CFF in CPU space).
-    // The 128K/+2A/+3 ROMs check magic bytes here to detect warm vs cold
-    // reset. Random data can accidentally match, causing the ROM to skip
-    // its full screen clear and initialization.
-    if (memoryRam_.size() >= 6 * MEM_PAGE_SIZE) {
-        size_t sysvarStart = 5 * MEM_PAGE_SIZE + 0x1B00;
-        size_t sysvarEnd = 5 * MEM_PAGE_SIZE + 0x1D00;
-        if (sysvarEnd <= memoryRam_.size()) {
-            std::fill(memoryRam_.begin() + sysvarStart,
-                      memoryRam_.begin() + sysvarEnd, 0);
+    if (!forked) {
+        // Fill RAM with random data (mimics real hardware power-on state).
+        // This only happens at power-on, not on reset — a real Spectrum
+        // preserves RAM contents across a reset.
+        std::random_device rd;
+        std::mt19937 rng(rd());
+        std::uniform_int_distribution<int> dist(0, 255);
+        for (uint32_t i = 0; i < memoryRam_.pageCount(); i++) {
+            uint8_t* page = memoryRam_.writable(i);
+            for (uint32_t j = 0; j < MEM_PAGE_SIZE; j++) {
+                page[j] = static_cast<uint8_t>(dist(rng));
+            }
+        }
+
+        // Zero the system variables area in bank 5 (0x5B00-0x5CFF in CPU space).
+        // The 128K/+2A/+3 ROMs check magic bytes here to detect warm vs cold
+        // reset. Random data can accidentally match, causing the ROM to skip
+        // its full screen clear and initialization.
+        if (memoryRam_.pageCount() >= 6) {
+            uint8_t* bank5 = memoryRam_.writable(5);
+            std::fill(bank5 + 0x1B00, bank5 + 0x1D00, 0);
         }
     }
 
@@ -174,11 +178,13 @@ void ZXSpectrum::reset()
     z80_->reset(true);
     audio_.reset();
     ay_.reset();
-    ayMixOffset_ = 0;
+    mixer_.reset();
+    mixOffset_ = 0;
+    monoResampler_.reset();
+    stereoResampler_.reset();
     spectranet_.reset();
     opus_.reset();
     currahSpeech_.reset();
-    currahMixOffset_ = 0;
     keyboardMatrix_.fill(0xBF);
     display_.frameReset();
     display_.clearFramebuffer();
@@ -203,6 +209,7 @@ void ZXSpectrum::reset()
     tapeEarLevel_ = false;
     tapePulseActive_ = false;
     lastTapeReadTs_ = 0;
+    edgeLoopPulse_ = SIZE_MAX;
 }
 
 // ============================================================================
@@ -223,20 +230,7 @@ void ZXSpectrum::runFrame()
         // Run frames until all tape pulses are consumed or tape stops
         while (tapePulseActive_ && tapePulseIndex_ < tapePulses_.size())
         {
-            while (z80_->getTStates() < machineInfo_.tsPerFrame && !paused_)
-            {
-                uint32_t before = z80_->getTStates();
-                z80_->execute(1, machineInfo_.intLength);
-
-                // Advance tape timing
-                uint32_t curTs = z80_->getTStates();
-                if (curTs > lastTapeReadTs_)
-                {
-                    advanceTape(curTs - lastTapeReadTs_);
-                    lastTapeReadTs_ = curTs;
-                }
-            }
-
+            runInstantLoad(machineInfo_.tsPerFrame);
             if (paused_) break;
 
             // End-of-frame tape advance before T-state reset
@@ -262,43 +256,21 @@ void ZXSpectrum::runFrame()
         muteFrames_ = 2;
         display_.updateWithTs(
             static_cast<int32_t>(machineInfo_.tsPerFrame),
-            getScreenMemory(), borderColor_, frameCounter_);
+            screenMemory(), borderColor_, frameCounter_);
         display_.frameReset();
         frameCounter_++;
         return;
     }
 
-    // Normal speed frame — execute one instruction at a time, updating audio
-    // after each instruction to capture beeper bit-banging at full resolution.
-    // Display is updated lazily (by the machine variant's I/O write handler)
-    // only when the border colour or screen memory changes.
-    while (z80_->getTStates() < machineInfo_.tsPerFrame && !paused_)
+    // Normal speed frame. Display is updated lazily (by the machine variant's
+    // I/O write handler) only when the border colour or screen memory changes.
+    if (batchExecution_)
     {
-        uint32_t before = z80_->getTStates();
-        z80_->execute(1, machineInfo_.intLength);
-        int32_t delta = static_cast<int32_t>(z80_->getTStates() - before);
-
-        // Advance tape playback by the elapsed T-states so the EAR bit
-        // reflects the correct pulse level when the CPU reads port 0xFE
-        if (tapePulseActive_ && tapePulseIndex_ < tapePulses_.size())
-        {
-            uint32_t curTs = z80_->getTStates();
-            if (curTs > lastTapeReadTs_)
-            {
-                advanceTape(curTs - lastTapeReadTs_);
-                lastTapeReadTs_ = curTs;
-            }
-            audio_.setTapeEarBit(tapeEarLevel_ ? 1 : 0);
-        }
-        else
-        {
-            audio_.setTapeEarBit(0);
-        }
-
-        // Feed the instruction's T-states into the audio accumulator
-        audio_.update(delta);
-        if (ayEnabled_) ay_.update(delta);
-        if (currahSpeechEnabled_) currahSpeech_.getSP0256().update(delta);
+        runFrameBatched(machineInfo_.tsPerFrame);
+    }
+    else
+    {
+        runFramePerInstruction(machineInfo_.tsPerFrame);
     }
 
     if (paused_)
@@ -333,62 +305,333 @@ void ZXSpectrum::runFrame()
     // T-states (32 for 48K, 36 for 128K).
     z80_->signalInterrupt();
 
+    mixAudioFrame();
+
+    // Catch up display rendering to the end of the frame. Any scanlines not yet
+    // rendered (because no border/screen writes occurred during them) are drawn
+    // now with the final border colour and current screen memory contents.
+    display_.updateWithTs(
+        static_cast<int32_t>(machineInfo_.tsPerFrame - display_.getCurrentDisplayTs()),
+        screenMemory(), borderColor_, frameCounter_);
+    display_.frameReset();
+    frameCounter_++;
+
+    // Tick the WD1770 motor timeout (auto-off after ~2 seconds idle)
+    if (opusEnabled_) {
+        opus_.getFDC().updateMotorTimeout();
+    }
+}
+
+// Close out this frame's audio: mix the beeper, AY and uSpeech output into
+// the mono and stereo buffers, or discard it while muted after an instant load.
+// A frame turbo or replay will throw away skips the synthesis, mixer and
+// resampler and only brings the chips to the end of the frame.
+void ZXSpectrum::mixAudioFrame()
+{
+    ZXSPEC_PROFILE_SCOPE(Audio);
+
+    if (turboSkipDisplay_)
+    {
+        audio_.skipFrame();
+        resetAudioBuffer();
+        if (muteFrames_ > 0) muteFrames_--;
+        return;
+    }
+
     audio_.frameEnd();
 
-    // Mix AY output into beeper buffer (only new samples since last mix)
+    AudioMixer::Inputs inputs;
+    inputs.beeper = audio_.getMutableBuffer();
+    inputs.beeperCount = audio_.getSampleCount();
+
     if (ayEnabled_) {
         ay_.frameEnd();
-        int aySamples = ay_.getSampleCount();
-        int beeperSamples = audio_.getSampleCount();
-        int mixEnd = (aySamples < beeperSamples) ? aySamples : beeperSamples;
-        float* beeperBuf = audio_.getMutableBuffer();
-        const float* ayBuf = ay_.getBuffer();
-        for (int i = ayMixOffset_; i < mixEnd; i++) {
-            beeperBuf[i] += ayBuf[i];
+        inputs.ay = ay_.getBuffer();
+        inputs.ayCount = ay_.getSampleCount();
+        if (ay_.getChannelBuffersEnabled()) {
+            for (int ch = 0; ch < AY3_8912::NUM_CHANNELS; ch++) {
+                inputs.ayChannels[ch] = ay_.getChannelBuffer(ch);
+            }
         }
-        ayMixOffset_ = beeperSamples;
     }
 
-    // Mix Currah uSpeech output into beeper buffer and waveform display
     if (currahSpeechEnabled_) {
         currahSpeech_.getSP0256().frameEnd();
-        int spSamples = currahSpeech_.getSP0256().getSampleCount();
-        int beeperSamples = audio_.getSampleCount();
-        int mixEnd = (spSamples < beeperSamples) ? spSamples : beeperSamples;
-        float* beeperBuf = audio_.getMutableBuffer();
-        const float* spBuf = currahSpeech_.getSP0256().getBuffer();
-        for (int i = currahMixOffset_; i < mixEnd; i++) {
-            beeperBuf[i] += spBuf[i];
+        inputs.speech = currahSpeech_.getSP0256().getBuffer();
+        inputs.speechCount = currahSpeech_.getSP0256().getSampleCount();
+    }
+
+    mixer_.mix(inputs, mixOffset_);
+
+    // Also mix the speech into the waveform ring buffer so it shows up in
+    // the sound window visualisation alongside the beeper
+    if (inputs.speech) {
+        int mixEnd = std::min(inputs.speechCount, inputs.beeperCount);
+        audio_.mixIntoWaveform(inputs.speech, mixEnd, mixOffset_);
+    }
+
+    if (resampling_ && inputs.beeperCount > mixOffset_) {
+        int frames = inputs.beeperCount - mixOffset_;
+        monoResampler_.process(inputs.beeper + mixOffset_, frames);
+        if (mixer_.isStereoEnabled()) {
+            stereoResampler_.process(mixer_.getStereoBuffer() + mixOffset_ * 2, frames);
         }
-        // Also mix into the waveform ring buffer so the speech shows up
-        // in the sound window visualisation alongside the beeper
-        audio_.mixIntoWaveform(spBuf, mixEnd, currahMixOffset_);
-        currahMixOffset_ = beeperSamples;
     }
+    mixOffset_ = inputs.beeperCount;
 
     if (muteFrames_ > 0)
     {
-        audio_.resetBuffer();
-        ay_.resetBuffer();
-        currahSpeech_.getSP0256().resetBuffer();
-        ayMixOffset_ = 0;
-        currahMixOffset_ = 0;
+        resetAudioBuffer();
         muteFrames_--;
     }
+}
 
-    // Catch up display rendering to the end of the frame. Any scanlines not yet
-    // rendered (because no border/screen writes occurred during them) are drawn
-    // now with the final border colour and current screen memory contents.
-    display_.updateWithTs(
-        static_cast<int32_t>(machineInfo_.tsPerFrame - display_.getCurrentDisplayTs()),
-        getScreenMemory(), borderColor_, frameCounter_);
-    display_.frameReset();
-    frameCounter_++;
+void ZXSpectrum::runTurboFrames(int count)
+{
+    if (paused_ || count <= 0) return;
 
-    // Tick the WD1770 motor timeout (auto-off after ~2 seconds idle)
-    if (opusEnabled_) {
-        opus_.getFDC().updateMotorTimeout();
+    auto start = std::chrono::steady_clock::now();
+    uint32_t startFrame = frameCounter_;
+
+    // Every frame but the last runs with the display and the audio output
+    // switched off; the sound chips still advance so the last frame sounds
+    // as it would have
+    setSkippingFrames(true);
+    for (int i = 1; i < count && !paused_; i++)
+    {
+        runFrame();
+    }
+    setSkippingFrames(false);
+
+    if (paused_)
+    {
+        // Stopped at a breakpoint in an undrawn frame: draw it up to the beam
+        renderDisplayToBeam();
+    }
+    else
+    {
+        runFrame();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double emulated = static_cast<double>(frameCounter_ - startFrame) / frameRate_;
+    turboSpeed_ = seconds > 0.0 ? emulated / seconds : 0.0;
+}
+
+void ZXSpectrum::setSkippingFrames(bool skipping)
+{
+    display_.setRenderingEnabled(!skipping);
+    turboSkipDisplay_ = skipping;
+}
+
+// ============================================================================
+// Input journal replay
+// ============================================================================
+
+void ZXSpectrum::setInputJournalEnabled(bool enabled)
+{
+    if (!enabled) inputJournal_.clear();
+    inputJournalEnabled_ = enabled;
+}
+
+void ZXSpectrum::applyInput(const InputJournal::Event& event)
+{
+    switch (event.type)
+    {
+        case InputJournal::EventType::KeyDown:          keyDown(event.a, event.b); break;
+        case InputJournal::EventType::KeyUp:            keyUp(event.a, event.b); break;
+        case InputJournal::EventType::Kempston:         setKempstonJoystick(event.a); break;
+        case InputJournal::EventType::TapePlay:         tapePlay(); break;
+        case InputJournal::EventType::TapeStop:         tapeStop(); break;
+        case InputJournal::EventType::TapeRewind:       tapeRewind(); break;
+        case InputJournal::EventType::TapeRewindBlock:  tapeRewindBlock(); break;
+        case InputJournal::EventType::TapeForwardBlock: tapeForwardBlock(); break;
+    }
+}
+
+void ZXSpectrum::replayInputTo(uint32_t frame, uint64_t fromSequence)
+{
+    bool paused = paused_;
+    paused_ = false;
+    replayingInput_ = true;
+
+    // The frame was already run once, so its breakpoints have been seen
+    auto skipBreakpoint = [this] {
+        if (!paused_) return;
+        clearBreakpointHit();
+        clearBasicBreakpointHit();
+        paused_ = false;
+    };
+
+    // Replayed frames are never seen or heard
+    setSkippingFrames(true);
+
+    size_t next = inputJournal_.firstAtFrame(frameCounter_);
+    while (next < inputJournal_.size() && inputJournal_[next].sequence < fromSequence) next++;
+    while (frameCounter_ < frame)
+    {
+        uint32_t current = frameCounter_;
+        while (next < inputJournal_.size() && inputJournal_[next].frame == current)
+        {
+            const InputJournal::Event& event = inputJournal_[next++];
+            while (z80_->getTStates() < event.ts && z80_->getTStates() < machineInfo_.tsPerFrame)
+            {
+                runToTStates(event.ts);
+                skipBreakpoint();
+            }
+            applyInput(event);
+        }
+
+        runFrame();
+        skipBreakpoint();
+
+        // The instant loader runs several frames per call
+        while (next < inputJournal_.size() && inputJournal_[next].frame < frameCounter_) next++;
+    }
+
+    setSkippingFrames(false);
+    replayingInput_ = false;
+    paused_ = paused;
+}
+
+void ZXSpectrum::runToTStates(uint32_t endTs)
+{
+    // The same path runFrame() would take, without ending the frame
+    endTs = std::min(endTs, machineInfo_.tsPerFrame);
+    if (tapePulseActive_ && tapeInstantLoad_)
+    {
+        tapeAccelerating_ = true;
+        runInstantLoad(endTs);
+        tapeAccelerating_ = false;
+    }
+    else if (batchExecution_)
+    {
+        runFrameBatched(endTs);
+    }
+    else
+    {
+        runFramePerInstruction(endTs);
+    }
+}
+
+void ZXSpectrum::runInstantLoad(uint32_t endTs)
+{
+    while (z80_->getTStates() < endTs && !paused_)
+    {
+        z80_->execute(1, machineInfo_.intLength);
+
+        // Advance tape timing
+        uint32_t curTs = z80_->getTStates();
+        if (curTs > lastTapeReadTs_)
+        {
+            advanceTape(curTs - lastTapeReadTs_);
+            lastTapeReadTs_ = curTs;
+        }
+    }
+}
+
+void ZXSpectrum::runFramePerInstruction(uint32_t endTs)
+{
+    // Reference loop — execute one instruction at a time, updating audio
+    // after each instruction to capture beeper bit-banging at full resolution.
+    while (z80_->getTStates() < endTs && !paused_)
+    {
+        uint32_t before = z80_->getTStates();
+        z80_->execute(1, machineInfo_.intLength);
+        int32_t delta = static_cast<int32_t>(z80_->getTStates() - before);
+
+        // Advance tape playback by the elapsed T-states so the EAR bit
+        // reflects the correct pulse level when the CPU reads port 0xFE
+        if (tapePulseActive_ && tapePulseIndex_ < tapePulses_.size())
+        {
+            uint32_t curTs = z80_->getTStates();
+            if (curTs > lastTapeReadTs_)
+            {
+                advanceTape(curTs - lastTapeReadTs_);
+                lastTapeReadTs_ = curTs;
+            }
+            audio_.setTapeEarBit(tapeEarLevel_ ? 1 : 0);
+        }
+        else
+        {
+            audio_.setTapeEarBit(0);
+        }
+
+        // Feed the instruction's T-states into the audio accumulator
+        audio_.update(delta);
+        if (ayEnabled_) ay_.update(delta);
+        if (currahSpeechEnabled_) currahSpeech_.getSP0256().update(delta);
+    }
+}
+
+void ZXSpectrum::runFrameBatched(uint32_t endTs)
+{
+    // Event-scheduled equivalent of runFramePerInstruction(). The CPU runs
+    // uninterrupted until the next tape edge or the end of the frame. The
+    // per-instruction loop applies the tape EAR level sampled at the end of
+    // each instruction to that whole instruction, and sees port writes take
+    // effect from the start of the instruction that made them. So the audio
+    // devices are caught up to the start of the last instruction with the
+    // old state, and syncPeripherals() does the same ahead of every
+    // EAR/AY/SpecDrum/uSpeech access mid-batch.
+    peripheralTs_ = z80_->getTStates();
+    peripheralCatchUp_ = true;
+
+    while (z80_->getTStates() < endTs && !paused_)
+    {
+        uint32_t curTs = z80_->getTStates();
+        uint32_t deadline = endTs;
+
+        bool tapeRunning = tapePulseActive_ && tapePulseIndex_ < tapePulses_.size();
+        if (tapeRunning)
+        {
+            deadline = std::min(deadline, nextTapeEdgeTs());
+        }
+        audio_.setTapeEarBit((tapeRunning && tapeEarLevel_) ? 1 : 0);
+
+        // A deadline at or behind the current T-state still runs one instruction
+        z80_->execute(deadline > curTs ? deadline - curTs : 1, machineInfo_.intLength);
+
+        // Everything before the final instruction ran with the EAR level above
+        catchUpPeripherals(z80_->getInstructionStartTStates());
+
+        if (tapePulseActive_ && tapePulseIndex_ < tapePulses_.size())
+        {
+            curTs = z80_->getTStates();
+            if (curTs > lastTapeReadTs_)
+            {
+                advanceTape(curTs - lastTapeReadTs_);
+                lastTapeReadTs_ = curTs;
+            }
+            audio_.setTapeEarBit(tapeEarLevel_ ? 1 : 0);
+        }
+        else
+        {
+            audio_.setTapeEarBit(0);
+        }
+
+        catchUpPeripherals(z80_->getTStates());
     }
+
+    peripheralCatchUp_ = false;
+}
+
+void ZXSpectrum::catchUpPeripherals(uint32_t ts)
+{
+    if (ts <= peripheralTs_) return;
+
+    int32_t delta = static_cast<int32_t>(ts - peripheralTs_);
+    audio_.update(delta);
+    if (ayEnabled_) ay_.update(delta);
+    if (currahSpeechEnabled_) currahSpeech_.getSP0256().update(delta);
+    peripheralTs_ = ts;
+}
+
+uint32_t ZXSpectrum::nextTapeEdgeTs() const
+{
+    // advanceTape() loads the next pulse when tapePulseRemaining_ is zero
+    uint32_t remaining = tapePulseRemaining_ ? tapePulseRemaining_ : tapePulses_.pulseAt(tapePulseIndex_, tapeBlocks_);
+    return lastTapeReadTs_ + remaining;
 }
 
 void ZXSpectrum::runCycles(int cycles)
@@ -411,7 +654,7 @@ void ZXSpectrum::renderDisplay()
     display_.frameReset();
     display_.updateWithTs(
         static_cast<int32_t>(machineInfo_.tsPerFrame),
-        getScreenMemory(), borderColor_, frameCounter_);
+        screenMemory(), borderColor_, frameCounter_);
     display_.frameReset();
 }
 
@@ -431,7 +674,7 @@ void ZXSpectrum::renderDisplayToBeam()
         if (displayTs < machineInfo_.tsPerFrame) {
             display_.updateWithTs(
                 static_cast<int32_t>(machineInfo_.tsPerFrame - displayTs),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
         // Reset for the new frame
         display_.frameReset();
@@ -445,7 +688,7 @@ void ZXSpectrum::renderDisplayToBeam()
     if (cpuTs > displayTs) {
         display_.updateWithTs(
             static_cast<int32_t>(cpuTs - displayTs),
-            getScreenMemory(), borderColor_, frameCounter_);
+            screenMemory(), borderColor_, frameCounter_);
     }
 }
 
@@ -475,12 +718,24 @@ int ZXSpectrum::getSignalBufferSize() const
 
 const float* ZXSpectrum::getAudioBuffer() const
 {
-    return audio_.getBuffer();
+    return resampling_ ? monoResampler_.getOutput() : audio_.getBuffer();
 }
 
 int ZXSpectrum::getAudioSampleCount() const
 {
-    return audio_.getSampleCount();
+    return resampling_ ? monoResampler_.getFrameCount() : audio_.getSampleCount();
+}
+
+const float* ZXSpectrum::getStereoAudioBuffer() const
+{
+    if (!mixer_.isStereoEnabled()) return nullptr;
+    return resampling_ ? stereoResampler_.getOutput() : mixer_.getStereoBuffer();
+}
+
+int ZXSpectrum::getStereoAudioFrameCount() const
+{
+    if (!mixer_.isStereoEnabled()) return 0;
+    return resampling_ ? stereoResampler_.getFrameCount() : mixer_.getFrameCount();
 }
 
 void ZXSpectrum::resetAudioBuffer()
@@ -488,8 +743,50 @@ void ZXSpectrum::resetAudioBuffer()
     audio_.resetBuffer();
     ay_.resetBuffer();
     currahSpeech_.getSP0256().resetBuffer();
-    ayMixOffset_ = 0;
-    currahMixOffset_ = 0;
+    mixer_.resetBuffer();
+    monoResampler_.resetOutput();
+    stereoResampler_.resetOutput();
+    mixOffset_ = 0;
+}
+
+// The AY only averages each channel into its own buffer when a panned
+// stereo mix needs them
+void ZXSpectrum::setAYPanning(AudioMixer::AYPanning panning)
+{
+    mixer_.setAYPanning(panning);
+    ay_.setChannelBuffersEnabled(mixer_.isStereoEnabled() && panning != AudioMixer::AYPanning::Mono);
+}
+
+void ZXSpectrum::setStereoOutputEnabled(bool enabled)
+{
+    mixer_.setStereoEnabled(enabled);
+    setAYPanning(mixer_.getAYPanning());
+}
+
+void ZXSpectrum::setAudioOutputRate(int sampleRate)
+{
+    sampleRate = std::clamp(sampleRate, 8000, 192000);
+    double ppm = monoResampler_.getRateAdjustment();
+    monoResampler_.setup(AUDIO_SAMPLE_RATE, sampleRate, 1, AudioMixer::MAX_FRAMES);
+    stereoResampler_.setup(AUDIO_SAMPLE_RATE, sampleRate, 2, AudioMixer::MAX_FRAMES);
+    monoResampler_.setRateAdjustment(ppm);
+    stereoResampler_.setRateAdjustment(ppm);
+    updateResampling();
+}
+
+void ZXSpectrum::setAudioRateAdjustment(double ppm)
+{
+    monoResampler_.setRateAdjustment(ppm);
+    stereoResampler_.setRateAdjustment(ppm);
+    updateResampling();
+}
+
+// The resamplers are bypassed entirely at the internal rate, so the mono
+// output stays exactly the mixer's
+void ZXSpectrum::updateResampling()
+{
+    resampling_ = monoResampler_.getOutputRate() != static_cast<int>(AUDIO_SAMPLE_RATE) ||
+                  monoResampler_.getRateAdjustment() != 0.0;
 }
 
 // ============================================================================
@@ -500,6 +797,7 @@ void ZXSpectrum::keyDown(int row, int bit)
 {
     if (row >= 0 && row < 8 && bit >= 0 && bit < 5)
     {
+        journalInput(InputJournal::EventType::KeyDown, static_cast<uint8_t>(row), static_cast<uint8_t>(bit));
         keyboardMatrix_[row] &= ~(1 << bit);
     }
 }
@@ -508,6 +806,7 @@ void ZXSpectrum::keyUp(int row, int bit)
 {
     if (row >= 0 && row < 8 && bit >= 0 && bit < 5)
     {
+        journalInput(InputJournal::EventType::KeyUp, static_cast<uint8_t>(row), static_cast<uint8_t>(bit));
         keyboardMatrix_[row] |= (1 << bit);
     }
 }
@@ -529,6 +828,12 @@ uint8_t ZXSpectrum::readMemory(uint16_t address) const
 
 void ZXSpectrum::writeMemory(uint16_t address, uint8_t data)
 {
+    if (!getUdgScreenPatching())
+    {
+        coreDebugWrite(address, data);
+        return;
+    }
+
     uint8_t oldValue = coreDebugRead(address);
     coreDebugWrite(address, data);
     patchScreenForUdgWrite(address, oldValue, data);
@@ -982,14 +1287,26 @@ void ZXSpectrum::installOpcodeCallback()
             // Tape ROM trap
             if (tapeActive_ && handleTapeTrap(address))
             {
+                // Tape position changed — end the batch so the next tape
+                // edge is rescheduled
+                z80_->requestBreak();
                 return true;
             }
 
+            // Custom loader edge-detection loops. Not while anything could
+            // stop or observe the CPU part way round them.
+            if ((opcode == 0x04 || opcode == 0x05 || opcode == 0x3D || opcode == 0x10) && tapeEdgeSkip_ && tapePulseActive_ &&
+                !z80_->getIFF1() && !z80_->isNMIRequesting() && breakpoints_.empty() && beamBreakpoints_.empty() && !traceEnabled_)
+            {
+                skipTapeEdgeLoop(opcode, address);
+            }
+
             // SAVE detection: 48K/128K BASIC SA-BYTES entry point. JS polls
             // consumeSaveStartTrap() each frame to auto-arm tape recording.
             if (address == 0x04C2) {
                 saveStartTrapPending_ = true;
                 if (tapeInstantLoad_ && handleSaveTrap()) {
+                    z80_->requestBreak();
                     return true;
                 }
             }
@@ -1024,6 +1341,7 @@ void ZXSpectrum::installOpcodeCallback()
                     breakpointHit_ = true;
                     breakpointAddress_ = address;
                     paused_ = true;
+                    z80_->requestBreak();
                     z80_->setRegister(Z80::WordReg::PC, address);
 
                     // Render display so PRINT output is visible
@@ -1066,6 +1384,7 @@ void ZXSpectrum::installOpcodeCallback()
                         bp.lastFireFrame = frameCounter_;
                         bp.lastFireScanline = sl;
                         paused_ = true;
+                        z80_->requestBreak();
                         z80_->setRegister(Z80::WordReg::PC, address);
                         return true;
                     }
@@ -1088,6 +1407,7 @@ void ZXSpectrum::installOpcodeCallback()
                     breakpointHit_ = true;
                     breakpointAddress_ = address;
                     paused_ = true;
+                    z80_->requestBreak();
                     z80_->setRegister(Z80::WordReg::PC, address);
                     return true;
                 }
@@ -1200,6 +1520,7 @@ void ZXSpectrum::patchScreenForUdgWrite(uint16_t address, uint8_t oldValue, uint
             int c  = positions.positions[p] % 32;
             int off = (cr >> 3) * 0x800 + pixelRow * 0x100 + (cr & 7) * 0x20 + c;
             screen[off] = newValue;
+            display_.markScreenWrite(static_cast<uint32_t>(off));
         }
         return;
     }
@@ -1221,6 +1542,7 @@ void ZXSpectrum::patchScreenForUdgWrite(uint16_t address, uint8_t oldValue, uint
                 // Write the new value at the changed pixel row
                 int off = (cr >> 3) * 0x800 + pixelRow * 0x100 + (cr & 7) * 0x20 + c;
                 screen[off] = newValue;
+                display_.markScreenWrite(static_cast<uint32_t>(off));
             }
         }
     }
@@ -1233,6 +1555,7 @@ void ZXSpectrum::patchScreenForUdgWrite(uint16_t address, uint8_t oldValue, uint
 void ZXSpectrum::tapePlay()
 {
     if (tapeBlocks_.empty()) return;
+    journalInput(InputJournal::EventType::TapePlay);
     tapeActive_ = true;
     tapePulseActive_ = true;
     installOpcodeCallback();
@@ -1240,11 +1563,13 @@ void ZXSpectrum::tapePlay()
 
 void ZXSpectrum::tapeStop()
 {
+    journalInput(InputJournal::EventType::TapeStop);
     tapePulseActive_ = false;
 }
 
 void ZXSpectrum::tapeRewind()
 {
+    journalInput(InputJournal::EventType::TapeRewind);
     tapeBlockIndex_ = 0;
     tapePulseIndex_ = 0;
     tapePulseRemaining_ = 0;
@@ -1254,11 +1579,12 @@ void ZXSpectrum::tapeRewind()
 
 void ZXSpectrum::tapeRewindBlock()
 {
+    journalInput(InputJournal::EventType::TapeRewindBlock);
     if (tapeBlockIndex_ > 0) {
         tapeBlockIndex_--;
     }
-    if (tapeBlockIndex_ < tapePulseBlockStarts_.size()) {
-        tapePulseIndex_ = tapePulseBlockStarts_[tapeBlockIndex_];
+    if (tapeBlockIndex_ < tapePulses_.blockStartCount()) {
+        tapePulseIndex_ = tapePulses_.blockStart(tapeBlockIndex_);
     }
     tapePulseRemaining_ = 0;
     tapeEarLevel_ = false;
@@ -1267,11 +1593,12 @@ void ZXSpectrum::tapeRewindBlock()
 
 void ZXSpectrum::tapeForwardBlock()
 {
+    journalInput(InputJournal::EventType::TapeForwardBlock);
     if (tapeBlockIndex_ + 1 < tapeBlocks_.size()) {
         tapeBlockIndex_++;
     }
-    if (tapeBlockIndex_ < tapePulseBlockStarts_.size()) {
-        tapePulseIndex_ = tapePulseBlockStarts_[tapeBlockIndex_];
+    if (tapeBlockIndex_ < tapePulses_.blockStartCount()) {
+        tapePulseIndex_ = tapePulses_.blockStart(tapeBlockIndex_);
     }
     tapePulseRemaining_ = 0;
     tapeEarLevel_ = false;
@@ -1320,6 +1647,362 @@ void ZXSpectrum::tapeRestoreState(const uint8_t* buffer)
     tapeEarLevel_ = (flags & 2) != 0;
     tapeInstantLoad_ = (flags & 4) != 0;
     tapeAccelerating_ = (flags & 8) != 0;
+    edgeLoopPulse_ = SIZE_MAX;
+}
+
+void ZXSpectrum::fdcSnapshotState(uint8_t* buffer) const
+{
+    std::memset(buffer, 0, FDC_SNAPSHOT_SIZE);
+
+    // Opus Discovery: WD1770 at offset 64
+    if (opusEnabled_) {
+        opus_.getFDC().snapshotState(buffer + 64);
+    }
+}
+
+void ZXSpectrum::fdcRestoreState(const uint8_t* buffer)
+{
+    if (opusEnabled_) {
+        opus_.getFDC().restoreState(buffer + 64);
+    }
+}
+
+// ============================================================================
+// Native machine state
+// ============================================================================
+
+static constexpr uint32_t CHUNK_MACHINE    = stateChunkId("MACH");
+static constexpr uint32_t CHUNK_CPU        = stateChunkId("CPU ");
+static constexpr uint32_t CHUNK_RAM        = stateChunkId("RAM ");
+static constexpr uint32_t CHUNK_DISPLAY    = stateChunkId("DISP");
+static constexpr uint32_t CHUNK_BEEPER     = stateChunkId("BEEP");
+static constexpr uint32_t CHUNK_AY         = stateChunkId("AY  ");
+static constexpr uint32_t CHUNK_MIXER      = stateChunkId("MIX ");
+static constexpr uint32_t CHUNK_TAPE       = stateChunkId("TAPE");
+static constexpr uint32_t CHUNK_SPECTRANET = stateChunkId("SNET");
+static constexpr uint32_t CHUNK_OPUS       = stateChunkId("OPUS");
+static constexpr uint32_t CHUNK_CURRAH     = stateChunkId("CURR");
+
+// Every base chunk is at version 1; bump a chunk's version with its layout
+static constexpr uint16_t CHUNK_VERSION = 1;
+
+void ZXSpectrum::saveState(std::vector<uint8_t>& out, bool compress) const
+{
+    StateWriter writer(out, static_cast<uint8_t>(getId()), compress);
+    writeState(writer, false);
+}
+
+// A fork's copy takes the RAM pages and the display straight from its
+// source, so the state it reads leaves them out
+void ZXSpectrum::writeState(StateWriter& writer, bool forking) const
+{
+    writer.beginChunk(CHUNK_MACHINE, CHUNK_VERSION);
+    writer.write(frameCounter_);
+    writer.write(borderColor_);
+    writer.write(keyboardMatrix_);
+    writer.write(kempstonJoystick_);
+    writer.write(getPagingRegister());
+    writer.write(getPagingRegister1FFD());
+    writer.write(peripheralTs_);
+    writer.write(mixOffset_);
+    writer.write(muteFrames_);
+    writer.endChunk();
+
+    writer.beginChunk(CHUNK_CPU, CHUNK_VERSION);
+    z80_->saveState(writer);
+    writer.endChunk();
+
+    if (!forking) {
+        writer.beginChunk(CHUNK_RAM, CHUNK_VERSION);
+        writer.write(memoryRam_.size());
+        for (uint32_t i = 0; i < memoryRam_.pageCount(); i++) {
+            writer.bytes(memoryRam_.page(i), MEM_PAGE_SIZE);
+        }
+        writer.endChunk();
+
+        writer.beginChunk(CHUNK_DISPLAY, CHUNK_VERSION);
+        display_.saveState(writer);
+        writer.endChunk();
+    }
+
+    writer.beginChunk(CHUNK_BEEPER, CHUNK_VERSION);
+    audio_.saveState(writer);
+    writer.endChunk();
+
+    writer.beginChunk(CHUNK_AY, CHUNK_VERSION);
+    ay_.saveState(writer);
+    writer.endChunk();
+
+    writer.beginChunk(CHUNK_MIXER, CHUNK_VERSION);
+    mixer_.saveState(writer);
+    writer.endChunk();
+
+    // Position in the loaded tape, edge-loop skipping and a recording in
+    // progress; recordings already finished are tape data, not state
+    writer.beginChunk(CHUNK_TAPE, CHUNK_VERSION);
+    writer.write(tapeActive_);
+    writer.write(tapePulseActive_);
+    writer.write(static_cast<uint64_t>(tapeBlockIndex_));
+    writer.write(static_cast<uint64_t>(tapePulseIndex_));
+    writer.write(tapePulseRemaining_);
+    writer.write(tapeEarLevel_);
+    writer.write(lastTapeReadTs_);
+    writer.write(edgeLoopAddr_);
+    writer.write(edgeLoopCounter_);
+    writer.write(edgeLoopTs_);
+    writer.write(edgeLoopFrame_);
+    writer.write(static_cast<uint64_t>(edgeLoopPulse_));
+    writer.write(saveStartTrapPending_);
+    writer.write(tapeRecording_);
+    writer.write(recordPulses_);
+    writer.write(recordLastTransitionTs_);
+    writer.write(recordLastMicBit_);
+    writer.write(recordAbsoluteTs_);
+    writer.write(recordDecodeState_);
+    writer.write(recordPilotCount_);
+    writer.write(recordDataPulseCount_);
+    writer.write(recordCurrentByte_);
+    writer.write(recordBitCount_);
+    writer.write(recordCurrentBlockData_);
+    writer.endChunk();
+
+    if (spectranetEnabled_) {
+        writer.beginChunk(CHUNK_SPECTRANET, CHUNK_VERSION);
+        spectranet_.saveState(writer);
+        writer.endChunk();
+    }
+    if (opusEnabled_) {
+        writer.beginChunk(CHUNK_OPUS, CHUNK_VERSION);
+        writer.write(opusRomType_);
+        opus_.saveState(writer);
+        writer.endChunk();
+    }
+    if (currahSpeechEnabled_) {
+        writer.beginChunk(CHUNK_CURRAH, CHUNK_VERSION);
+        currahSpeech_.saveState(writer);
+        writer.endChunk();
+    }
+
+    saveVariantState(writer);
+}
+
+int ZXSpectrum::stateMachineId(const uint8_t* data, uint32_t size)
+{
+    uint16_t version = 0;
+    if (!data || size < StateWriter::HEADER_SIZE) return -1;
+    if (std::memcmp(data, StateWriter::MAGIC, 4) != 0) return -1;
+    std::memcpy(&version, data + 4, 2);
+    if (version == 0 || version > StateWriter::FORMAT_VERSION) return -1;
+    return data[6];
+}
+
+bool ZXSpectrum::loadState(const uint8_t* data, uint32_t size)
+{
+    // readState() checks the chunk layout before touching the machine, but
+    // a chunk's contents can still fail part way through being applied, so
+    // keep the machine as it was to put back
+    std::vector<uint8_t> before;
+    saveState(before);
+    OpusRomType romType = opusRomType_;
+    if (readState(data, size, false)) return true;
+
+    if (opusRomType_ != romType) setOpusRomType(romType);
+    readState(before.data(), static_cast<uint32_t>(before.size()), false);
+    return false;
+}
+
+bool ZXSpectrum::readState(const uint8_t* data, uint32_t size, bool forking)
+{
+    if (stateMachineId(data, size) != static_cast<int>(getId())) return false;
+
+    // Check every chunk lies within the data, and the core ones are there,
+    // before touching the machine. Compressed chunks are expanded here.
+    std::vector<StateReader> chunks;
+    std::vector<std::vector<uint8_t>> expanded;
+    uint32_t chunkCount = 0;
+    std::memcpy(&chunkCount, data + 8, 4);
+    uint32_t pos = StateWriter::HEADER_SIZE;
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        if (size - pos < StateWriter::CHUNK_HEADER_SIZE) return false;
+        uint32_t id = 0;
+        uint16_t version = 0;
+        uint16_t flags = 0;
+        uint32_t length = 0;
+        std::memcpy(&id, data + pos, 4);
+        std::memcpy(&version, data + pos + 4, 2);
+        std::memcpy(&flags, data + pos + 6, 2);
+        std::memcpy(&length, data + pos + 8, 4);
+        pos += StateWriter::CHUNK_HEADER_SIZE;
+        if (length > size - pos) return false;
+        if (flags & ~StateWriter::CHUNK_COMPRESSED) return false;
+
+        if (flags & StateWriter::CHUNK_COMPRESSED) {
+            size_t rawSize = lzDecodedSize(data + pos, length);
+            if (rawSize == SIZE_MAX || rawSize > UINT32_MAX) return false;
+            std::vector<uint8_t>& raw = expanded.emplace_back(rawSize);
+            if (!lzDecode(data + pos, length, raw.data(), rawSize)) return false;
+            chunks.emplace_back(id, version, raw.data(), static_cast<uint32_t>(rawSize));
+        } else {
+            chunks.emplace_back(id, version, data + pos, length);
+        }
+        pos += length;
+    }
+
+    auto has = [&](uint32_t id) {
+        return std::any_of(chunks.begin(), chunks.end(), [id](const StateReader& c) { return c.id() == id; });
+    };
+    if (!has(CHUNK_MACHINE) || !has(CHUNK_CPU) || has(CHUNK_RAM) == forking) return false;
+
+    setSpectranetEnabled(has(CHUNK_SPECTRANET));
+    setOpusEnabled(has(CHUNK_OPUS));
+    setCurrahSpeechEnabled(has(CHUNK_CURRAH));
+
+    bool ok = true;
+    for (StateReader& reader : chunks) {
+        uint32_t id = reader.id();
+        bool base = id == CHUNK_MACHINE || id == CHUNK_CPU || id == CHUNK_RAM || id == CHUNK_DISPLAY
+                 || id == CHUNK_BEEPER || id == CHUNK_AY || id == CHUNK_MIXER || id == CHUNK_TAPE
+                 || id == CHUNK_SPECTRANET || id == CHUNK_OPUS || id == CHUNK_CURRAH;
+        if (!base) {
+            ok = loadVariantChunk(reader);
+        } else if (reader.version() != CHUNK_VERSION) {
+            ok = false;
+        } else if (id == CHUNK_MACHINE) {
+            uint8_t paging = 0;
+            uint8_t paging1FFD = 0;
+            reader.read(frameCounter_);
+            reader.read(borderColor_);
+            reader.read(keyboardMatrix_);
+            reader.read(kempstonJoystick_);
+            reader.read(paging);
+            reader.read(paging1FFD);
+            reader.read(peripheralTs_);
+            reader.read(mixOffset_);
+            reader.read(muteFrames_);
+            setPagingRegister1FFD(paging1FFD);
+            setPagingRegister(paging);
+            ok = reader.ok();
+        } else if (id == CHUNK_CPU) {
+            ok = z80_->loadState(reader);
+        } else if (id == CHUNK_RAM) {
+            uint32_t ramSize = 0;
+            ok = reader.read(ramSize) && ramSize == memoryRam_.size();
+            for (uint32_t i = 0; ok && i < memoryRam_.pageCount(); i++) {
+                ok = reader.bytes(memoryRam_.writable(i), MEM_PAGE_SIZE);
+            }
+            remapMemory();
+            dirtyRamBanks_ = ~0u;
+        } else if (id == CHUNK_DISPLAY) {
+            ok = display_.loadState(reader);
+        } else if (id == CHUNK_BEEPER) {
+            ok = audio_.loadState(reader);
+        } else if (id == CHUNK_AY) {
+            ok = ay_.loadState(reader);
+        } else if (id == CHUNK_MIXER) {
+            ok = mixer_.loadState(reader);
+        } else if (id == CHUNK_TAPE) {
+            uint64_t blockIndex = 0;
+            uint64_t pulseIndex = 0;
+            uint64_t loopPulse = 0;
+            reader.read(tapeActive_);
+            reader.read(tapePulseActive_);
+            reader.read(blockIndex);
+            reader.read(pulseIndex);
+            reader.read(tapePulseRemaining_);
+            reader.read(tapeEarLevel_);
+            reader.read(lastTapeReadTs_);
+            reader.read(edgeLoopAddr_);
+            reader.read(edgeLoopCounter_);
+            reader.read(edgeLoopTs_);
+            reader.read(edgeLoopFrame_);
+            reader.read(loopPulse);
+            reader.read(saveStartTrapPending_);
+            reader.read(tapeRecording_);
+            reader.read(recordPulses_);
+            reader.read(recordLastTransitionTs_);
+            reader.read(recordLastMicBit_);
+            reader.read(recordAbsoluteTs_);
+            reader.read(recordDecodeState_, REC_DATA);
+            reader.read(recordPilotCount_);
+            reader.read(recordDataPulseCount_);
+            reader.read(recordCurrentByte_);
+            reader.read(recordBitCount_);
+            reader.read(recordCurrentBlockData_);
+
+            // A position past the end of the loaded tape stops it there
+            tapeBlockIndex_ = static_cast<size_t>(std::min<uint64_t>(blockIndex, tapeBlocks_.size()));
+            tapePulseIndex_ = static_cast<size_t>(std::min<uint64_t>(pulseIndex, tapePulses_.size()));
+            if (pulseIndex > tapePulses_.size()) tapePulseActive_ = false;
+            edgeLoopPulse_ = loopPulse < tapePulses_.size() ? static_cast<size_t>(loopPulse) : SIZE_MAX;
+            ok = reader.ok();
+        } else if (id == CHUNK_SPECTRANET) {
+            ok = spectranet_.loadState(reader);
+        } else if (id == CHUNK_OPUS) {
+            OpusRomType romType = opusRomType_;
+            reader.read(romType, OpusRomType::QUICKDOS);
+            if (romType != opusRomType_) setOpusRomType(romType);
+            ok = opus_.loadState(reader);
+        } else if (id == CHUNK_CURRAH) {
+            ok = currahSpeech_.loadState(reader);
+        }
+
+        if (!ok) return false;
+    }
+
+    installOpcodeCallback();
+    return true;
+}
+
+std::unique_ptr<ZXSpectrum> ZXSpectrum::fork()
+{
+    if (getId() == eZX81) return nullptr;
+
+    // The copy takes this machine's RAM pages, timing tables and resamplers
+    // before init(), which then leaves them alone, and its ROM pages and
+    // display (tables and picture) after
+    std::unique_ptr<ZXSpectrum> copy = newInstance();
+    copy->memoryRam_.share(memoryRam_);
+    copy->contention_ = contention_;
+    copy->monoResampler_ = monoResampler_;
+    copy->stereoResampler_ = stereoResampler_;
+    copy->resampling_ = resampling_;
+    copy->init();
+    copy->memoryRom_.share(memoryRom_);
+    copy->display_ = display_;
+
+    // Settings and media the state leaves out
+    copy->issueNumber_ = issueNumber_;
+    copy->ayEnabled_ = ayEnabled_;
+    copy->specdrumEnabled_ = specdrumEnabled_;
+    copy->tapeInstantLoad_ = tapeInstantLoad_;
+    copy->tapeEdgeSkip_ = tapeEdgeSkip_;
+    copy->batchExecution_ = batchExecution_;
+    copy->paused_ = paused_;
+    for (int source = 0; source < AudioMixer::SourceCount; source++) {
+        auto s = static_cast<AudioMixer::Source>(source);
+        copy->mixer_.setGain(s, mixer_.getGain(s));
+    }
+    copy->mixer_.setStereoEnabled(mixer_.isStereoEnabled());
+    copy->setAYPanning(mixer_.getAYPanning());
+    copy->mixer_.setDCBlockEnabled(mixer_.isDCBlockEnabled());
+    copy->tapeBlocks_ = tapeBlocks_;
+    copy->tapePulses_ = tapePulses_;
+    copy->tapeBlockInfo_ = tapeBlockInfo_;
+    copy->tapeMetadata_ = tapeMetadata_;
+
+    // Everything else goes through the native state
+    std::vector<uint8_t> state;
+    StateWriter writer(state, static_cast<uint8_t>(getId()));
+    writeState(writer, true);
+    if (!copy->readState(state.data(), static_cast<uint32_t>(state.size()), true)) return nullptr;
+    copy->opus_.copyMediaFrom(opus_);
+    forkVariant(*copy);
+
+    // Both sides now share every page, so neither may write through its
+    // old page tables
+    remapMemory();
+    copy->remapMemory();
+    return copy;
 }
 
 void ZXSpectrum::tapeSetBlockPause(size_t blockIndex, uint16_t pauseMs)
@@ -1327,13 +2010,10 @@ void ZXSpectrum::tapeSetBlockPause(size_t blockIndex, uint16_t pauseMs)
     if (blockIndex < tapeBlocks_.size())
     {
         tapeBlocks_[blockIndex].pauseMs = pauseMs;
+        tapeChanges_++;
 
-        // Regenerate pulses with the updated pause
-        std::vector<uint32_t> pulses;
-        std::vector<size_t> blockPulseStarts;
-        TZXLoader::generatePulses(tapeBlocks_, pulses, blockPulseStarts);
-        tapePulses_ = std::move(pulses);
-        tapePulseBlockStarts_ = std::move(blockPulseStarts);
+        // Rebuild the pulse stream with the updated pause
+        tapePulses_.build(tapeBlocks_);
     }
 }
 
@@ -1344,8 +2024,8 @@ void ZXSpectrum::tapeEject()
     tapeBlocks_.clear();
     tapeBlockInfo_.clear();
     tapeBlockIndex_ = 0;
+    tapeChanges_++;
     tapePulses_.clear();
-    tapePulseBlockStarts_.clear();
     tapePulseIndex_ = 0;
     tapePulseRemaining_ = 0;
     tapeEarLevel_ = false;
@@ -1425,9 +2105,9 @@ bool ZXSpectrum::handleTapeTrap(uint16_t address)
 
     tapeBlockIndex_++;
 
-    if (tapeBlockIndex_ < tapePulseBlockStarts_.size())
+    if (tapeBlockIndex_ < tapePulses_.blockStartCount())
     {
-        tapePulseIndex_ = tapePulseBlockStarts_[tapeBlockIndex_];
+        tapePulseIndex_ = tapePulses_.blockStart(tapeBlockIndex_);
         tapePulseRemaining_ = 0;
     }
 
@@ -1712,7 +2392,7 @@ void ZXSpectrum::advanceTape(uint32_t tstates)
     {
         if (tapePulseRemaining_ == 0)
         {
-            tapePulseRemaining_ = tapePulses_[tapePulseIndex_];
+            tapePulseRemaining_ = tapePulses_.pulseAt(tapePulseIndex_, tapeBlocks_);
         }
 
         if (tstates >= tapePulseRemaining_)
@@ -1723,8 +2403,8 @@ void ZXSpectrum::advanceTape(uint32_t tstates)
             tapeEarLevel_ = !tapeEarLevel_;
 
             // Track block boundaries during pulse playback
-            if (tapeBlockIndex_ + 1 < tapePulseBlockStarts_.size() &&
-                tapePulseIndex_ >= tapePulseBlockStarts_[tapeBlockIndex_ + 1])
+            if (tapeBlockIndex_ + 1 < tapePulses_.blockStartCount() &&
+                tapePulseIndex_ >= tapePulses_.blockStart(tapeBlockIndex_ + 1))
             {
                 tapeBlockIndex_++;
 
@@ -1751,4 +2431,131 @@ void ZXSpectrum::advanceTape(uint32_t tstates)
     }
 }
 
+// ============================================================================
+// Tape edge-loop skipping
+//
+// Custom loaders (Speedlock, Alkatraz and friends) find each tape edge with
+// a copy of the ROM's LD-EDGE-1: a short delay, then a sampling loop. The
+// ROM's LD-START and many custom loaders also pause with a DJNZ $.
+//
+//   delay:  DEC A         counted down from LD A,n
+//           JR NZ,delay
+//
+//   wait:   DJNZ wait
+//
+//   sample: INC B         (or DEC B) timeout counter
+//           RET Z
+//           LD A,n        (optional) keyboard half-row for the BREAK check
+//           IN A,(0xFE)
+//           RRA           EAR to bit 5, SPACE to carry
+//           RET NC        (optional) BREAK pressed
+//           XOR C         compare with the last EAR level
+//           AND 0x20
+//           JR Z,sample
+//
+// Once the CPU has gone round either loop and come back to its first
+// instruction, each further pass changes only the counter, R and the
+// T-state count: F is rebuilt by every pass and WZ already holds the jump
+// target. For the sampling loop that holds until the next edge, as every
+// pass reads the same port value. Those passes are credited here in one
+// step, straight after the opcode fetch, and the CPU runs the last one (the
+// pass that falls out of the delay or sees the edge) itself.
+//
+// Passes are a fixed length only while no access is contended, so at normal
+// speed the skip stops short of the next contended T-state. Instant load
+// turns contention off, so there it runs right up to the edge.
+// ============================================================================
+
+void ZXSpectrum::skipTapeEdgeLoop(uint8_t opcode, uint16_t address)
+{
+    uint32_t curTs = z80_->getTStates();
+    Z80::ByteReg counterReg = (opcode == 0x3D) ? Z80::ByteReg::A : Z80::ByteReg::B;
+    uint8_t counter = z80_->getRegister(counterReg);
+    bool sampling = (opcode == 0x04 || opcode == 0x05);
+
+    // Bring the tape up to now so the pulse index shows any edge since the
+    // previous pass
+    if (curTs > lastTapeReadTs_)
+    {
+        advanceTape(curTs - lastTapeReadTs_);
+        lastTapeReadTs_ = curTs;
+    }
+
+    uint8_t lastCounter = static_cast<uint8_t>(opcode == 0x04 ? counter - 1 : counter + 1);
+    bool backAgain = address == edgeLoopAddr_ && lastCounter == edgeLoopCounter_ &&
+                     frameCounter_ == edgeLoopFrame_ && curTs > edgeLoopTs_ &&
+                     (!sampling || tapePulseIndex_ == edgeLoopPulse_);
+    uint32_t elapsed = curTs - edgeLoopTs_;
+
+    edgeLoopAddr_ = address;
+    edgeLoopCounter_ = counter;
+    edgeLoopTs_ = curTs;
+    edgeLoopFrame_ = frameCounter_;
+    edgeLoopPulse_ = tapePulseIndex_;
+
+    if (!backAgain || !tapePulseActive_ || tapePulseIndex_ >= tapePulses_.size()) return;
+
+    // Match the loop body, totalling the uncontended T-states and opcode
+    // fetches (each bumps R) of one pass
+    uint16_t pc = address + 1;
+    uint32_t cost = (opcode == 0x10) ? 13 : 4;
+    uint32_t fetches = 1;
+    auto match = [&](uint8_t op, uint32_t ts) {
+        if (coreDebugRead(pc) != op) return false;
+        pc++;
+        cost += ts;
+        fetches++;
+        return true;
+    };
+
+    if (sampling)
+    {
+        if (!match(0xC8, 5)) return;                                // RET Z
+        if (match(0x3E, 7)) pc++;                                   // LD A,n
+        // IN A,(0xFE). The IO cycle's 4 T-states come from the contention
+        // pattern, which instant load skips.
+        if (!match(0xDB, tapeAccelerating_ ? 7 : 11) || coreDebugRead(pc++) != 0xFE) return;
+        if (!match(0x1F, 4)) return;                                // RRA
+        match(0xD0, 5);                                             // RET NC
+        if (!match(0xA9, 4)) return;                                // XOR C
+        if (!match(0xE6, 7) || coreDebugRead(pc++) != 0x20) return; // AND 0x20
+        if (!match(0x28, 12)) return;                               // JR Z
+    }
+    else if (opcode == 0x3D && !match(0x20, 12))                    // JR NZ
+    {
+        return;
+    }
+    int8_t offset = static_cast<int8_t>(coreDebugRead(pc++));
+    if (static_cast<uint16_t>(pc + offset) != address) return;
+
+    // The last fetch here was one pass ago, not an exit and re-entry
+    if (elapsed >= 2 * cost) return;
+
+    // Credit passes while the counter stays clear of zero, and the pass
+    // after them starts before the end of the frame and any contention. The
+    // instruction just fetched finishes with the skipped passes (DJNZ has up
+    // to 9 T-states still to run), and must do so before the next edge.
+    uint32_t passes = (opcode == 0x04) ? static_cast<uint8_t>(~counter)
+                                       : static_cast<uint8_t>(counter - 1);
+    uint32_t tail = (opcode == 0x10) ? 9 : 0;
+    uint32_t edgeTs = nextTapeEdgeTs();
+    uint32_t limit = std::min(edgeTs > tail + 1 ? edgeTs - tail - 1 : 0, machineInfo_.tsPerFrame);
+    if (!tapeAccelerating_)
+    {
+        limit = std::min(limit, contention_.contentionFreeUntil(curTs));
+    }
+    if (limit <= curTs) return;
+    passes = std::min(passes, (limit - curTs) / cost);
+    if (passes == 0) return;
+
+    z80_->addTStates(passes * cost);
+    counter = static_cast<uint8_t>(opcode == 0x04 ? counter + passes : counter - passes);
+    z80_->setRegister(counterReg, counter);
+    uint8_t r = z80_->getRegister(Z80::ByteReg::R);
+    z80_->setRegister(Z80::ByteReg::R, static_cast<uint8_t>((r & 0x80) | ((r + passes * fetches) & 0x7F)));
+
+    edgeLoopCounter_ = counter;
+    edgeLoopTs_ = z80_->getTStates();
+}
+
 } // namespace zxspec
@@ -15,15 +15,21 @@
 #include "machine_info.hpp"
 #include "audio.hpp"
 #include "ay.hpp"
+#include "audio_mixer.hpp"
+#include "resampler.hpp"
 #include "spectranet/spectranet.hpp"
 #include "opus/opus_discovery.hpp"
 #include "currah/currah_speech.hpp"
 #include "display.hpp"
 #include "contention.hpp"
 #include "tape_block.hpp"
+#include "tape_pulse_stream.hpp"
+#include "input_journal.hpp"
+#include "memory_pages.hpp"
 #include "loaders/tap_loader.hpp"
 #include "../core/z80/z80.hpp"
 #include "../core/z80/z80_disassembler.hpp"
+#include "../core/frame_profile.hpp"
 #include <array>
 #include <cstdint>
 #include <memory>
@@ -35,10 +41,12 @@ namespace zxspec {
 
 class TZXLoader;
 class TAPLoader;
+class TimeTravel;
 
 class ZXSpectrum : public Machine {
     friend class TZXLoader;
     friend class TAPLoader;
+    friend class TimeTravel;
 
 public:
     ZXSpectrum();
@@ -59,14 +67,22 @@ public:
     int getFramebufferSize() const override;
     const uint8_t* getSignalBuffer() const override;
     int getSignalBufferSize() const override;
+    const uint32_t* getDirtyRows() const override { return display_.getDirtyRows(); }
+    void clearDirtyRows() override { display_.clearDirtyRows(); }
     const float* getAudioBuffer() const override;
     int getAudioSampleCount() const override;
     void resetAudioBuffer() override;
+    const float* getStereoAudioBuffer() const override;
+    int getStereoAudioFrameCount() const override;
 
     void keyDown(int row, int bit) override;
     void keyUp(int row, int bit) override;
 
-    void setKempstonJoystick(uint8_t value) { kempstonJoystick_ = value; }
+    void setKempstonJoystick(uint8_t value)
+    {
+        journalInput(InputJournal::EventType::Kempston, value);
+        kempstonJoystick_ = value;
+    }
     uint8_t getKempstonJoystick() const { return kempstonJoystick_; }
     uint8_t getKeyboardRow(int row) const override;
 
@@ -80,6 +96,37 @@ public:
     bool isPaused() const override { return paused_; }
     void setPaused(bool paused) override { paused_ = paused; }
 
+    // Batch execution: runFrame() runs the CPU to the next scheduled event
+    // (tape edge or end of frame) and catches the audio devices up lazily at
+    // the port/memory accesses that affect them. Disabling it falls back to
+    // the reference one-instruction-per-call loop; both produce identical
+    // output.
+    void setBatchExecutionEnabled(bool enabled) { batchExecution_ = enabled; }
+    bool isBatchExecutionEnabled() const { return batchExecution_; }
+
+    // Turbo mode: run count frames in one call, as fast as the host allows.
+    // Contention and timing stay exact, but only the last frame is drawn and
+    // only its audio is kept, so the host sees one ordinary frame. Stops
+    // early if a breakpoint pauses the machine. getTurboSpeed() reports the
+    // last call's throughput as a multiple of real time.
+    void runTurboFrames(int count);
+    double getTurboSpeed() const { return turboSpeed_; }
+
+    // Input journal: while enabled, every input is logged with the frame
+    // counter and T-state it arrived at. replayInputTo() runs on to frame,
+    // re-applying the logged inputs at the same points, so a snapshot from
+    // an earlier frame replays to exactly the state the machine first had.
+    // Inputs that arrived mid-frame (while stepping in the debugger) are
+    // applied at the first instruction boundary at or after their T-state,
+    // reached through the same tape, beeper and AY catch-up as runFrame().
+    // Events numbered below fromSequence were applied before the snapshot
+    // being replayed from was taken, and are skipped.
+    void setInputJournalEnabled(bool enabled);
+    bool isInputJournalEnabled() const { return inputJournalEnabled_; }
+    InputJournal& getInputJournal() { return inputJournal_; }
+    const InputJournal& getInputJournal() const { return inputJournal_; }
+    void replayInputTo(uint32_t frame, uint64_t fromSequence = 0);
+
     void addBreakpoint(uint16_t addr) override;
     void removeBreakpoint(uint16_t addr) override;
     void enableBreakpoint(uint16_t addr, bool enabled) override;
@@ -180,6 +227,20 @@ public:
     bool isAYEnabled() const { return ayEnabled_; }
     void setAYEnabled(bool enabled) { ayEnabled_ = enabled; }
 
+    // Frame-end mixer (per-source gain, AY stereo panning, stereo output)
+    AudioMixer& getMixer() { return mixer_; }
+    const AudioMixer& getMixer() const { return mixer_; }
+    void setAYPanning(AudioMixer::AYPanning panning);
+    void setStereoOutputEnabled(bool enabled) override;
+    bool isStereoOutputEnabled() const { return mixer_.isStereoEnabled(); }
+
+    // Host output rate. At anything other than AUDIO_SAMPLE_RATE (or with a
+    // rate adjustment) the mono and stereo buffers are resampled to it.
+    void setAudioOutputRate(int sampleRate);
+    int getAudioOutputRate() const { return monoResampler_.getOutputRate(); }
+    void setAudioRateAdjustment(double ppm);
+    double getAudioRateAdjustment() const { return monoResampler_.getRateAdjustment(); }
+
     // SpecDrum 8-bit DAC peripheral
     bool isSpecdrumEnabled() const { return specdrumEnabled_; }
     void setSpecdrumEnabled(bool enabled) { specdrumEnabled_ = enabled; if (!enabled) audio_.setSpecdrumLevel(0.0f); }
@@ -227,7 +288,14 @@ public:
     const TapeMetadata& tapeGetMetadata() const { return tapeMetadata_; }
     void tapeSetInstantLoad(bool instant) { tapeInstantLoad_ = instant; }
     bool tapeGetInstantLoad() const { return tapeInstantLoad_; }
+    // Edge-loop skipping for custom loaders (see skipTapeEdgeLoop). On by
+    // default on the Spectrum models; the results are identical either way.
+    void tapeSetEdgeSkip(bool skip) { tapeEdgeSkip_ = skip; }
+    bool tapeGetEdgeSkip() const { return tapeEdgeSkip_; }
     void tapeSetBlockPause(size_t blockIndex, uint16_t pauseMs);
+    // Counts every insert, eject and edit of the tape, none of which are
+    // part of the tape snapshot below
+    uint32_t tapeGetChangeCount() const { return tapeChanges_; }
 
     // Tape state snapshot/restore (for time-travel scrubber)
     // Format: 24 bytes — blockIndex(8), pulseIndex(8), pulseRemaining(4), lastReadTs(4), flags(1)
@@ -235,6 +303,39 @@ public:
     void tapeSnapshotState(uint8_t* buffer) const;
     void tapeRestoreState(const uint8_t* buffer);
 
+    // Disk controller state snapshot/restore (for time-travel scrubber)
+    // Format: 96 bytes — UPD765A (+3) at 0, Opus WD1770 at 64, unused parts zeroed
+    static constexpr uint32_t FDC_SNAPSHOT_SIZE = 96;
+    virtual void fdcSnapshotState(uint8_t* buffer) const;
+    virtual void fdcRestoreState(const uint8_t* buffer);
+
+    // Native machine state (see state_stream.hpp): one chunk per subsystem,
+    // covering everything the emulation runs on. Loaded media (tape blocks,
+    // disk images), host audio resampling and debugger settings are not
+    // included. A state only loads into the machine type that saved it; one
+    // that fails to load leaves the machine as it was. Enabled peripherals
+    // follow the state. compress stores the chunks LZ compressed.
+    void saveState(std::vector<uint8_t>& out, bool compress = false) const;
+    bool loadState(const uint8_t* data, uint32_t size);
+    // Machine id a state was saved from, or -1 if data isn't a state
+    static int stateMachineId(const uint8_t* data, uint32_t size);
+
+    // An independent copy of this machine, ready to run on from the same
+    // point: its state, inserted tape and disks, and the settings that
+    // affect emulation. RAM and ROM pages are shared copy-on-write with
+    // this machine, so forking copies no memory; each side copies a bank
+    // the first time it writes to it. Returns nullptr for the ZX81.
+    std::unique_ptr<ZXSpectrum> fork();
+
+    // RAM banks written since the last call, one bit per 16K bank of RAM,
+    // then cleared. Every bank starts dirty.
+    uint32_t takeDirtyRamBanks()
+    {
+        uint32_t dirty = dirtyRamBanks_;
+        dirtyRamBanks_ = 0;
+        return dirty;
+    }
+
     // Tape recording
     void tapeRecordStart() override;
     void tapeRecordStop() override;
@@ -256,11 +357,11 @@ public:
 
     int tapeGetBlockProgress() const
     {
-        if (tapePulseBlockStarts_.empty() || tapeBlockIndex_ >= tapePulseBlockStarts_.size())
+        if (tapeBlockIndex_ >= tapePulses_.blockStartCount())
             return 0;
-        size_t blockStart = tapePulseBlockStarts_[tapeBlockIndex_];
-        size_t blockEnd = (tapeBlockIndex_ + 1 < tapePulseBlockStarts_.size())
-            ? tapePulseBlockStarts_[tapeBlockIndex_ + 1]
+        size_t blockStart = tapePulses_.blockStart(tapeBlockIndex_);
+        size_t blockEnd = (tapeBlockIndex_ + 1 < tapePulses_.blockStartCount())
+            ? tapePulses_.blockStart(tapeBlockIndex_ + 1)
             : tapePulses_.size();
         size_t blockLen = blockEnd - blockStart;
         if (blockLen == 0) return 100;
@@ -279,11 +380,16 @@ public:
     virtual uint8_t coreDebugRead(uint16_t address) const = 0;
     virtual void coreDebugWrite(uint16_t address, uint8_t data) = 0;
 
-    // Screen memory access for display rendering (variant provides pointer)
+    // Screen memory access for display rendering (variant provides pointer).
+    // The writable form unshares a forked screen bank, so drawing reads
+    // through screenMemory().
     virtual uint8_t* getScreenMemory() = 0;
     virtual const uint8_t* getScreenMemory() const = 0;
+    const uint8_t* screenMemory() const { return getScreenMemory(); }
 
-    // Auto-patch screen when UDG memory is written
+    // Auto-patch screen when UDG memory is written. An editor convenience,
+    // not emulation: the memory write paths only call it while
+    // getUdgScreenPatching() is set by an open UDG editor.
     void patchScreenForUdgWrite(uint16_t address, uint8_t oldValue, uint8_t newValue);
 
     // Remembered screen positions (row*32+col) for each UDG, used when old pattern is all-zero
@@ -314,11 +420,100 @@ protected:
     // Called by variant's init() after setting machineInfo_
     void baseInit();
 
+    // Chunks for variant hardware beyond the base machine. loadVariantChunk()
+    // returns false for a bad chunk and true for one it doesn't know.
+    virtual void saveVariantState(StateWriter& /*writer*/) const {}
+    virtual bool loadVariantChunk(StateReader& /*reader*/) { return true; }
+    // readState() leaves the machine part loaded if a chunk fails
+    void writeState(StateWriter& writer, bool forking) const;
+    bool readState(const uint8_t* data, uint32_t size, bool forking);
+
+    // A new, uninitialised machine of the same variant, and the variant's
+    // part of a fork (media and settings beyond the base machine)
+    virtual std::unique_ptr<ZXSpectrum> newInstance() const = 0;
+    virtual void forkVariant(ZXSpectrum& /*copy*/) const {}
+
+    // Rebuild the variant's page tables after RAM pages were shared or
+    // replaced (see memory_pages.hpp)
+    virtual void remapMemory() {}
+
+    // Compile-time Z80 bus for a concrete variant. Each variant binds
+    // CpuBus<Self> after baseInit() so memory, IO and contention calls are
+    // qualified (non-virtual) calls into the variant's core* overrides
+    // instead of std::function -> static callback -> virtual dispatch.
+    template <typename Variant>
+    struct CpuBus {
+        static uint8_t memRead(uint16_t addr, void* param)
+        {
+            auto* self = static_cast<Variant*>(param);
+            if (self->accessTrackingEnabled_) self->accessFlags_[addr] |= 0x02;
+            return self->Variant::coreMemoryRead(addr);
+        }
+        static void memWrite(uint16_t addr, uint8_t data, void* param)
+        {
+            auto* self = static_cast<Variant*>(param);
+            if (self->accessTrackingEnabled_) self->accessFlags_[addr] |= 0x01;
+            self->Variant::coreMemoryWrite(addr, data);
+        }
+        static uint8_t ioRead(uint16_t addr, void* param)
+        {
+            return static_cast<Variant*>(param)->Variant::coreIORead(addr);
+        }
+        static void ioWrite(uint16_t addr, uint8_t data, void* param)
+        {
+            auto* self = static_cast<Variant*>(param);
+            self->specdrumWrite(addr, data);
+            self->Variant::coreIOWrite(addr, data);
+        }
+        static void contention(uint16_t addr, uint32_t ts, void* param)
+        {
+            ZXSPEC_PROFILE_SCOPE(Contention);
+            static_cast<Variant*>(param)->Variant::coreMemoryContention(addr, ts);
+        }
+        static void noMreqContention(uint16_t addr, uint32_t ts, void* param)
+        {
+            ZXSPEC_PROFILE_SCOPE(Contention);
+            static_cast<Variant*>(param)->Variant::coreNoMreqContention(addr, ts);
+        }
+    };
+
+    // SpecDrum DAC: all ports ending in 0xDF
+    void specdrumWrite(uint16_t addr, uint8_t data)
+    {
+        if (specdrumEnabled_ && (addr & 0xFF) == 0xDF)
+        {
+            syncPeripherals();
+            audio_.setSpecdrumLevel(((static_cast<float>(data) / 255.0f) * 2.0f - 1.0f) * 0.5f);
+        }
+    }
+
+    // Batch execution: bring the beeper, AY and SP0256 up to the start of the
+    // instruction currently executing. Variants call this before any access
+    // that changes (or reads) audio device state, so the change takes effect
+    // at the same instruction boundary as in the per-instruction loop.
+    void syncPeripherals()
+    {
+        if (peripheralCatchUp_) catchUpPeripherals(z80_->getInstructionStartTStates());
+    }
+    void catchUpPeripherals(uint32_t ts);
+    uint32_t nextTapeEdgeTs() const;
+
+    // Run the CPU to endTs (at most the frame end) the way runFrame() does,
+    // stopping early if a breakpoint pauses the machine
+    void runToTStates(uint32_t endTs);
+    void runInstantLoad(uint32_t endTs);
+    void runFrameBatched(uint32_t endTs);
+    void runFramePerInstruction(uint32_t endTs);
+    void mixAudioFrame();
+    void setSkippingFrames(bool skipping);
+    void updateResampling();
+
     // Opcode callback support
     virtual void installOpcodeCallback();
     virtual bool handleTapeTrap(uint16_t address);
     bool handleSaveTrap();
     void advanceTape(uint32_t tstates);
+    void skipTapeEdgeLoop(uint8_t opcode, uint16_t address);
 
     // Machine configuration
     MachineInfo machineInfo_{};
@@ -335,7 +530,16 @@ protected:
 
     // AY sound chip state
     bool ayEnabled_ = false;
-    int ayMixOffset_ = 0;
+
+    // Mixes every source into the mono and stereo outputs at frame end;
+    // mixOffset_ is the beeper sample count at the previous mix
+    AudioMixer mixer_;
+    int mixOffset_ = 0;
+
+    // Output rate conversion, active when resampling_ is set
+    Resampler monoResampler_;
+    Resampler stereoResampler_;
+    bool resampling_ = false;
 
     // SpecDrum 8-bit DAC
     bool specdrumEnabled_ = false;
@@ -352,11 +556,41 @@ protected:
     // Currah uSpeech speech synthesiser
     CurrahSpeech currahSpeech_;
     bool currahSpeechEnabled_ = false;
-    int currahMixOffset_ = 0;
 
-    // Memory (allocated by base, managed by variant)
-    std::vector<uint8_t> memoryRom_;
-    std::vector<uint8_t> memoryRam_;
+    // Input journal (see setInputJournalEnabled)
+    InputJournal inputJournal_;
+    bool inputJournalEnabled_ = false;
+    bool replayingInput_ = false;
+    void journalInput(InputJournal::EventType type, uint8_t a = 0, uint8_t b = 0)
+    {
+        if (inputJournalEnabled_ && !replayingInput_)
+            inputJournal_.record(frameCounter_, z80_->getTStates(), type, a, b);
+    }
+    void applyInput(const InputJournal::Event& event);
+
+    // Memory (allocated by base, managed by variant) in 16K pages that
+    // forks share until written
+    MemoryPages memoryRom_;
+    MemoryPages memoryRam_;
+
+    // Variants mark the bank behind a write page on every RAM write
+    uint32_t dirtyRamBanks_ = ~0u;
+    void markRamDirty(uint32_t bank) { dirtyRamBanks_ |= 1u << bank; }
+
+    // Page-table entry for writes to a RAM bank: null while it is shared
+    uint8_t* ramWritePage(uint32_t bank)
+    {
+        return memoryRam_.isShared(bank) ? nullptr : memoryRam_.writable(bank);
+    }
+
+    // A RAM bank to write to outside the page tables, unshared first
+    uint8_t* ramBankForWrite(uint32_t bank)
+    {
+        bool shared = memoryRam_.isShared(bank);
+        uint8_t* page = memoryRam_.writable(bank);
+        if (shared) remapMemory();
+        return page;
+    }
 
     // Keyboard matrix: 8 half-rows, bits 0-4 active LOW (0 = pressed)
     std::array<uint8_t, 8> keyboardMatrix_{};
@@ -372,6 +606,12 @@ protected:
     // Execution state
     bool paused_ = false;
     bool tapeAccelerating_ = false;
+    bool batchExecution_ = true;
+    bool peripheralCatchUp_ = false;   // true while runFrameBatched() is executing
+    uint32_t peripheralTs_ = 0;        // T-state the audio devices have been advanced to
+    bool turboSkipDisplay_ = false;    // true for frames turbo or replay never shows or plays
+    double frameRate_ = 0.0;           // Emulated frames per second
+    double turboSpeed_ = 0.0;
 
     // Breakpoint support
     std::set<uint16_t> breakpoints_;
@@ -415,10 +655,10 @@ protected:
     std::vector<TapeBlock> tapeBlocks_;
     size_t tapeBlockIndex_ = 0;
     bool tapeActive_ = false;
+    uint32_t tapeChanges_ = 0;
 
-    // Pulse playback for EAR bit
-    std::vector<uint32_t> tapePulses_;
-    std::vector<size_t> tapePulseBlockStarts_;
+    // Pulse playback for EAR bit (decoded from tapeBlocks_ as it plays)
+    TapePulseStream tapePulses_;
     size_t tapePulseIndex_ = 0;
     uint32_t tapePulseRemaining_ = 0;
     bool tapeEarLevel_ = false;
@@ -432,6 +672,15 @@ protected:
     // Instant load mode (ROM trap) vs normal speed (EAR bit pulses)
     bool tapeInstantLoad_ = false;
 
+    // Edge-loop skipping: the last loop counter update (INC B, DEC B,
+    // DEC A or DJNZ) fetched while the tape was playing, and its state
+    bool tapeEdgeSkip_ = true;
+    uint16_t edgeLoopAddr_ = 0;
+    uint8_t edgeLoopCounter_ = 0;
+    uint32_t edgeLoopTs_ = 0;
+    uint32_t edgeLoopFrame_ = 0;
+    size_t edgeLoopPulse_ = SIZE_MAX;
+
     // SAVE-routine entry detector (one-shot, polled by JS to auto-start tape recording)
     bool saveStartTrapPending_ = false;
 
@@ -471,6 +720,9 @@ protected:
     uint8_t accessFlags_[65536] = {};
     bool accessTrackingEnabled_ = false;
 
+    // ---- UDG editor session (see setUdgScreenPatching()) ----
+    bool udgScreenPatching_ = false;
+
     // ---- CPU instruction trace ----
     static constexpr uint32_t TRACE_BUFFER_SIZE = 10000;
 
@@ -510,6 +762,11 @@ public:
 
     void setTraceEnabled(bool enabled);
     bool getTraceEnabled() const { return traceEnabled_; }
+
+    // UDG editor session: while enabled, writes to the UDG bitmaps also
+    // patch the screen cells showing them
+    void setUdgScreenPatching(bool enabled) { udgScreenPatching_ = enabled; }
+    bool getUdgScreenPatching() const { return udgScreenPatching_; }
     const TraceEntry* getTraceBuffer() const { return traceBuffer_.data(); }
     uint32_t getTraceWriteIndex() const { return traceWriteIndex_; }
     uint32_t getTraceEntryCount() const { return traceEntryCount_; }
@@ -19,15 +19,16 @@ void ZXSpectrumPlus2::init()
 
     // Base class allocates memory and wires up Z80
     baseInit();
+    z80_->bindBus<CpuBus<ZXSpectrumPlus2>>(this);
 
     // Load +2 ROMs (ROM 0 = 128K editor, ROM 1 = 48K BASIC)
     if (roms::ROM_PLUS2_0_SIZE > 0 && roms::ROM_PLUS2_0_SIZE <= MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_PLUS2_0, roms::ROM_PLUS2_0_SIZE);
+        std::memcpy(memoryRom_.writable(0), roms::ROM_PLUS2_0, roms::ROM_PLUS2_0_SIZE);
     }
     if (roms::ROM_PLUS2_1_SIZE > 0 && roms::ROM_PLUS2_1_SIZE <= MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data() + MEM_PAGE_SIZE, roms::ROM_PLUS2_1, roms::ROM_PLUS2_1_SIZE);
+        std::memcpy(memoryRom_.writable(1), roms::ROM_PLUS2_1, roms::ROM_PLUS2_1_SIZE);
     }
 
     // Load Spectranet ROM into flash if available
@@ -40,6 +41,11 @@ void ZXSpectrumPlus2::init()
     setPagingRegister(0);
 }
 
+std::unique_ptr<ZXSpectrum> ZXSpectrumPlus2::newInstance() const
+{
+    return std::make_unique<ZXSpectrumPlus2>();
+}
+
 void ZXSpectrumPlus2::reloadSpectranetROM()
 {
     if (roms::ROM_SPECTRANET_SIZE > 0) {
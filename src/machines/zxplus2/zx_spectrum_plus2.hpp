@@ -20,6 +20,9 @@ public:
     void reloadSpectranetROM() override;
     void reloadOpusROM() override {}
     void reloadCurrahSpeechROM() override {}
+
+protected:
+    std::unique_ptr<ZXSpectrum> newInstance() const override;
 };
 
 } // namespace zxspec::zxplus2
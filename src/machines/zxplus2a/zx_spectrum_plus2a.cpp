@@ -43,11 +43,12 @@ void ZXSpectrumPlus2A::init()
 
     // Base class allocates memory and wires up Z80
     baseInit();
+    z80_->bindBus<CpuBus<ZXSpectrumPlus2A>>(this);
 
     // Load all 4 ROM banks (64KB total)
     if (roms::ROM_PLUS2A_SIZE > 0 && roms::ROM_PLUS2A_SIZE <= 4 * MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_PLUS2A, roms::ROM_PLUS2A_SIZE);
+        memoryRom_.write(0, roms::ROM_PLUS2A, static_cast<uint32_t>(roms::ROM_PLUS2A_SIZE));
     }
 
     // Load Spectranet ROM into flash if available
@@ -112,9 +113,7 @@ void ZXSpectrumPlus2A::updatePaging()
         uint8_t config = (pagingRegister1FFD_ >> 1) & 0x03;
         for (int slot = 0; slot < 4; slot++)
         {
-            uint8_t bank = specialConfigs[config][slot];
-            pageRead_[slot] = &memoryRam_[bank * MEM_PAGE_SIZE];
-            pageWrite_[slot] = &memoryRam_[bank * MEM_PAGE_SIZE];
+            mapRamBank(slot, specialConfigs[config][slot]);
         }
     }
     else
@@ -122,22 +121,38 @@ void ZXSpectrumPlus2A::updatePaging()
         // Normal paging mode
         // ROM select: 0x7FFD bit 4 (low bit) + 0x1FFD bit 2 (high bit)
         uint8_t romBank = ((pagingRegister_ & 0x10) >> 4) | ((pagingRegister1FFD_ & 0x04) >> 1);
-        pageRead_[0] = memoryRom_.data() + (romBank * MEM_PAGE_SIZE);
+        pageRead_[0] = memoryRom_.page(romBank);
         pageWrite_[0] = nullptr;  // ROM is read-only
+        pageBank_[0] = -1;
 
-        // Slot 1: always RAM bank 5
-        pageRead_[1] = &memoryRam_[5 * MEM_PAGE_SIZE];
-        pageWrite_[1] = &memoryRam_[5 * MEM_PAGE_SIZE];
+        // Slot 1: always RAM bank 5; slot 2: always RAM bank 2; slot 3:
+        // RAM bank selected by 0x7FFD bits 0-2
+        mapRamBank(1, 5);
+        mapRamBank(2, 2);
+        mapRamBank(3, pagingRegister_ & 0x07);
+    }
+}
 
-        // Slot 2: always RAM bank 2
-        pageRead_[2] = &memoryRam_[2 * MEM_PAGE_SIZE];
-        pageWrite_[2] = &memoryRam_[2 * MEM_PAGE_SIZE];
+void ZXSpectrumPlus2A::mapRamBank(int slot, uint8_t bank)
+{
+    pageRead_[slot] = memoryRam_.page(bank);
+    pageWrite_[slot] = ramWritePage(bank);
+    pageBank_[slot] = static_cast<int8_t>(bank);
+}
 
-        // Slot 3: RAM bank selected by 0x7FFD bits 0-2
-        uint8_t ramBank = pagingRegister_ & 0x07;
-        pageRead_[3] = &memoryRam_[ramBank * MEM_PAGE_SIZE];
-        pageWrite_[3] = &memoryRam_[ramBank * MEM_PAGE_SIZE];
-    }
+// A null write page is ROM, or a RAM bank shared with a fork: copy the
+// bank and point the tables at the copy
+bool ZXSpectrumPlus2A::copyOnWrite(int slot)
+{
+    if (pageBank_[slot] < 0) return false;
+    memoryRam_.writable(pageBank_[slot]);
+    updatePaging();
+    return true;
+}
+
+std::unique_ptr<ZXSpectrum> ZXSpectrumPlus2A::newInstance() const
+{
+    return std::make_unique<ZXSpectrumPlus2A>();
 }
 
 void ZXSpectrumPlus2A::setPagingRegister(uint8_t value)
@@ -158,7 +173,9 @@ void ZXSpectrumPlus2A::writeRamBank(uint8_t bank, uint16_t offset, uint8_t data)
 {
     if (bank < 8 && offset < MEM_PAGE_SIZE)
     {
-        memoryRam_[bank * MEM_PAGE_SIZE + offset] = data;
+        markRamDirty(bank);
+        ramBankForWrite(bank)[offset] = data;
+        if (memoryRam_.page(bank) == screenMemory()) display_.markScreenWrite(offset);
     }
 }
 
@@ -191,13 +208,13 @@ uint8_t* ZXSpectrumPlus2A::getScreenMemory()
     // The ULA always reads from bank 5 or 7 regardless of special paging mode.
     // Special paging only affects the CPU's memory map, not the ULA's screen fetch.
     uint8_t screenBank = (pagingRegister_ & 0x08) ? 7 : 5;
-    return &memoryRam_[screenBank * MEM_PAGE_SIZE];
+    return ramBankForWrite(screenBank);
 }
 
 const uint8_t* ZXSpectrumPlus2A::getScreenMemory() const
 {
     uint8_t screenBank = (pagingRegister_ & 0x08) ? 7 : 5;
-    return &memoryRam_[screenBank * MEM_PAGE_SIZE];
+    return memoryRam_.page(screenBank);
 }
 
 // ============================================================================
@@ -226,16 +243,23 @@ void ZXSpectrumPlus2A::coreMemoryWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (!pageWrite_[slot]) return;  // ROM protection
+    if (!pageWrite_[slot] && !copyOnWrite(slot)) return;  // ROM protection
+    markRamDirty(pageBank_[slot]);
 
     // Catch up display before any write to the current screen bank.
     // In special paging the screen bank varies by config, and in normal
-    // paging with screen=bank 7 the write may come through slot 3.
-    if (!tapeAccelerating_ && pageWrite_[slot] == getScreenMemory())
+    // paging with screen=bank 7 the write may come through slot 3. The
+    // display also notes the write so the lines showing it are compared.
+    if (pageRead_[slot] == screenMemory())
     {
-        display_.updateWithTs(
-            static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.paperDrawingOffset),
-            getScreenMemory(), borderColor_, frameCounter_);
+        uint32_t targetTs = z80_->getTStates() + machineInfo_.paperDrawingOffset;
+        if (!tapeAccelerating_ && display_.isCellPending(address & 0x3FFF, targetTs))
+        {
+            display_.updateWithTs(
+                static_cast<int32_t>(targetTs - display_.getCurrentDisplayTs()),
+                screenMemory(), borderColor_, frameCounter_);
+        }
+        display_.markScreenWrite(address & 0x3FFF);
     }
 
     pageWrite_[slot][address & 0x3FFF] = data;
@@ -265,9 +289,11 @@ void ZXSpectrumPlus2A::coreDebugWrite(uint16_t address, uint8_t data)
         return;
     }
 
-    if (pageWrite_[slot])
+    if (pageWrite_[slot] || copyOnWrite(slot))
     {
+        markRamDirty(pageBank_[slot]);
         pageWrite_[slot][address & 0x3FFF] = data;
+        if (pageRead_[slot] == screenMemory()) display_.markScreenWrite(address & 0x3FFF);
     }
 }
 
@@ -462,7 +488,7 @@ void ZXSpectrumPlus2A::coreIOWrite(uint16_t address, uint8_t data)
         {
             display_.updateWithTs(
                 static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
         pagingRegister_ = data;
         if (data & 0x20) pagingDisabled_ = true;
@@ -484,6 +510,7 @@ void ZXSpectrumPlus2A::coreIOWrite(uint16_t address, uint8_t data)
     }
     if ((address & 0xC002) == 0x8000)
     {
+        syncPeripherals();
         ay_.writeData(data);
     }
 
@@ -494,8 +521,9 @@ void ZXSpectrumPlus2A::coreIOWrite(uint16_t address, uint8_t data)
         {
             display_.updateWithTs(
                 static_cast<int32_t>((z80_->getTStates() - display_.getCurrentDisplayTs()) + machineInfo_.borderDrawingOffset),
-                getScreenMemory(), borderColor_, frameCounter_);
+                screenMemory(), borderColor_, frameCounter_);
         }
+        syncPeripherals();
         audio_.setEarBit((data >> 4) & 1);
         audio_.setMicBit((data >> 3) & 1);
         if (tapeRecording_) {
@@ -22,11 +22,12 @@ void ZXSpectrumPlus3::init()
 
     // Base class allocates memory and wires up Z80
     baseInit();
+    z80_->bindBus<CpuBus<ZXSpectrumPlus3>>(this);
 
     // Load all 4 ROM banks (64KB total)
     if (roms::ROM_PLUS3_SIZE > 0 && roms::ROM_PLUS3_SIZE <= 4 * MEM_PAGE_SIZE)
     {
-        std::memcpy(memoryRom_.data(), roms::ROM_PLUS3, roms::ROM_PLUS3_SIZE);
+        memoryRom_.write(0, roms::ROM_PLUS3, static_cast<uint32_t>(roms::ROM_PLUS3_SIZE));
     }
 
     // Load Spectranet ROM into flash if available
@@ -53,6 +54,46 @@ void ZXSpectrumPlus3::reset()
     fdc_.insertDisk(1, &diskB_);
 }
 
+void ZXSpectrumPlus3::fdcSnapshotState(uint8_t* buffer) const
+{
+    zxplus2a::ZXSpectrumPlus2A::fdcSnapshotState(buffer);
+    fdc_.snapshotState(buffer);
+}
+
+void ZXSpectrumPlus3::fdcRestoreState(const uint8_t* buffer)
+{
+    zxplus2a::ZXSpectrumPlus2A::fdcRestoreState(buffer);
+    fdc_.restoreState(buffer);
+}
+
+static constexpr uint32_t CHUNK_FDC = stateChunkId("FDC ");
+
+void ZXSpectrumPlus3::saveVariantState(StateWriter& writer) const
+{
+    writer.beginChunk(CHUNK_FDC, 1);
+    fdc_.saveState(writer);
+    writer.endChunk();
+}
+
+bool ZXSpectrumPlus3::loadVariantChunk(StateReader& reader)
+{
+    if (reader.id() != CHUNK_FDC) return true;
+    return reader.version() == 1 && fdc_.loadState(reader);
+}
+
+std::unique_ptr<ZXSpectrum> ZXSpectrumPlus3::newInstance() const
+{
+    return std::make_unique<ZXSpectrumPlus3>();
+}
+
+void ZXSpectrumPlus3::forkVariant(ZXSpectrum& copy) const
+{
+    // The copy's controller already points at its own drives
+    auto& plus3 = static_cast<ZXSpectrumPlus3&>(copy);
+    plus3.diskA_ = diskA_;
+    plus3.diskB_ = diskB_;
+}
+
 void ZXSpectrumPlus3::reloadSpectranetROM()
 {
     if (roms::ROM_SPECTRANET_SIZE > 0) {
@@ -39,6 +39,8 @@ public:
     // Disk drive interface
     UPD765A& getFDC() { return fdc_; }
     const UPD765A& getFDC() const { return fdc_; }
+    void fdcSnapshotState(uint8_t* buffer) const override;
+    void fdcRestoreState(const uint8_t* buffer) override;
 
     // Disk image management
     void insertDisk(int drive, const uint8_t* data, uint32_t size);
@@ -53,6 +55,15 @@ public:
     const uint8_t* exportDiskData(int drive);
     uint32_t exportDiskDataSize(int drive) const;
 
+protected:
+    // Adds an 'FDC ' chunk holding the controller state
+    void saveVariantState(StateWriter& writer) const override;
+    bool loadVariantChunk(StateReader& reader) override;
+
+    std::unique_ptr<ZXSpectrum> newInstance() const override;
+    // Gives the fork copies of the inserted disks
+    void forkVariant(ZXSpectrum& copy) const override;
+
 private:
     UPD765A fdc_;
     DiskImage diskA_;
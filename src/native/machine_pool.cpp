@@ -0,0 +1,209 @@
+/*
+ * machine_pool.cpp - Parallel frame scheduler for many independent machines
+ */
+
+#include "machine_pool.hpp"
+#include <algorithm>
+
+namespace zxspec {
+
+// Set on the middle index of a slot's triple buffer when it holds output
+// the reader has not seen yet
+static constexpr int kFreshBit = 4;
+
+MachinePool::MachinePool(unsigned threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers_.emplace_back(&MachinePool::workerLoop, this, i);
+    }
+}
+
+MachinePool::~MachinePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(batchMutex_);
+        stopping_ = true;
+    }
+    batchStart_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t MachinePool::add(std::unique_ptr<ZXSpectrum> machine)
+{
+    auto slot = std::make_unique<Slot>();
+    slot->machine = std::move(machine);
+    machines_.push_back(std::move(slot));
+    return machines_.size() - 1;
+}
+
+// ============================================================================
+// Batch execution
+// ============================================================================
+
+void MachinePool::run(uint32_t frames, uint32_t framesPerTask)
+{
+    if (frames == 0 || machines_.empty()) return;
+    framesPerTask_ = std::max(1u, framesPerTask);
+
+    // Deal the machines out round-robin; stealing evens out the rest
+    for (size_t i = 0; i < machines_.size(); i++) {
+        machines_[i]->framesRemaining = frames;
+        WorkerQueue& queue = *queues_[i % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.runnable.push_back(i);
+    }
+
+    std::unique_lock<std::mutex> lock(batchMutex_);
+    machinesPending_ = machines_.size();
+    machinesUnclaimed_ = machines_.size();
+    batchStart_.notify_all();
+    batchDone_.wait(lock, [this] { return machinesPending_ == 0; });
+}
+
+void MachinePool::workerLoop(unsigned id)
+{
+    for (;;)
+    {
+        // Sleep until there is a machine no other worker has claimed
+        {
+            std::unique_lock<std::mutex> lock(batchMutex_);
+            batchStart_.wait(lock, [this] { return stopping_ || machinesUnclaimed_ > 0; });
+            if (stopping_) return;
+            machinesUnclaimed_--;
+        }
+
+        // The claim covers one queue entry until a machine finishes the
+        // batch; a requeued machine keeps it, so no other worker is woken.
+        // The entry may be in any deque and a scan can pass one that is
+        // moving; it lands again through a requeue, so a failed take
+        // sleeps until requeues_ moves past the value seen before the scan.
+        bool requeued = true;
+        while (requeued) {
+            uint64_t seen;
+            {
+                std::lock_guard<std::mutex> lock(batchMutex_);
+                seen = requeues_;
+            }
+            size_t index;
+            if (takeTask(id, index)) {
+                requeued = runTask(id, index);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(batchMutex_);
+            taskQueued_.wait(lock, [this, seen] { return requeues_ != seen; });
+        }
+    }
+}
+
+bool MachinePool::takeTask(unsigned id, size_t& index)
+{
+    // Own queue first, oldest entry first
+    {
+        WorkerQueue& own = *queues_[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.runnable.empty()) {
+            index = own.runnable.front();
+            own.runnable.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the newest entry from the next non-empty queue
+    for (size_t n = 1; n < queues_.size(); n++) {
+        WorkerQueue& victim = *queues_[(id + n) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.runnable.empty()) {
+            index = victim.runnable.back();
+            victim.runnable.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MachinePool::runTask(unsigned id, size_t index)
+{
+    Slot& slot = *machines_[index];
+    ZXSpectrum& m = *slot.machine;
+    FrameOutput& out = slot.buffers[slot.back];
+
+    uint32_t count = std::min(framesPerTask_, slot.framesRemaining);
+    out.audio.clear();
+    out.stereoAudio.clear();
+
+    for (uint32_t i = 0; i < count; i++) {
+        m.runFrame();
+        slot.framesRun++;
+
+        const float* samples = m.getAudioBuffer();
+        out.audio.insert(out.audio.end(), samples, samples + m.getAudioSampleCount());
+        if (const float* frames = m.getStereoAudioBuffer()) {
+            out.stereoAudio.insert(out.stereoAudio.end(), frames, frames + m.getStereoAudioFrameCount() * 2);
+        }
+        m.resetAudioBuffer();
+
+        if (frameCallback_) frameCallback_(index, m);
+    }
+    slot.framesRemaining -= count;
+    publish(slot);
+
+    if (slot.framesRemaining > 0) {
+        // Back of our own queue so every machine advances at a similar pace
+        {
+            WorkerQueue& own = *queues_[id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.runnable.push_back(index);
+        }
+        {
+            std::lock_guard<std::mutex> lock(batchMutex_);
+            requeues_++;
+        }
+        taskQueued_.notify_all();
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(batchMutex_);
+    if (--machinesPending_ == 0) {
+        batchDone_.notify_all();
+    }
+    return false;
+}
+
+// ============================================================================
+// Output hand-off
+// ============================================================================
+
+void MachinePool::publish(Slot& slot)
+{
+    FrameOutput& out = slot.buffers[slot.back];
+    const uint8_t* fb = slot.machine->getFramebuffer();
+    out.framebuffer.assign(fb, fb + slot.machine->getFramebufferSize());
+    out.frame = slot.framesRun;
+
+    slot.back = slot.middle.exchange(slot.back | kFreshBit) & 3;
+}
+
+bool MachinePool::latestOutput(size_t index, FrameOutput& out)
+{
+    Slot& slot = *machines_[index];
+    if ((slot.middle.load() & kFreshBit) == 0) return false;
+
+    slot.front = slot.middle.exchange(slot.front) & 3;
+    const FrameOutput& src = slot.buffers[slot.front];
+    out.frame = src.frame;
+    out.framebuffer = src.framebuffer;
+    out.audio = src.audio;
+    out.stereoAudio = src.stereoAudio;
+    return true;
+}
+
+} // namespace zxspec
@@ -0,0 +1,119 @@
+/*
+ * machine_pool.hpp - Parallel frame scheduler for many independent machines
+ *
+ * Native-only (uses std::thread; not part of the WASM build). Owns a set of
+ * machines and a fixed pool of worker threads. run() advances every machine
+ * by the requested number of frames, split into tasks of framesPerTask
+ * frames. Each worker keeps a deque of runnable machines: it pops from the
+ * front of its own deque and, when that is empty, steals from the back of
+ * another worker's. A machine is only ever in one deque at a time, so its
+ * frames always run in order on one thread at a time, and machines share
+ * nothing mutable, so throughput scales with the core count.
+ *
+ * After each task the worker publishes the machine's framebuffer and the
+ * audio produced during the task into a per-machine triple buffer. A reader
+ * on any thread (one per machine at a time) picks up the newest published
+ * output with latestOutput() without ever waiting for a worker; older
+ * outputs are replaced, not queued.
+ */
+
+#pragma once
+
+#include "../machines/zx_spectrum.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace zxspec {
+
+class MachinePool {
+public:
+    // Snapshot of a machine's output at the end of a task
+    struct FrameOutput {
+        uint64_t frame = 0;                 // Frames run by this pool when taken
+        std::vector<uint8_t> framebuffer;   // RGBA, as Machine::getFramebuffer()
+        std::vector<float> audio;           // All samples produced during the task
+        std::vector<float> stereoAudio;     // The same, as interleaved L/R frames (if enabled)
+    };
+
+    // Called on the worker thread after every frame a machine runs (index, machine)
+    using FrameCallback = std::function<void(size_t, ZXSpectrum&)>;
+
+    // threadCount 0 = one worker per hardware thread
+    explicit MachinePool(unsigned threadCount = 0);
+    ~MachinePool();
+
+    MachinePool(const MachinePool&) = delete;
+    MachinePool& operator=(const MachinePool&) = delete;
+
+    // Takes ownership; returns the machine's index. Not allowed during run().
+    size_t add(std::unique_ptr<ZXSpectrum> machine);
+
+    size_t size() const { return machines_.size(); }
+    unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Direct access for set-up and inspection between runs
+    ZXSpectrum& machine(size_t index) { return *machines_[index]->machine; }
+
+    void setFrameCallback(FrameCallback callback) { frameCallback_ = std::move(callback); }
+
+    // Advance every machine by frames, framesPerTask at a time. Blocks the
+    // calling thread until all machines are done.
+    void run(uint32_t frames, uint32_t framesPerTask = 1);
+
+    // Copy the newest output published for a machine into out. Returns false
+    // if nothing new has been published since the last call. Never blocks.
+    bool latestOutput(size_t index, FrameOutput& out);
+
+private:
+    struct Slot {
+        std::unique_ptr<ZXSpectrum> machine;
+        uint32_t framesRemaining = 0;
+        uint64_t framesRun = 0;
+
+        // Triple buffer: the worker fills buffers[back], then swaps it with
+        // the shared middle index (bit 2 = fresh); readers swap front with
+        // middle when it is fresh
+        FrameOutput buffers[3];
+        int back = 0;
+        int front = 1;
+        std::atomic<int> middle{2};
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> runnable;
+    };
+
+    void workerLoop(unsigned id);
+    bool takeTask(unsigned id, size_t& index);
+    bool runTask(unsigned id, size_t index);    // true if the machine was requeued
+    void publish(Slot& slot);
+
+    std::vector<std::unique_ptr<Slot>> machines_;
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    FrameCallback frameCallback_;
+    uint32_t framesPerTask_ = 1;
+
+    // Batch hand-off between run() and the workers. Idle workers sleep on
+    // batchStart_ until a queued machine is unclaimed; run() sleeps on
+    // batchDone_ until every machine has finished. A worker whose scan
+    // missed a moving entry sleeps on taskQueued_ until requeues_ changes.
+    std::mutex batchMutex_;
+    std::condition_variable batchStart_;
+    std::condition_variable batchDone_;
+    std::condition_variable taskQueued_;
+    uint64_t requeues_ = 0;
+    size_t machinesPending_ = 0;
+    size_t machinesUnclaimed_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace zxspec
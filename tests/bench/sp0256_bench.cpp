@@ -0,0 +1,114 @@
+/*
+ * sp0256_bench.cpp - SP0256 exact synthesis vs cached allophone throughput
+ *
+ * Feeds the same allophone stream to two SP0256 chips, one running the
+ * micro-sequencer and LPC filter live (exact mode) and one replaying
+ * cached allophones, stepping both in instruction-sized T-state chunks as
+ * the machines do. Reports the time per emulated second for each mode and
+ * how far the cached output strays from the exact output (it differs only
+ * where unvoiced allophones restart the noise LFSR).
+ *
+ * Usage: sp0256_bench [emulated seconds]   (default 60)
+ */
+
+#include "currah/sp0256.hpp"
+#include "roms.cpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using zxspec::SP0256;
+
+static constexpr int kTsPerFrame = 69888;
+static constexpr double kFramesPerSecond = 3500000.0 / kTsPerFrame;
+
+// "HELLO WORLD", a pause, then every allophone in turn
+static std::vector<uint8_t> makeScript()
+{
+    std::vector<uint8_t> script = { 27, 7, 45, 53, 2, 46, 51, 45, 21, 4 };
+    for (uint8_t a = 0; a < SP0256::NUM_ALLOPHONES; a++) {
+        script.push_back(a);
+    }
+    return script;
+}
+
+struct RunResult {
+    double seconds = 0.0;
+    std::vector<float> output;
+};
+
+static RunResult run(bool cached, int frames)
+{
+    auto chip = std::make_unique<SP0256>();
+    chip->loadROM(roms::ROM_SP0256_AL2, static_cast<uint32_t>(roms::ROM_SP0256_AL2_SIZE));
+    chip->setup(48000, kFramesPerSecond, kTsPerFrame);
+    chip->setCachedMode(cached);
+
+    const std::vector<uint8_t> script = makeScript();
+    size_t next = 0;
+
+    RunResult result;
+    result.output.reserve(static_cast<size_t>(frames) * 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        // 4-23 T-state steps, a rough instruction mix
+        uint32_t step = 7;
+        for (int32_t ts = 0; ts < kTsPerFrame; ) {
+            if (!chip->isBusy()) {
+                chip->writeAllophone(script[next]);
+                next = (next + 1) % script.size();
+            }
+            int32_t delta = 4 + static_cast<int32_t>(step % 20);
+            step = step * 1103515245u + 12345u;
+            chip->update(delta);
+            ts += delta;
+        }
+        chip->frameEnd();
+        const float* buf = chip->getBuffer();
+        result.output.insert(result.output.end(), buf, buf + chip->getSampleCount());
+        chip->resetBuffer();
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    double emulated = 60.0;
+    if (argc > 1) {
+        emulated = std::strtod(argv[1], nullptr);
+    }
+    int frames = static_cast<int>(emulated * kFramesPerSecond);
+
+    RunResult exact = run(false, frames);
+    RunResult cached = run(true, frames);
+
+    size_t count = std::min(exact.output.size(), cached.output.size());
+    double maxDiff = 0.0;
+    double sumSq = 0.0;
+    size_t identical = 0;
+    for (size_t i = 0; i < count; i++) {
+        double d = std::fabs(static_cast<double>(exact.output[i]) - cached.output[i]);
+        maxDiff = std::max(maxDiff, d);
+        sumSq += d * d;
+        identical += (d == 0.0) ? 1 : 0;
+    }
+
+    std::printf("Emulated time:       %.1f s (%d frames)\n", emulated, frames);
+    std::printf("Exact synthesis:     %.3f s  (%.1f us per emulated second)\n",
+                exact.seconds, exact.seconds / emulated * 1e6);
+    std::printf("Cached allophones:   %.3f s  (%.1f us per emulated second)\n",
+                cached.seconds, cached.seconds / emulated * 1e6);
+    std::printf("Speed-up:            %.1fx\n", exact.seconds / cached.seconds);
+    std::printf("Samples:             %zu exact, %zu cached\n", exact.output.size(), cached.output.size());
+    std::printf("Identical samples:   %.2f%%\n", count ? 100.0 * identical / count : 0.0);
+    std::printf("Max / RMS diff:      %.4f / %.6f\n", maxDiff, count ? std::sqrt(sumSq / count) : 0.0);
+    return 0;
+}
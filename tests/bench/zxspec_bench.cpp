@@ -0,0 +1,393 @@
+/*
+ * zxspec_bench.cpp - Headless whole-machine runner and frame throughput benchmark
+ *
+ * Boots a machine natively (ROMs embedded, no WASM bindings), optionally loads
+ * a snapshot or tape image, runs a fixed number of frames as fast as possible
+ * and reports frames/sec, Z80 MIPS and how the time divides between the CPU,
+ * display, audio and contention. Suitable for perf/valgrind.
+ *
+ * Usage: zxspec_bench [-m machine] [-f frames] [-w warmup] [-n machines] [-j threads] [-t turbo] [file]
+ *   -m  0=48K 1=128K 2=+2 3=+2A 4=+3 5=ZX81 (default: from the file, else 48K)
+ *   -f  frames to time (default 3000, one minute of emulated time)
+ *   -w  frames to run before timing (default 100, enough to boot the ROM)
+ *   -n  also run this many copies in parallel on a MachinePool (default 1: off)
+ *   -j  pool worker threads (default: one per hardware thread)
+ *   -t  also run the frames in turbo mode, this many per call (default 1: off)
+ *       (-n and -t are ignored by zxspec_bench_profile)
+ *   file  .z80 / .sna snapshot, .tap / .tzx tape (typed LOAD "" or Tape
+ *         Loader, played at normal speed through the EAR bit) or .p (ZX81)
+ *
+ * Built twice. zxspec_bench compiles the machines as shipped and reports the
+ * throughput figures. zxspec_bench_profile compiles them with ZXSPEC_PROFILE
+ * scopes and reports only the time split, with the measured cost of the timer
+ * calls removed; its run is never used for the headline numbers. The Z80
+ * counts instructions only in the profile build, so MIPS comes from there,
+ * taken over the CPU share of the split.
+ */
+
+#include "zx_spectrum_48k.hpp"
+#include "zx_spectrum_128k.hpp"
+#include "zx_spectrum_plus2.hpp"
+#include "zx_spectrum_plus2a.hpp"
+#include "zx_spectrum_plus3.hpp"
+#include "zx81.hpp"
+#include "../core/frame_profile.hpp"
+#include "../native/machine_pool.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace zxspec;
+
+namespace {
+
+constexpr double kZX81ClockHz = 3250000.0;
+
+enum class FileType { None, Z80, SNA, TAP, TZX, P };
+
+struct Options {
+    int machineId = -1;
+    int frames = 3000;
+    int warmup = 100;
+    int poolMachines = 1;
+    int poolThreads = 0;
+    int turboFrames = 1;
+    std::string path;
+    FileType type = FileType::None;
+    std::vector<uint8_t> data;
+};
+
+struct RunResult {
+    double seconds = 0.0;
+    uint64_t instructions = 0;
+    FrameProfile profile;
+};
+
+FileType fileTypeFor(const std::string& path)
+{
+    std::string ext = path.substr(path.find_last_of('.') + 1);
+    for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == "z80") return FileType::Z80;
+    if (ext == "sna") return FileType::SNA;
+    if (ext == "tap") return FileType::TAP;
+    if (ext == "tzx") return FileType::TZX;
+    if (ext == "p") return FileType::P;
+    return FileType::None;
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& out)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t got = out.empty() ? 0 : std::fread(out.data(), 1, out.size(), f);
+    std::fclose(f);
+    return got == out.size();
+}
+
+// Same rules as detectSnapshotMachine() in the WASM bindings
+int machineForSnapshot(FileType type, const std::vector<uint8_t>& d)
+{
+    if (type == FileType::SNA) {
+        return d.size() == 131103 ? 1 : 0;
+    }
+    if (type == FileType::Z80 && d.size() >= 35) {
+        if ((d[6] | (d[7] << 8)) != 0) return 0;
+        uint16_t extra = d[30] | (d[31] << 8);
+        uint8_t hw = d[34];
+        if (extra == 23) return (hw == 3 || hw == 4) ? 1 : 0;
+        if (hw == 4 || hw == 5 || hw == 6) return 1;
+        if (hw == 7 || hw == 8) return 4;
+        if (hw == 12) return 2;
+        if (hw == 13) return 3;
+        return 0;
+    }
+    if (type == FileType::P) return 5;
+    return 0;
+}
+
+std::unique_ptr<ZXSpectrum> createMachine(int id)
+{
+    switch (id) {
+        case 1: return std::make_unique<zx128k::ZXSpectrum128>();
+        case 2: return std::make_unique<zxplus2::ZXSpectrumPlus2>();
+        case 3: return std::make_unique<zxplus2a::ZXSpectrumPlus2A>();
+        case 4: return std::make_unique<zxplus3::ZXSpectrumPlus3>();
+        case 5: return std::make_unique<zx81::ZX81>();
+        default: return std::make_unique<zx48k::ZXSpectrum48>();
+    }
+}
+
+void runFrames(ZXSpectrum& m, int count)
+{
+    for (int i = 0; i < count; i++) {
+        m.runFrame();
+        m.resetAudioBuffer();
+    }
+}
+
+// Hold a key (row, bit) for a few frames, then release it
+void tapKey(ZXSpectrum& m, int row, int bit, int shiftRow = -1, int shiftBit = 0)
+{
+    if (shiftRow >= 0) m.keyDown(shiftRow, shiftBit);
+    m.keyDown(row, bit);
+    runFrames(m, 5);
+    m.keyUp(row, bit);
+    if (shiftRow >= 0) m.keyUp(shiftRow, shiftBit);
+    runFrames(m, 5);
+}
+
+// Type LOAD "" <ENTER> on the 48K, or choose Tape Loader from the 128K menu
+void startTapeLoad(ZXSpectrum& m, int machineId)
+{
+    if (machineId == 0) {
+        tapKey(m, 6, 3);            // J = LOAD
+        tapKey(m, 5, 0, 7, 1);      // Symbol Shift + P = "
+        tapKey(m, 5, 0, 7, 1);
+    }
+    tapKey(m, 6, 0);                // ENTER
+}
+
+std::unique_ptr<ZXSpectrum> prepareMachine(const Options& opt)
+{
+    auto m = createMachine(opt.machineId);
+    m->init();
+    m->tapeSetInstantLoad(false);
+    uint32_t size = static_cast<uint32_t>(opt.data.size());
+
+    switch (opt.type) {
+        case FileType::Z80:
+            m->loadZ80(opt.data.data(), size);
+            runFrames(*m, opt.warmup);
+            break;
+        case FileType::SNA:
+            m->loadSNA(opt.data.data(), size);
+            runFrames(*m, opt.warmup);
+            break;
+        case FileType::P:
+            static_cast<zx81::ZX81&>(*m).loadP(opt.data.data(), size);
+            runFrames(*m, opt.warmup);
+            break;
+        case FileType::TAP:
+        case FileType::TZX:
+            runFrames(*m, opt.warmup);
+            if (opt.type == FileType::TAP) {
+                m->loadTAP(opt.data.data(), size);
+            } else {
+                m->loadTZXTape(opt.data.data(), size);
+            }
+            startTapeLoad(*m, opt.machineId);
+            m->tapePlay();
+            break;
+        case FileType::None:
+            runFrames(*m, opt.warmup);
+            break;
+    }
+    return m;
+}
+
+RunResult timeFrames(ZXSpectrum& m, int frames, FrameProfile* profile)
+{
+    RunResult r;
+#if ZXSPEC_PROFILE
+    FrameProfile::setActive(profile);
+#else
+    (void)profile;
+#endif
+#if ZXSPEC_PROFILE
+    uint64_t startInstructions = m.getCPU()->getInstructionCount();
+#endif
+    auto start = std::chrono::steady_clock::now();
+    runFrames(m, frames);
+    auto end = std::chrono::steady_clock::now();
+#if ZXSPEC_PROFILE
+    FrameProfile::setActive(nullptr);
+    r.instructions = m.getCPU()->getInstructionCount() - startInstructions;
+#endif
+    r.seconds = std::chrono::duration<double>(end - start).count();
+    if (profile) r.profile = *profile;
+    return r;
+}
+
+#if ZXSPEC_PROFILE
+// Cost of one profiled scope: the part charged to the section (between the
+// two clock reads) and the full cost as seen by the enclosing wall clock
+void measureScopeOverhead(double& insideNs, double& totalNs)
+{
+    constexpr int kIterations = 2000000;
+    FrameProfile calib;
+    FrameProfile::setActive(&calib);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        ZXSPEC_PROFILE_SCOPE(Display);     // an unsampled section
+    }
+    auto end = std::chrono::steady_clock::now();
+    FrameProfile::setActive(nullptr);
+    insideNs = static_cast<double>(calib.nanoseconds[FrameProfile::Display]) / kIterations;
+    totalNs = std::chrono::duration<double, std::nano>(end - start).count() / kIterations;
+}
+#endif
+
+void usage(const char* argv0)
+{
+    std::printf("Usage: %s [-m machine] [-f frames] [-w warmup] [-n machines] [-j threads] [-t turbo]"
+                " [file.z80|.sna|.tap|.tzx|.p]\n", argv0);
+    std::printf("  machine: 0=48K 1=128K 2=+2 3=+2A 4=+3 5=ZX81\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-m") && i + 1 < argc) {
+            opt.machineId = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-f") && i + 1 < argc) {
+            opt.frames = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-w") && i + 1 < argc) {
+            opt.warmup = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-n") && i + 1 < argc) {
+            opt.poolMachines = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-j") && i + 1 < argc) {
+            opt.poolThreads = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "-t") && i + 1 < argc) {
+            opt.turboFrames = std::atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            opt.path = argv[i];
+        }
+    }
+
+    if (!opt.path.empty()) {
+        opt.type = fileTypeFor(opt.path);
+        if (opt.type == FileType::None) {
+            std::printf("Unsupported file type: %s\n", opt.path.c_str());
+            return 1;
+        }
+        if (!readFile(opt.path, opt.data)) {
+            std::printf("Could not read %s\n", opt.path.c_str());
+            return 1;
+        }
+        if (opt.machineId < 0) opt.machineId = machineForSnapshot(opt.type, opt.data);
+    }
+    if (opt.machineId < 0 || opt.machineId > 5) opt.machineId = 0;
+    if (opt.frames <= 0) opt.frames = 1;
+
+#if ZXSPEC_PROFILE
+    double insideNs = 0.0;
+    double scopeNs = 0.0;
+    measureScopeOverhead(insideNs, scopeNs);
+
+    auto profiled = prepareMachine(opt);
+    FrameProfile profile;
+    RunResult prof = timeFrames(*profiled, opt.frames, &profile);
+
+    static const char* kNames[FrameProfile::SectionCount] = { "Display", "Audio", "Contention" };
+    double sectionNs[FrameProfile::SectionCount];
+    double timerNs = 0.0;
+    double sectionTotal = 0.0;
+    for (int s = 0; s < FrameProfile::SectionCount; s++) {
+        const FrameProfile& p = prof.profile;
+        double ns = 0.0;
+        if (p.timedCalls[s] > 0) {
+            double perCall = static_cast<double>(p.nanoseconds[s]) / p.timedCalls[s] - insideNs;
+            ns = perCall * static_cast<double>(p.calls[s]);
+        }
+        sectionNs[s] = ns > 0.0 ? ns : 0.0;
+        sectionTotal += sectionNs[s];
+        timerNs += scopeNs * static_cast<double>(p.timedCalls[s]);
+    }
+    double totalNs = prof.seconds * 1e9 - timerNs;
+    double cpuNs = totalNs - sectionTotal;
+    if (cpuNs < 0.0) cpuNs = 0.0;
+
+    std::printf("Machine:             %s\n", profiled->getName());
+    std::printf("Input:               %s\n", opt.path.empty() ? "(none, ROM idle)" : opt.path.c_str());
+    std::printf("Frames:              %d (after %d warm-up)\n", opt.frames, opt.warmup);
+    std::printf("\nTime split (%.1f ns timer cost per scope removed; run zxspec_bench\n"
+                "for throughput, this build is slowed by the profile scopes):\n", scopeNs);
+    double frameUs = totalNs / 1e3 / opt.frames;
+    std::printf("  %-12s %6.1f%%  %8.1f us/frame\n", "CPU", 100.0 * cpuNs / totalNs,
+                frameUs * cpuNs / totalNs);
+    for (int s = 0; s < FrameProfile::SectionCount; s++) {
+        std::printf("  %-12s %6.1f%%  %8.1f us/frame  %10llu calls\n", kNames[s],
+                    100.0 * sectionNs[s] / totalNs, frameUs * sectionNs[s] / totalNs,
+                    static_cast<unsigned long long>(prof.profile.calls[s]));
+    }
+    std::printf("  (contention is timed 1 call in %u; CPU and contention shares are\n"
+                "   approximate when the host clock read is slow)\n",
+                1u << FrameProfile::sampleShift[FrameProfile::Contention]);
+    std::printf("\nZ80 instructions:    %.0f per frame\n", static_cast<double>(prof.instructions) / opt.frames);
+    std::printf("Z80 MIPS:            %.2f (instructions over the CPU share above)\n",
+                cpuNs > 0.0 ? prof.instructions / cpuNs * 1e3 : 0.0);
+    return 0;
+#else
+    const MachineInfo& info = machines[opt.machineId];
+
+    auto plain = prepareMachine(opt);
+    RunResult run = timeFrames(*plain, opt.frames, nullptr);
+
+    double fps = opt.frames / run.seconds;
+    double clockHz = (opt.machineId == 5) ? kZX81ClockHz : CPU_CLOCK_HZ;
+    double emulatedFps = clockHz / info.tsPerFrame;
+
+    std::printf("Machine:             %s\n", plain->getName());
+    std::printf("Input:               %s\n", opt.path.empty() ? "(none, ROM idle)" : opt.path.c_str());
+    std::printf("Frames:              %d (after %d warm-up)\n", opt.frames, opt.warmup);
+    std::printf("Time:                %.3f s\n", run.seconds);
+    std::printf("Frames/sec:          %.1f (%.1fx real time)\n", fps, fps / emulatedFps);
+    std::printf("Host time per frame: %.1f us\n", run.seconds * 1e6 / opt.frames);
+
+    if (opt.poolMachines > 1) {
+        MachinePool pool(static_cast<unsigned>(opt.poolThreads > 0 ? opt.poolThreads : 0));
+        for (int i = 0; i < opt.poolMachines; i++) {
+            pool.add(prepareMachine(opt));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        pool.run(static_cast<uint32_t>(opt.frames), 10);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double poolFps = static_cast<double>(opt.frames) * opt.poolMachines / seconds;
+        std::printf("\nMachine pool:        %d machines on %u threads, 10 frames per task\n",
+                    opt.poolMachines, pool.threadCount());
+        std::printf("Time:                %.3f s\n", seconds);
+        std::printf("Frames/sec (total):  %.1f (%.2fx the single machine)\n", poolFps, poolFps / fps);
+    }
+
+    if (opt.turboFrames > 1) {
+        auto turbo = prepareMachine(opt);
+        double speed = 0.0;
+        int calls = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int done = 0; done < opt.frames; done += opt.turboFrames) {
+            turbo->runTurboFrames(std::min(opt.turboFrames, opt.frames - done));
+            turbo->resetAudioBuffer();
+            speed += turbo->getTurboSpeed();
+            calls++;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("\nTurbo:               %d frames per call\n", opt.turboFrames);
+        std::printf("Time:                %.3f s\n", seconds);
+        std::printf("Emulated speed:      %.1fx real time (%.2fx the plain run)\n",
+                    speed / calls, run.seconds / seconds);
+    }
+
+    return 0;
+#endif
+}
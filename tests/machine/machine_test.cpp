@@ -0,0 +1,1505 @@
+/*
+ * machine_test.cpp - Whole-machine tests for the ZX Spectrum variants
+ *
+ * Runs complete machines (ROMs embedded) headless and compares the output of
+ * different execution strategies frame by frame.
+ * Compiles with the machine_test CMake target (native, non-Emscripten build).
+ */
+
+#include "zx_spectrum_48k.hpp"
+#include "zx_spectrum_128k.hpp"
+#include "zx_spectrum_plus2a.hpp"
+#include "zx_spectrum_plus3.hpp"
+#include "zx81.hpp"
+#include "time_travel.hpp"
+#include "lz_codec.hpp"
+#include "z80_saver.hpp"
+#include "../native/machine_pool.hpp"
+
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Minimal test framework (shared with z80_test.cpp)
+// ---------------------------------------------------------------------------
+
+static int g_total   = 0;
+static int g_passed  = 0;
+static int g_failed  = 0;
+
+#define TEST_BEGIN(name)                                         \
+    do {                                                         \
+        g_total++;                                               \
+        const char* _test_name = (name);                         \
+        bool _test_ok = true;                                    \
+        (void)_test_ok;
+
+#define EXPECT_EQ(actual, expected)                               \
+    do {                                                          \
+        auto _a = (actual);                                       \
+        auto _e = (expected);                                     \
+        if (_a != _e) {                                           \
+            std::printf("    FAIL: %s == 0x%llX, expected 0x%llX\n", \
+                        #actual, (unsigned long long)_a,          \
+                        (unsigned long long)_e);                  \
+            _test_ok = false;                                     \
+        }                                                         \
+    } while (0)
+
+#define EXPECT_TRUE(expr)                                         \
+    do {                                                          \
+        if (!(expr)) {                                            \
+            std::printf("    FAIL: %s was false\n", #expr);       \
+            _test_ok = false;                                     \
+        }                                                         \
+    } while (0)
+
+#define TEST_END()                                                \
+        if (_test_ok) {                                           \
+            std::printf("  PASS  %s\n", _test_name);              \
+            g_passed++;                                           \
+        } else {                                                  \
+            std::printf("  FAIL  %s\n", _test_name);              \
+            g_failed++;                                           \
+        }                                                         \
+    } while (0)
+
+using namespace zxspec;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+using MachineFactory = std::function<std::unique_ptr<ZXSpectrum>()>;
+
+// FNV-1a over a byte range
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Hash everything observable after a frame: CPU state, the full 64K address
+// space, the framebuffer and this frame's mixed audio output.
+static uint64_t frameHash(const ZXSpectrum& m)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    uint16_t regs[] = { m.getPC(), m.getSP(), m.getAF(), m.getBC(), m.getDE(),
+                        m.getHL(), m.getIX(), m.getIY(), m.getAltAF(), m.getAltBC(),
+                        m.getAltDE(), m.getAltHL() };
+    h = fnv1a(h, regs, sizeof(regs));
+    uint32_t ts = m.getTStates();
+    h = fnv1a(h, &ts, sizeof(ts));
+    uint8_t border = m.getBorderColor();
+    h = fnv1a(h, &border, 1);
+
+    for (uint32_t addr = 0; addr < 0x10000; addr++) {
+        uint8_t b = m.readMemory(static_cast<uint16_t>(addr));
+        h = fnv1a(h, &b, 1);
+    }
+
+    h = fnv1a(h, m.getFramebuffer(), static_cast<size_t>(m.getFramebufferSize()));
+    h = fnv1a(h, m.getAudioBuffer(), static_cast<size_t>(m.getAudioSampleCount()) * sizeof(float));
+    return h;
+}
+
+// Two-block TAP image with varied data so the pulse train has plenty of edges
+static std::vector<uint8_t> makeTap()
+{
+    std::vector<uint8_t> tap;
+    auto addBlock = [&tap](uint8_t flag, size_t len, uint8_t seed) {
+        size_t blockLen = len + 2;
+        tap.push_back(static_cast<uint8_t>(blockLen & 0xFF));
+        tap.push_back(static_cast<uint8_t>(blockLen >> 8));
+        uint8_t checksum = flag;
+        tap.push_back(flag);
+        for (size_t i = 0; i < len; i++) {
+            uint8_t b = static_cast<uint8_t>(seed + i * 37 + (i >> 3));
+            tap.push_back(b);
+            checksum ^= b;
+        }
+        tap.push_back(checksum);
+    };
+    addBlock(0xFF, 17, 0x11);
+    addBlock(0xFF, 600, 0x5A);
+    return tap;
+}
+
+// RAM program at 0x8000: samples the tape EAR bit, echoes it to the beeper
+// and border, drives the SpecDrum DAC and cycles through AY registers with a
+// data-dependent delay loop, all with interrupts enabled.
+static const uint8_t kTestProgram[] = {
+    0x01, 0xFD, 0xFF,       // 8000  LD BC,0xFFFD
+    0x3E, 0x07,             // 8003  LD A,7
+    0xED, 0x79,             // 8005  OUT (C),A        ; select mixer
+    0x06, 0xBF,             // 8007  LD B,0xBF
+    0x3E, 0x38,             // 8009  LD A,0x38        ; tones on
+    0xED, 0x79,             // 800B  OUT (C),A
+    0x1E, 0x00,             // 800D  LD E,0
+    0xDB, 0xFE,             // 800F  IN A,(0xFE)      ; loop: EAR in
+    0xE6, 0x40,             // 8011  AND 0x40
+    0x0F,                   // 8013  RRCA
+    0x0F,                   // 8014  RRCA             ; -> EAR out (bit 4)
+    0xAB,                   // 8015  XOR E
+    0xE6, 0x17,             // 8016  AND 0x17
+    0xD3, 0xFE,             // 8018  OUT (0xFE),A     ; border + beeper
+    0xD3, 0xDF,             // 801A  OUT (0xDF),A     ; SpecDrum
+    0x01, 0xFD, 0xFF,       // 801C  LD BC,0xFFFD
+    0x7B,                   // 801F  LD A,E
+    0xE6, 0x07,             // 8020  AND 7
+    0xED, 0x79,             // 8022  OUT (C),A        ; AY register select
+    0x06, 0xBF,             // 8024  LD B,0xBF
+    0xED, 0x59,             // 8026  OUT (C),E        ; AY data
+    0x1C,                   // 8028  INC E
+    0x7B,                   // 8029  LD A,E
+    0xE6, 0x1F,             // 802A  AND 0x1F
+    0x47,                   // 802C  LD B,A
+    0x10, 0xFE,             // 802D  DJNZ $
+    0x18, 0xDE,             // 802F  JR 0x800F
+};
+
+static std::unique_ptr<ZXSpectrum> bootMachine(const MachineFactory& make, bool batch,
+                                               const std::vector<uint8_t>& tap)
+{
+    auto m = make();
+    m->init();
+    m->setBatchExecutionEnabled(batch);
+    m->setAYEnabled(true);
+    m->setSpecdrumEnabled(true);
+    m->tapeSetInstantLoad(false);
+
+    for (int i = 0; i < 100; i++) m->runFrame();
+
+    for (size_t i = 0; i < sizeof(kTestProgram); i++) {
+        m->writeMemory(static_cast<uint16_t>(0x8000 + i), kTestProgram[i]);
+    }
+    m->setPC(0x8000);
+    m->loadTAP(tap.data(), static_cast<uint32_t>(tap.size()));
+    m->tapePlay();
+    m->resetAudioBuffer();
+    return m;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+// Batch execution must be cycle-identical to the per-instruction loop,
+// including across a breakpoint that stops a frame mid-way.
+static void test_batch_matches_per_instruction(const char* name, const MachineFactory& make)
+{
+    TEST_BEGIN(name);
+        std::vector<uint8_t> tap = makeTap();
+        auto ref = bootMachine(make, false, tap);
+        auto batch = bootMachine(make, true, tap);
+
+        EXPECT_EQ(frameHash(*batch), frameHash(*ref));
+
+        int mismatchFrame = -1;
+        for (int frame = 0; frame < 200 && mismatchFrame < 0; frame++) {
+            if (frame == 40) {
+                ref->addBreakpoint(0x8028);
+                batch->addBreakpoint(0x8028);
+            }
+
+            ref->runFrame();
+            batch->runFrame();
+
+            if (frame == 40) {
+                EXPECT_TRUE(ref->isPaused());
+                EXPECT_TRUE(batch->isPaused());
+                ref->removeBreakpoint(0x8028);
+                batch->removeBreakpoint(0x8028);
+                ref->setPaused(false);
+                batch->setPaused(false);
+            }
+
+            if (frameHash(*batch) != frameHash(*ref)) {
+                mismatchFrame = frame;
+            }
+            ref->resetAudioBuffer();
+            batch->resetAudioBuffer();
+        }
+
+        EXPECT_EQ(mismatchFrame, -1);
+        EXPECT_TRUE(ref->tapeGetCurrentBlock() > 0);
+    TEST_END();
+}
+
+// Machines advanced in parallel by the pool must end up exactly where the
+// same machines end up when run one after another on this thread
+static void test_machine_pool_matches_sequential()
+{
+    TEST_BEGIN("MachinePool == sequential runs (6 machines, 4 threads)");
+        const MachineFactory factories[] = {
+            [] { return std::make_unique<zx48k::ZXSpectrum48>(); },
+            [] { return std::make_unique<zx128k::ZXSpectrum128>(); },
+            [] { return std::make_unique<zxplus2a::ZXSpectrumPlus2A>(); },
+        };
+        constexpr int kMachines = 6;
+        constexpr uint32_t kFrames = 120;
+        std::vector<uint8_t> tap = makeTap();
+
+        MachinePool pool(4);
+        std::vector<std::unique_ptr<ZXSpectrum>> sequential;
+        for (int i = 0; i < kMachines; i++) {
+            pool.add(bootMachine(factories[i % 3], true, tap));
+            sequential.push_back(bootMachine(factories[i % 3], true, tap));
+        }
+
+        std::atomic<uint32_t> callbackFrames{0};
+        pool.setFrameCallback([&](size_t, ZXSpectrum&) { callbackFrames++; });
+        pool.run(kFrames / 2, 7);
+        pool.run(kFrames / 2, 7);
+        EXPECT_EQ(callbackFrames.load(), kFrames * kMachines);
+
+        for (int i = 0; i < kMachines; i++) {
+            for (uint32_t f = 0; f < kFrames; f++) {
+                sequential[i]->runFrame();
+                sequential[i]->resetAudioBuffer();
+            }
+            EXPECT_EQ(frameHash(pool.machine(i)), frameHash(*sequential[i]));
+
+            MachinePool::FrameOutput out;
+            EXPECT_TRUE(pool.latestOutput(i, out));
+            EXPECT_EQ(out.frame, static_cast<uint64_t>(kFrames));
+            EXPECT_TRUE(std::memcmp(out.framebuffer.data(), sequential[i]->getFramebuffer(),
+                                    out.framebuffer.size()) == 0);
+            EXPECT_TRUE(!pool.latestOutput(i, out));
+        }
+    TEST_END();
+}
+
+// Only framebuffer rows whose screen memory, border or FLASH state changed
+// may be reported dirty, and every such row must be
+static bool rowDirty(const ZXSpectrum& m, uint32_t row)
+{
+    return (m.getDirtyRows()[row >> 5] >> (row & 31)) & 1;
+}
+
+static int dirtyRowCount(const ZXSpectrum& m)
+{
+    int count = 0;
+    for (uint32_t row = 0; row < TOTAL_HEIGHT; row++) {
+        count += rowDirty(m, row) ? 1 : 0;
+    }
+    return count;
+}
+
+static void test_dirty_rows()
+{
+    TEST_BEGIN("Dirty rows track screen and border changes (48K)");
+        auto m = std::make_unique<zx48k::ZXSpectrum48>();
+        m->init();
+        for (int i = 0; i < 100; i++) m->runFrame();
+
+        // Idle at the copyright message: nothing on screen changes
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_EQ(dirtyRowCount(*m), 0);
+
+        // One bitmap byte of paper line 9 (third 0, cell row 1, pixel row 1)
+        m->writeMemory(0x4120, static_cast<uint8_t>(m->readMemory(0x4120) ^ 0xFF));
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_EQ(dirtyRowCount(*m), 1);
+        EXPECT_TRUE(rowDirty(*m, BORDER_TOP + 9));
+
+        // One attribute byte covers the 8 lines of its character row
+        m->writeMemory(0x5800 + 32 * 5, 0x16);
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_EQ(dirtyRowCount(*m), 8);
+        EXPECT_TRUE(rowDirty(*m, BORDER_TOP + 40) && rowDirty(*m, BORDER_TOP + 47));
+
+        // FLASH redraws the cell when the phase flips, then it settles
+        m->writeMemory(0x5800 + 32 * 5, 0x96);
+        int flips = 0;
+        for (int i = 0; i < 32; i++) {
+            m->clearDirtyRows();
+            m->runFrame();
+            int n = dirtyRowCount(*m);
+            flips += (n == 8) ? 1 : 0;
+            EXPECT_TRUE(n == 0 || n == 8);
+        }
+        EXPECT_TRUE(flips >= 2);
+        m->writeMemory(0x5800 + 32 * 5, 0x38);
+        m->runFrame();
+
+        // A border change redraws every visible row
+        m->setBorderColor(2);
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_EQ(dirtyRowCount(*m), static_cast<int>(TOTAL_HEIGHT));
+
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_EQ(dirtyRowCount(*m), 0);
+    TEST_END();
+
+    TEST_BEGIN("Dirty rows: ZX81 reports every row as changed");
+        auto m = std::make_unique<zx81::ZX81>();
+        m->init();
+        m->runFrame();
+        m->clearDirtyRows();
+        m->runFrame();
+        EXPECT_TRUE(m->getDirtyRows() == nullptr);
+    TEST_END();
+}
+
+// A screen write needs a display catch-up only when a cell showing the byte
+// falls between what has been drawn and the write's T-state
+static void test_display_write_filter()
+{
+    TEST_BEGIN("Screen writes catch up only pending cells (48K)");
+        Display display;
+        display.init(machines[eZXSpectrum48]);
+        std::vector<uint8_t> memory(0x4000, 0);
+
+        // Paper line 0, column 0 is drawn at 64 * 224 + 24; column 1 follows
+        const uint32_t cell = 64 * 224 + 24;
+        EXPECT_TRUE(!display.isCellPending(0, cell));
+        EXPECT_TRUE(display.isCellPending(0, cell + 1));
+        EXPECT_TRUE(!display.isCellPending(1, cell + 4));
+        EXPECT_TRUE(!display.isCellPending(0x1B00, cell + 100000));
+        EXPECT_TRUE(!display.isCellPending(0x2000, cell + 100000));
+
+        // Bitmap line 1 (offset 0x100) is a scanline below line 0
+        EXPECT_TRUE(!display.isCellPending(0x100, cell + 200));
+        EXPECT_TRUE(display.isCellPending(0x100, cell + 225));
+
+        // Once line 0 is drawn only its remaining attribute lines are pending
+        display.updateWithTs(static_cast<int32_t>(cell + 4), memory.data(), 7, 0);
+        EXPECT_TRUE(!display.isCellPending(0, cell + 100));
+        EXPECT_TRUE(!display.isCellPending(0x1800, cell + 100));
+        EXPECT_TRUE(display.isCellPending(0x1800, cell + 225));
+        EXPECT_TRUE(display.isCellPending(0x1800, cell + 100000));
+    TEST_END();
+
+    TEST_BEGIN("Only lines with noted screen writes are redrawn (48K)");
+        const MachineInfo& info = machines[eZXSpectrum48];
+        const int32_t frameTs = static_cast<int32_t>(info.tsPerFrame);
+        Display display;
+        display.init(info);
+        std::vector<uint8_t> memory(0x4000, 0);
+        std::fill(memory.begin() + 0x1800, memory.begin() + 0x1B00, 0x38);
+        auto frame = [&](int32_t ts) {
+            display.updateWithTs(ts, memory.data(), 7, 0);
+            display.updateWithTs(frameTs - static_cast<int32_t>(display.getCurrentDisplayTs()),
+                                 memory.data(), 7, 0);
+            display.frameReset();
+        };
+        auto rowCount = [&] {
+            int count = 0;
+            for (uint32_t row = 0; row < TOTAL_HEIGHT; row++) {
+                count += (display.getDirtyRows()[row >> 5] >> (row & 31)) & 1;
+            }
+            display.clearDirtyRows();
+            return count;
+        };
+        auto matches = [&] {
+            Display fresh;
+            fresh.init(info);
+            fresh.updateWithTs(frameTs, memory.data(), 7, 0);
+            return std::memcmp(fresh.getFramebuffer(), display.getFramebuffer(),
+                               display.getFramebufferSize()) == 0;
+        };
+        frame(frameTs);
+        rowCount();
+
+        // An unnoted write is not looked for; a noted one is drawn
+        memory[0x0100] = 0xFF;
+        frame(frameTs);
+        EXPECT_EQ(rowCount(), 0);
+        display.markScreenWrite(0x0100);
+        frame(frameTs);
+        EXPECT_EQ(rowCount(), 1);
+        EXPECT_TRUE(matches());
+
+        // A write behind the beam shows from the next frame
+        const int32_t midLine0 = 64 * 224 + 24 + 40;
+        memory[0x0000] = 0x0F;
+        display.markScreenWrite(0x0000);
+        frame(frameTs);
+        rowCount();
+        display.updateWithTs(midLine0, memory.data(), 7, 0);
+        memory[0x0001] = 0xF0;
+        display.markScreenWrite(0x0001);
+        frame(0);
+        EXPECT_TRUE(!matches());
+        frame(frameTs);
+        EXPECT_EQ(rowCount(), 1);
+        EXPECT_TRUE(matches());
+
+        // An attribute covers 8 lines
+        memory[0x1800 + 64] = 0x16;
+        display.markScreenWrite(0x1800 + 64);
+        frame(frameTs);
+        EXPECT_EQ(rowCount(), 8);
+        EXPECT_TRUE(matches());
+    TEST_END();
+}
+
+// Editing a UDG patches the screen cells that show it, but only during a
+// UDG editor session
+static void test_udg_screen_patching()
+{
+    TEST_BEGIN("UDG writes patch the screen only while enabled (48K)");
+        auto m = std::make_unique<zx48k::ZXSpectrum48>();
+        m->init();
+        for (int i = 0; i < 100; i++) m->runFrame();
+
+        // UDG "A" shown in the top-left character cell
+        uint16_t udg = static_cast<uint16_t>(m->readMemory(0x5C7B) | (m->readMemory(0x5C7C) << 8));
+        for (int row = 0; row < 8; row++) {
+            m->writeMemory(static_cast<uint16_t>(udg + row), static_cast<uint8_t>(0x81 + row));
+            m->writeMemory(static_cast<uint16_t>(0x4000 + row * 0x100), static_cast<uint8_t>(0x81 + row));
+        }
+
+        m->writeMemory(static_cast<uint16_t>(udg + 2), 0x3C);
+        EXPECT_EQ(m->readMemory(0x4200), 0x83);
+
+        m->writeMemory(static_cast<uint16_t>(udg + 2), 0x83);
+        m->setUdgScreenPatching(true);
+        m->writeMemory(static_cast<uint16_t>(udg + 2), 0x3C);
+        EXPECT_EQ(m->readMemory(0x4200), 0x3C);
+        EXPECT_EQ(m->readMemory(0x4300), 0x84);
+    TEST_END();
+}
+
+static void test_stereo_mixer()
+{
+    TEST_BEGIN("Stereo mixer pans AY channel A left and matches mono (128K)");
+        auto m = std::make_unique<zx128k::ZXSpectrum128>();
+        m->init();
+        for (int i = 0; i < 100; i++) m->runFrame();
+
+        // Nothing is mixed in stereo until it is asked for
+        EXPECT_TRUE(m->getStereoAudioBuffer() == nullptr);
+        EXPECT_EQ(m->getStereoAudioFrameCount(), 0);
+        m->setStereoOutputEnabled(true);
+        m->getMixer().setDCBlockEnabled(false);
+
+        // Channel A square wave at full volume, B and C silent
+        AY3_8912& ay = m->getAY();
+        const uint8_t regs[][2] = { {0, 0x40}, {1, 0x00}, {7, 0x3E}, {8, 0x0F}, {9, 0x00}, {10, 0x00} };
+        for (const auto& r : regs) {
+            ay.selectRegister(r[0]);
+            ay.writeData(r[1]);
+        }
+
+        // Centred: both sides carry exactly the mono mix
+        m->setAYPanning(AudioMixer::AYPanning::Mono);
+        m->resetAudioBuffer();
+        m->runFrame();
+        int count = m->getAudioSampleCount();
+        EXPECT_EQ(m->getStereoAudioFrameCount(), count);
+        const float* mono = m->getAudioBuffer();
+        const float* stereo = m->getStereoAudioBuffer();
+        int mismatches = 0;
+        for (int i = 0; i < count; i++) {
+            if (stereo[i * 2] != mono[i] || stereo[i * 2 + 1] != mono[i]) mismatches++;
+        }
+        EXPECT_EQ(mismatches, 0);
+
+        // ABC: A is mostly left, and the two sides still sum to twice mono
+        m->setAYPanning(AudioMixer::AYPanning::ABC);
+        m->runFrame();
+        m->resetAudioBuffer();
+        m->runFrame();
+        count = m->getAudioSampleCount();
+        EXPECT_EQ(m->getStereoAudioFrameCount(), count);
+        mono = m->getAudioBuffer();
+        stereo = m->getStereoAudioBuffer();
+        double leftMinusRight = 0.0;
+        int sumErrors = 0;
+        for (int i = 0; i < count; i++) {
+            leftMinusRight += stereo[i * 2] - stereo[i * 2 + 1];
+            if (std::fabs(stereo[i * 2] + stereo[i * 2 + 1] - 2.0f * mono[i]) > 1e-4f) sumErrors++;
+        }
+        EXPECT_TRUE(leftMinusRight > 1.0);
+        EXPECT_EQ(sumErrors, 0);
+    TEST_END();
+}
+
+// Output frames produced over a number of frames at a given host rate
+static int resampledFrames(ZXSpectrum& m, int frames, int* stereoFrames, float* peak)
+{
+    int total = 0;
+    for (int i = 0; i < frames; i++) {
+        m.resetAudioBuffer();
+        m.runFrame();
+        int count = m.getAudioSampleCount();
+        total += count;
+        *stereoFrames += m.getStereoAudioFrameCount();
+        for (int j = 0; j < count; j++) {
+            *peak = std::max(*peak, std::fabs(m.getAudioBuffer()[j]));
+        }
+    }
+    return total;
+}
+
+static void test_resampler_rates()
+{
+    TEST_BEGIN("Resampled output tracks the host rate and rate adjustment (128K)");
+        auto m = std::make_unique<zx128k::ZXSpectrum128>();
+        m->init();
+        for (int i = 0; i < 100; i++) m->runFrame();
+
+        m->setStereoOutputEnabled(true);
+
+        AY3_8912& ay = m->getAY();
+        const uint8_t regs[][2] = { {0, 0x40}, {1, 0x00}, {7, 0x3E}, {8, 0x0F} };
+        for (const auto& r : regs) {
+            ay.selectRegister(r[0]);
+            ay.writeData(r[1]);
+        }
+
+        const int frames = 200;
+        double seconds = frames * machines[eZXSpectrum128].tsPerFrame / CPU_CLOCK_HZ;
+        const int rates[] = { 44100, 96000, 22050 };
+        for (int rate : rates) {
+            m->setAudioOutputRate(rate);
+            EXPECT_EQ(m->getAudioOutputRate(), rate);
+            int stereo = 0;
+            float peak = 0.0f;
+            int mono = resampledFrames(*m, frames, &stereo, &peak);
+            EXPECT_EQ(stereo, mono);
+            EXPECT_TRUE(std::abs(mono - static_cast<int>(rate * seconds)) <= Resampler::TAPS);
+            EXPECT_TRUE(peak > 0.05f && peak < 1.5f);
+        }
+
+        // +5000 ppm gives half a percent more output
+        m->setAudioOutputRate(44100);
+        m->setAudioRateAdjustment(5000.0);
+        int stereo = 0;
+        float peak = 0.0f;
+        int mono = resampledFrames(*m, frames, &stereo, &peak);
+        EXPECT_TRUE(std::abs(mono - static_cast<int>(44100 * 1.005 * seconds)) <= Resampler::TAPS);
+
+        // Back at the internal rate the mixer output is passed straight through
+        m->setAudioRateAdjustment(0.0);
+        m->setAudioOutputRate(static_cast<int>(AUDIO_SAMPLE_RATE));
+        m->resetAudioBuffer();
+        m->runFrame();
+        EXPECT_EQ(m->getAudioBuffer(), m->getAudio().getBuffer());
+    TEST_END();
+}
+
+// Output of one allophone spoken after whatever the chip said before, up
+// to the point where it halts with nothing queued. Checks the busy line
+// against the other chip on every step.
+static std::vector<float> speakAllophone(SP0256& chip, SP0256& other, uint8_t allophone,
+                                         std::vector<float>& otherOut, int& busyMismatches)
+{
+    std::vector<float> out;
+    otherOut.clear();
+    chip.writeAllophone(allophone);
+    other.writeAllophone(allophone);
+    for (int step = 1; chip.isBusy() || other.isBusy(); step++) {
+        chip.update(13);
+        other.update(13);
+        if (chip.isBusy() != other.isBusy()) busyMismatches++;
+        if (step % 500 == 0 || !chip.isBusy()) {
+            out.insert(out.end(), chip.getBuffer(), chip.getBuffer() + chip.getSampleCount());
+            otherOut.insert(otherOut.end(), other.getBuffer(), other.getBuffer() + other.getSampleCount());
+            chip.resetBuffer();
+            other.resetBuffer();
+        }
+    }
+    return out;
+}
+
+static double rms(const std::vector<float>& v)
+{
+    double sum = 0.0;
+    for (float x : v) sum += static_cast<double>(x) * x;
+    return v.empty() ? 0.0 : std::sqrt(sum / v.size());
+}
+
+static void test_sp0256_cached_allophones()
+{
+    TEST_BEGIN("SP0256 cached allophones match exact synthesis");
+        auto m = std::make_unique<zx48k::ZXSpectrum48>();
+        m->init();
+        const SP0256& loaded = m->getCurrahSpeech().getSP0256();
+        const double fps = CPU_CLOCK_HZ / 69888.0;
+
+        // Each allophone from a freshly reset chip, where the noise LFSR
+        // starts where the cache renders it from, then half a second of
+        // whatever follows (the chip halts and goes quiet)
+        int mismatched = 0;
+        for (uint8_t a = 1; a < SP0256::NUM_ALLOPHONES; a++) {
+            auto exact = std::make_unique<SP0256>(loaded);
+            auto cached = std::make_unique<SP0256>(loaded);
+            exact->setup(static_cast<int>(AUDIO_SAMPLE_RATE), fps, 69888);
+            cached->setup(static_cast<int>(AUDIO_SAMPLE_RATE), fps, 69888);
+            exact->reset();
+            cached->reset();
+            cached->setCachedMode(true);
+            exact->writeAllophone(a);
+            cached->writeAllophone(a);
+
+            for (int f = 0; f < 25; f++) {
+                for (int32_t ts = 0; ts < 69888; ts += 13) {
+                    exact->update(13);
+                    cached->update(13);
+                    if (exact->isBusy() != cached->isBusy()) mismatched++;
+                }
+                if (exact->getSampleCount() != cached->getSampleCount() ||
+                    std::memcmp(exact->getBuffer(), cached->getBuffer(),
+                                sizeof(float) * exact->getSampleCount()) != 0) {
+                    mismatched++;
+                }
+                exact->resetBuffer();
+                cached->resetBuffer();
+            }
+        }
+        EXPECT_EQ(mismatched, 0);
+    TEST_END();
+
+    TEST_BEGIN("SP0256 cached allophones differ from exact synthesis only in noise");
+        auto m = std::make_unique<zx48k::ZXSpectrum48>();
+        m->init();
+        const SP0256& loaded = m->getCurrahSpeech().getSP0256();
+        const double fps = CPU_CLOCK_HZ / 69888.0;
+        auto exact = std::make_unique<SP0256>(loaded);
+        auto cached = std::make_unique<SP0256>(loaded);
+        exact->setup(static_cast<int>(AUDIO_SAMPLE_RATE), fps, 69888);
+        cached->setup(static_cast<int>(AUDIO_SAMPLE_RATE), fps, 69888);
+        exact->reset();
+        cached->reset();
+        cached->setCachedMode(true);
+
+        // Every allophone, each after SS so the live chip's noise LFSR has
+        // moved on from its reset seed. Whatever differs must be noise:
+        // same length and busy timing, and about the same energy.
+        int busyMismatches = 0;
+        int lengthMismatches = 0;
+        std::array<bool, SP0256::NUM_ALLOPHONES> same{};
+        double worstRatio = 1.0;
+        std::vector<float> c;
+        for (uint8_t a = 1; a < SP0256::NUM_ALLOPHONES; a++) {
+            speakAllophone(*exact, *cached, 55, c, busyMismatches);
+            std::vector<float> e = speakAllophone(*exact, *cached, a, c, busyMismatches);
+            lengthMismatches += (e.size() != c.size()) ? 1 : 0;
+            same[a] = (e == c);
+            if (!same[a]) {
+                double ratio = rms(c) / std::max(rms(e), 1e-9);
+                worstRatio = std::max(worstRatio, std::max(ratio, 1.0 / ratio));
+            }
+        }
+        EXPECT_EQ(busyMismatches, 0);
+        EXPECT_EQ(lengthMismatches, 0);
+        EXPECT_TRUE(worstRatio < 1.5);
+
+        // Voiced allophones never read the LFSR, so they match exactly
+        const uint8_t voiced[] = { 7, 16, 19, 24, 45, 53 };     // EH MM IY AA LL OW
+        int voicedMismatches = 0;
+        for (uint8_t a : voiced) voicedMismatches += same[a] ? 0 : 1;
+        EXPECT_EQ(voicedMismatches, 0);
+    TEST_END();
+}
+
+// Every pulse expanded in order, as the loaders used to store the tape
+static std::vector<uint32_t> expandPulses(const std::vector<TapeBlock>& blocks)
+{
+    std::vector<uint32_t> pulses;
+    for (const auto& block : blocks) {
+        if (block.data.empty()) continue;
+        if (block.hasPilot) {
+            uint16_t pilotCount = block.pilotCount ? block.pilotCount
+                                                   : ((block.data[0] < 128) ? 8063 : 3223);
+            pulses.insert(pulses.end(), pilotCount, block.pilotPulse);
+            pulses.push_back(block.sync1);
+            pulses.push_back(block.sync2);
+        }
+        for (size_t b = 0; b < block.data.size(); b++) {
+            int bits = (b == block.data.size() - 1) ? block.usedBitsLastByte : 8;
+            for (int bit = 7; bit >= 8 - bits; bit--) {
+                uint32_t pulse = (block.data[b] & (1 << bit)) ? block.onePulse : block.zeroPulse;
+                pulses.push_back(pulse);
+                pulses.push_back(pulse);
+            }
+        }
+        if (block.pauseMs > 0) {
+            pulses.push_back(static_cast<uint32_t>(block.pauseMs) * 3500);
+        }
+    }
+    return pulses;
+}
+
+static void test_tape_pulse_stream()
+{
+    TEST_BEGIN("Tape pulse stream matches the expanded pulse list");
+        std::vector<TapeBlock> blocks(5);
+        blocks[0].data = { 0x00, 0x03, 0x41, 0x42 };            // Header: long pilot
+        blocks[1].data = { 0xFF, 0x00, 0xFF, 0xA5, 0x5A };      // Data: short pilot
+        blocks[2].data = { 0x12, 0x34, 0xE0 };                  // Turbo, partial last byte
+        blocks[2].pilotCount = 500;
+        blocks[2].usedBitsLastByte = 3;
+        blocks[2].pauseMs = 0;
+        blocks[3].data = { 0x81, 0x7E };                        // Pure data, no pilot
+        blocks[3].hasPilot = false;
+        blocks[3].zeroPulse = 300;
+        blocks[3].onePulse = 600;
+        // blocks[4] left empty
+
+        TapePulseStream stream;
+        stream.build(blocks);
+        std::vector<uint32_t> expected = expandPulses(blocks);
+
+        EXPECT_EQ(stream.size(), expected.size());
+        EXPECT_EQ(stream.blockStartCount(), blocks.size() + 1);
+        EXPECT_EQ(stream.blockStart(1), static_cast<size_t>(8063 + 2 + 4 * 16 + 1));
+        EXPECT_EQ(stream.blockStart(blocks.size()), expected.size());
+
+        // Forwards as playback does, then backwards as a rewind would
+        int mismatched = 0;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (stream.pulseAt(i, blocks) != expected[i]) mismatched++;
+        }
+        for (size_t i = expected.size(); i-- > 0; ) {
+            if (stream.pulseAt(i, blocks) != expected[i]) mismatched++;
+        }
+        EXPECT_EQ(mismatched, 0);
+        EXPECT_EQ(stream.pulseAt(expected.size(), blocks), 0u);
+
+        stream.clear();
+        EXPECT_TRUE(stream.empty());
+    TEST_END();
+}
+
+// RAM stub that loads both makeTap() blocks through a copy of the 48K ROM's
+// LD-BYTES relocated to 0x856B (see relocateLoader), standing in for a
+// custom loader: the instant-load trap is never hit, so the edge-sampling
+// loop at 0x85ED does all the work
+static const uint8_t kLoaderStub[] = {
+    0xF3,                   // 8000  DI
+    0xDD, 0x21, 0x00, 0x90, // 8001  LD IX,0x9000
+    0x11, 0x11, 0x00,       // 8005  LD DE,17
+    0xCD, 0x20, 0x80,       // 8008  CALL 0x8020
+    0xDD, 0x21, 0x00, 0xA0, // 800B  LD IX,0xA000
+    0x11, 0x58, 0x02,       // 800F  LD DE,600
+    0xCD, 0x20, 0x80,       // 8012  CALL 0x8020
+    0x18, 0xFE,             // 8015  JR $
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0x3E, 0xFF,             // 8020  LD A,0xFF         ; flag
+    0x37,                   // 8022  SCF               ; LOAD
+    0x14, 0x08, 0x15,       // 8023  INC D / EX AF,AF' / DEC D
+    0x3E, 0x0F,             // 8026  LD A,0x0F
+    0xD3, 0xFE,             // 8028  OUT (0xFE),A
+    0x21, 0x3A, 0x80,       // 802A  LD HL,0x803A
+    0xE5,                   // 802D  PUSH HL           ; LD-BYTES returns here
+    0xDB, 0xFE,             // 802E  IN A,(0xFE)
+    0x1F,                   // 8030  RRA
+    0xE6, 0x20,             // 8031  AND 0x20
+    0xF6, 0x02,             // 8033  OR 2
+    0x4F,                   // 8035  LD C,A
+    0xBF,                   // 8036  CP A
+    0xC3, 0x6C, 0x85,       // 8037  JP 0x856C         ; LD-START
+    0xC9,                   // 803A  RET
+};
+
+// Copy LD-BREAK..LD-SAMPLE (0x056B-0x0604) up by 0x8000, fixing the CALL
+// and JP targets inside it
+static void relocateLoader(ZXSpectrum& m)
+{
+    for (uint16_t addr = 0x056B; addr < 0x0605; addr++) {
+        m.writeMemory(static_cast<uint16_t>(addr + 0x8000), m.readMemory(addr));
+    }
+    for (uint16_t operand : { 0x056D, 0x057C, 0x0583, 0x0592, 0x059C, 0x05CB, 0x05D6, 0x05E4 }) {
+        m.writeMemory(static_cast<uint16_t>(operand + 0x8001), 0x85);
+    }
+}
+
+static std::unique_ptr<ZXSpectrum> bootLoader(bool batch, bool instant, bool skip,
+                                              const std::vector<uint8_t>& tap)
+{
+    auto m = std::make_unique<zx48k::ZXSpectrum48>();
+    m->init();
+    m->setBatchExecutionEnabled(batch);
+    for (int i = 0; i < 100; i++) m->runFrame();
+
+    for (size_t i = 0; i < sizeof(kLoaderStub); i++) {
+        m->writeMemory(static_cast<uint16_t>(0x8000 + i), kLoaderStub[i]);
+    }
+    relocateLoader(*m);
+    m->setPC(0x8000);
+    m->loadTAP(tap.data(), static_cast<uint32_t>(tap.size()));
+    m->tapeSetInstantLoad(instant);
+    m->tapeSetEdgeSkip(skip);
+    m->tapePlay();
+    m->resetAudioBuffer();
+    return m;
+}
+
+static bool sameCpuState(const ZXSpectrum& a, const ZXSpectrum& b)
+{
+    const Z80* za = a.getCPU();
+    const Z80* zb = b.getCPU();
+    for (auto reg : { Z80::WordReg::AF, Z80::WordReg::BC, Z80::WordReg::DE, Z80::WordReg::HL,
+                      Z80::WordReg::IX, Z80::WordReg::SP, Z80::WordReg::PC }) {
+        if (za->getRegister(reg) != zb->getRegister(reg)) return false;
+    }
+    return za->getRegister(Z80::ByteReg::R) == zb->getRegister(Z80::ByteReg::R) &&
+           za->getTStates() == zb->getTStates();
+}
+
+// Both tape blocks landed intact, checksums passed and the stub is spinning
+static bool loadedTap(const ZXSpectrum& m, const std::vector<uint8_t>& tap)
+{
+    if (m.getPC() != 0x8015) return false;
+    for (size_t i = 0; i < 17; i++) {
+        if (m.readMemory(static_cast<uint16_t>(0x9000 + i)) != tap[3 + i]) return false;
+    }
+    for (size_t i = 0; i < 600; i++) {
+        if (m.readMemory(static_cast<uint16_t>(0xA000 + i)) != tap[24 + i]) return false;
+    }
+    return true;
+}
+
+// Skipping passes of the edge-sampling loop must not change anything the
+// loader, display or audio can see, at normal speed or during instant load
+static void test_tape_edge_loop_skip()
+{
+    TEST_BEGIN("Tape edge-loop skipping matches full execution");
+        std::vector<uint8_t> tap = makeTap();
+
+        for (bool batch : { false, true }) {
+            auto ref = bootLoader(batch, false, false, tap);
+            auto fast = bootLoader(batch, false, true, tap);
+
+            int mismatchFrame = -1;
+            for (int frame = 0; frame < 500 && mismatchFrame < 0; frame++) {
+                ref->runFrame();
+                fast->runFrame();
+                if (frameHash(*fast) != frameHash(*ref) || !sameCpuState(*fast, *ref)) {
+                    mismatchFrame = frame;
+                }
+                ref->resetAudioBuffer();
+                fast->resetAudioBuffer();
+            }
+            EXPECT_EQ(mismatchFrame, -1);
+            EXPECT_TRUE(loadedTap(*ref, tap));
+            EXPECT_TRUE(loadedTap(*fast, tap));
+        }
+
+        // Instant load plays the whole tape in one runFrame()
+        auto ref = bootLoader(true, true, false, tap);
+        auto fast = bootLoader(true, true, true, tap);
+        ref->tapeSetBlockPause(1, 0);
+        fast->tapeSetBlockPause(1, 0);
+        auto refStart = std::chrono::steady_clock::now();
+        ref->runFrame();
+        auto fastStart = std::chrono::steady_clock::now();
+        fast->runFrame();
+        auto fastEnd = std::chrono::steady_clock::now();
+        double refSeconds = std::chrono::duration<double>(fastStart - refStart).count();
+        double fastSeconds = std::chrono::duration<double>(fastEnd - fastStart).count();
+        EXPECT_TRUE(sameCpuState(*fast, *ref));
+        EXPECT_EQ(fast->getFrameCounter(), ref->getFrameCounter());
+        EXPECT_TRUE(loadedTap(*ref, tap));
+        EXPECT_TRUE(loadedTap(*fast, tap));
+        // The per-edge bookkeeping between loops still runs, so about 7x fewer
+        // instructions; the wall clock only has to show a clear win
+        EXPECT_TRUE(fastSeconds * 2 < refSeconds);
+    TEST_END();
+}
+
+// Turbo frames must leave the machine, the last frame's picture and its
+// audio exactly as running the frames one at a time would
+static void test_turbo_frames()
+{
+    TEST_BEGIN("Turbo frames match frame-by-frame execution");
+        std::vector<uint8_t> tap = makeTap();
+        auto make = [] { return std::make_unique<zx128k::ZXSpectrum128>(); };
+        auto ref = bootMachine(make, true, tap);
+        auto turbo = bootMachine(make, true, tap);
+
+        // The test program leaves the AY volumes alone; turn them up so the
+        // AY state carried out of the unheard frames reaches the output
+        for (auto* m : { ref.get(), turbo.get() }) {
+            for (uint8_t reg = 8; reg <= 10; reg++) {
+                m->getAY().selectRegister(reg);
+                m->getAY().writeData(static_cast<uint8_t>(reg + 3));
+            }
+        }
+
+        for (int frame = 0; frame < 37; frame++) {
+            ref->resetAudioBuffer();
+            ref->runFrame();
+        }
+        turbo->runTurboFrames(37);
+
+        EXPECT_EQ(frameHash(*turbo), frameHash(*ref));
+        EXPECT_EQ(turbo->getFrameCounter(), ref->getFrameCounter());
+        EXPECT_EQ(turbo->getAudioSampleCount(), ref->getAudioSampleCount());
+        EXPECT_TRUE(turbo->getTurboSpeed() > 0.0);
+
+        // A breakpoint ends the call early, paused where it hit
+        uint32_t start = turbo->getFrameCounter();
+        turbo->addBreakpoint(0x8028);
+        turbo->runTurboFrames(50);
+        EXPECT_TRUE(turbo->isPaused());
+        EXPECT_EQ(turbo->getPC(), 0x8028);
+        EXPECT_TRUE(turbo->getFrameCounter() < start + 50);
+    TEST_END();
+}
+
+// CPU, paging, all eight RAM banks and the tape position: what a time-travel
+// record must restore
+static uint64_t historyHash(const ZXSpectrum& m)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    uint16_t regs[] = { m.getPC(), m.getSP(), m.getAF(), m.getBC(), m.getDE(),
+                        m.getHL(), m.getIX(), m.getIY(), m.getAltAF(), m.getAltBC(),
+                        m.getAltDE(), m.getAltHL() };
+    h = fnv1a(h, regs, sizeof(regs));
+    uint32_t ts = m.getTStates();
+    h = fnv1a(h, &ts, sizeof(ts));
+    uint8_t misc[] = { m.getBorderColor(), m.getPagingRegister(), m.getI(), m.getR() };
+    h = fnv1a(h, misc, sizeof(misc));
+
+    for (uint8_t bank = 0; bank < 8; bank++) {
+        for (uint32_t i = 0; i < MEM_PAGE_SIZE; i++) {
+            uint8_t b = m.readRamBank(bank, static_cast<uint16_t>(i));
+            h = fnv1a(h, &b, 1);
+        }
+    }
+
+    uint8_t tape[ZXSpectrum::TAPE_SNAPSHOT_SIZE];
+    m.tapeSnapshotState(tape);
+    return fnv1a(h, tape, sizeof(tape));
+}
+
+// One frame of history: run it, scribble on a bank the CPU isn't using,
+// then record it
+static void runHistoryFrame(ZXSpectrum& m, TimeTravel& history, uint32_t frame)
+{
+    m.runFrame();
+    m.writeRamBank(static_cast<uint8_t>(frame % 8),
+                   static_cast<uint16_t>(0x2000 + (frame * 97) % 0x1000),
+                   static_cast<uint8_t>(frame));
+    history.capture(m);
+}
+
+// Seeking must restore each recorded frame exactly, and running on from a
+// seek must retrace the original frames
+static void test_time_travel()
+{
+    TEST_BEGIN("Time travel restores recorded frames");
+        std::vector<uint8_t> tap = makeTap();
+        auto m = bootMachine([] { return std::make_unique<zx128k::ZXSpectrum128>(); }, true, tap);
+
+        // Records are numbered by the machine's frame counter
+        TimeTravel history;
+        history.configure(4 * 1024 * 1024, 200, 25);
+        m->setFrameCounter(0);
+
+        std::vector<uint64_t> hashes(121);
+        for (uint32_t frame = 1; frame <= 120; frame++) {
+            runHistoryFrame(*m, history, frame);
+            hashes[frame] = historyHash(*m);
+        }
+        EXPECT_EQ(history.count(), 120u);
+        EXPECT_EQ(history.oldestFrame(), 1u);
+        EXPECT_EQ(history.newestFrame(), 120u);
+        // Five compressed keyframes and the rest deltas: less than the
+        // keyframes alone would take raw
+        EXPECT_TRUE(history.bytesUsed() < 5 * 8 * MEM_PAGE_SIZE);
+
+        for (uint32_t frame : { 120u, 1u, 60u, 26u, 25u, 99u }) {
+            EXPECT_TRUE(history.seekToFrame(*m, frame));
+            EXPECT_EQ(historyHash(*m), hashes[frame]);
+        }
+        EXPECT_TRUE(!history.seekToFrame(*m, 121));
+
+        // Carry on from frame 60: the old future is replaced
+        EXPECT_TRUE(history.seekToFrame(*m, 60));
+        for (uint32_t frame = 61; frame <= 70; frame++) {
+            runHistoryFrame(*m, history, frame);
+            EXPECT_EQ(historyHash(*m), hashes[frame]);
+        }
+        EXPECT_EQ(history.count(), 70u);
+        EXPECT_EQ(history.newestFrame(), 70u);
+        EXPECT_TRUE(history.seekToFrame(*m, 65));
+        EXPECT_EQ(historyHash(*m), hashes[65]);
+
+        // A small arena drops the oldest keyframe groups
+        history.configure(48 * 1024, 1000, 25);
+        m->setFrameCounter(0);
+        hashes.assign(201, 0);
+        for (uint32_t frame = 1; frame <= 200; frame++) {
+            runHistoryFrame(*m, history, frame);
+            hashes[frame] = historyHash(*m);
+        }
+        EXPECT_TRUE(history.count() < 200);
+        EXPECT_EQ(history.newestFrame(), 200u);
+        EXPECT_TRUE(history.bytesUsed() <= history.arenaSize());
+        uint32_t oldest = history.oldestFrame();
+        EXPECT_TRUE(history.seekToFrame(*m, oldest));
+        EXPECT_EQ(historyHash(*m), hashes[oldest]);
+        EXPECT_TRUE(history.seekToFrame(*m, 200));
+        EXPECT_EQ(historyHash(*m), hashes[200]);
+    TEST_END();
+}
+
+// Frame state plus the inputs the journal replays
+static uint64_t inputHash(const ZXSpectrum& m)
+{
+    uint64_t h = historyHash(m);
+    for (int row = 0; row < 8; row++) {
+        uint8_t bits = m.getKeyboardRow(row);
+        h = fnv1a(h, &bits, 1);
+    }
+    uint8_t kempston = m.getKempstonJoystick();
+    return fnv1a(h, &kempston, 1);
+}
+
+// Feed the inputs for a frame, then run it. The ROM's interrupt handler
+// scans the keyboard into the system variables every frame.
+static void runInputFrame(ZXSpectrum& m, uint32_t frame, bool withInput)
+{
+    if (withInput) {
+        if (frame % 7 == 0) m.keyDown(static_cast<int>(frame % 8), static_cast<int>(frame % 5));
+        if (frame % 11 == 0) m.keyUp(static_cast<int>((frame - 7) % 8), static_cast<int>((frame - 7) % 5));
+        if (frame % 3 == 0) m.setKempstonJoystick(static_cast<uint8_t>(frame & 0x1F));
+    }
+    m.runFrame();
+}
+
+// Frames between records are reached by replaying the input journal from
+// the record before them
+static void test_time_travel_input_replay()
+{
+    TEST_BEGIN("Time travel replays input between records");
+        auto m = bootMachine([] { return std::make_unique<zx128k::ZXSpectrum128>(); }, true, {});
+
+        TimeTravel history;
+        history.configure(4 * 1024 * 1024, 100, 10);
+        m->setFrameCounter(0);
+
+        // Record every fifth frame
+        std::vector<uint64_t> hashes(151);
+        for (uint32_t frame = 1; frame <= 150; frame++) {
+            runInputFrame(*m, frame, true);
+            hashes[frame] = inputHash(*m);
+            if (frame % 5 == 0) history.capture(*m);
+        }
+        EXPECT_TRUE(m->isInputJournalEnabled());
+        EXPECT_EQ(history.count(), 30u);
+        EXPECT_EQ(history.oldestFrame(), 5u);
+
+        for (uint32_t frame : { 150u, 37u, 6u, 149u, 5u, 101u, 64u }) {
+            EXPECT_TRUE(history.seekToFrame(*m, frame));
+            EXPECT_EQ(m->getFrameCounter(), frame);
+            EXPECT_EQ(inputHash(*m), hashes[frame]);
+        }
+        EXPECT_TRUE(!history.seekToFrame(*m, 4));
+
+        // Carry on from frame 42 without input: the old input is dropped
+        EXPECT_TRUE(history.seekToFrame(*m, 42));
+        for (uint32_t frame = 43; frame <= 60; frame++) {
+            runInputFrame(*m, frame, false);
+            hashes[frame] = inputHash(*m);
+            if (frame % 5 == 0) history.capture(*m);
+        }
+        EXPECT_EQ(history.newestFrame(), 60u);
+        for (uint32_t frame : { 44u, 57u, 41u }) {
+            EXPECT_TRUE(history.seekToFrame(*m, frame));
+            EXPECT_EQ(inputHash(*m), hashes[frame]);
+        }
+    TEST_END();
+}
+
+// Counts the EAR edges it sees into 0x9000
+static const uint8_t kEdgeCounter[] = {
+    0x21, 0x00, 0x00,       // 8000  LD HL,0
+    0x0E, 0x00,             // 8003  LD C,0
+    0xDB, 0xFE,             // 8005  IN A,(0xFE)      ; loop
+    0xE6, 0x40,             // 8007  AND 0x40
+    0xB9,                   // 8009  CP C
+    0x28, 0xF9,             // 800A  JR Z,loop
+    0x4F,                   // 800C  LD C,A
+    0x23,                   // 800D  INC HL
+    0x22, 0x00, 0x90,       // 800E  LD (0x9000),HL
+    0x18, 0xF2,             // 8011  JR loop
+};
+
+// Input that arrives while a breakpoint holds the machine mid-frame is
+// replayed at the same point, reached through the frame loop with the tape
+// playing and every breakpoint on the way resumed from as it was
+static void test_time_travel_mid_frame_input(const char* name, bool batch)
+{
+    TEST_BEGIN(name);
+        std::vector<uint8_t> tap = makeTap();
+        auto m = std::make_unique<zx48k::ZXSpectrum48>();
+        m->init();
+        m->setBatchExecutionEnabled(batch);
+        for (int i = 0; i < 100; i++) m->runFrame();
+        for (size_t i = 0; i < sizeof(kEdgeCounter); i++) {
+            m->writeMemory(static_cast<uint16_t>(0x8000 + i), kEdgeCounter[i]);
+        }
+        m->setPC(0x8000);
+        m->loadTAP(tap.data(), static_cast<uint32_t>(tap.size()));
+        m->tapePlay();
+
+        TimeTravel history;
+        history.configure(4 * 1024 * 1024, 100, 10);
+        m->setFrameCounter(0);
+        history.capture(*m);
+
+        // Stop at every edge, and press a key at some of the stops
+        m->addBreakpoint(0x800D);
+        std::vector<uint64_t> hashes(201);
+        int pauses = 0;
+        for (uint32_t frame = 1; frame <= 200; frame++) {
+            for (;;) {
+                m->runFrame();
+                if (!m->isPaused()) break;
+                if (frame % 4 == 0 && pauses % 5 == 4) {
+                    m->keyDown(static_cast<int>(frame % 8), static_cast<int>(frame % 5));
+                }
+                m->clearBreakpointHit();
+                m->setPaused(false);
+                pauses++;
+            }
+            hashes[frame] = inputHash(*m);
+            if (frame % 10 == 0) history.capture(*m);
+        }
+        EXPECT_TRUE(pauses > 4000);
+
+        for (uint32_t frame : { 198u, 103u, 4u, 117u, 196u }) {
+            EXPECT_TRUE(history.seekToFrame(*m, frame));
+            EXPECT_EQ(inputHash(*m), hashes[frame]);
+        }
+    TEST_END();
+}
+
+// Records hold neither the tape nor the Spectranet: changing the tape starts
+// a new history, and nothing is recorded while the Spectranet is enabled
+static void test_time_travel_media_changes()
+{
+    TEST_BEGIN("Time travel starts over on a tape change and skips the Spectranet");
+        std::vector<uint8_t> tap = makeTap();
+        auto m = bootMachine([] { return std::make_unique<zx128k::ZXSpectrum128>(); }, true, tap);
+
+        TimeTravel history;
+        history.configure(4 * 1024 * 1024, 100, 10);
+        m->setFrameCounter(0);
+        for (uint32_t frame = 1; frame <= 20; frame++) runHistoryFrame(*m, history, frame);
+        EXPECT_EQ(history.count(), 20u);
+
+        m->loadTAP(tap.data(), static_cast<uint32_t>(tap.size()));
+        EXPECT_TRUE(!history.seekToFrame(*m, 10));
+        runHistoryFrame(*m, history, 21);
+        EXPECT_EQ(history.count(), 1u);
+        EXPECT_EQ(history.oldestFrame(), 21u);
+
+        m->tapeEject();
+        runHistoryFrame(*m, history, 22);
+        EXPECT_EQ(history.count(), 1u);
+        EXPECT_EQ(history.oldestFrame(), 22u);
+
+        m->setSpectranetEnabled(true);
+        EXPECT_TRUE(!history.capture(*m));
+        EXPECT_EQ(history.count(), 0u);
+        EXPECT_TRUE(!m->isInputJournalEnabled());
+
+        m->setSpectranetEnabled(false);
+        EXPECT_TRUE(history.capture(*m));
+        EXPECT_EQ(history.count(), 1u);
+    TEST_END();
+}
+
+// The LZ codec must round-trip any data, through the streaming encoder in
+// pieces that straddle its blocks as well as a block at a time
+static void test_lz_codec()
+{
+    TEST_BEGIN("LZ codec round-trips streamed and block data");
+        std::vector<uint8_t> data(200000);
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < data.size(); i++) {
+            seed = seed * 1103515245u + 12345u;
+            if (i < 50000) data[i] = 0;                                       // zeroed RAM
+            else if (i < 100000) data[i] = static_cast<uint8_t>(i % 7 == 0 ? 0x38 : 0x47);
+            else if (i < 150000) data[i] = static_cast<uint8_t>(seed >> 24);  // noise
+            else data[i] = data[i - 3000];                                    // long repeats
+        }
+
+        std::vector<uint8_t> packed;
+        LZEncoder encoder(packed);
+        size_t pos = 0;
+        for (size_t piece = 1; pos < data.size(); piece = piece * 3 + 7) {
+            size_t n = std::min(piece, data.size() - pos);
+            encoder.write(data.data() + pos, n);
+            pos += n;
+        }
+        encoder.finish();
+        EXPECT_TRUE(packed.size() < data.size() / 2);
+        EXPECT_EQ(lzDecodedSize(packed.data(), packed.size()), data.size());
+        std::vector<uint8_t> unpacked(data.size());
+        EXPECT_TRUE(lzDecode(packed.data(), packed.size(), unpacked.data(), unpacked.size()));
+        EXPECT_TRUE(unpacked == data);
+
+        // Noise is stored raw, never grown beyond the block header
+        std::vector<uint8_t> block(LZEncoder::maxEncodedSize(50000));
+        size_t written = LZEncoder::encodeBlock(data.data() + 100000, 50000, block.data());
+        EXPECT_TRUE(written <= 50000 + LZEncoder::BLOCK_HEADER_SIZE);
+        EXPECT_TRUE(lzDecode(block.data(), written, unpacked.data(), 50000));
+        EXPECT_TRUE(std::equal(unpacked.begin(), unpacked.begin() + 50000, data.begin() + 100000));
+
+        // Damage is caught rather than read past
+        packed[packed.size() / 2] ^= 0xFF;
+        packed.resize(packed.size() - 1);
+        EXPECT_TRUE(!lzDecode(packed.data(), packed.size(), unpacked.data(), data.size()));
+    TEST_END();
+}
+
+// A .z80 snapshot with RLE pages must be much smaller than raw pages and
+// load back to the same machine
+static void test_z80_snapshot_compression()
+{
+    TEST_BEGIN("Z80 snapshot pages are RLE compressed and reload (128K)");
+        auto a = bootMachine([] { return std::make_unique<zx128k::ZXSpectrum128>(); }, true, {});
+        for (int i = 0; i < 10; i++) a->runFrame();
+        a->writeRamBank(6, 0x100, 0xED);
+        a->writeRamBank(6, 0x101, 0xED);
+        a->writeRamBank(6, 0x200, 0xED);
+        a->writeRamBank(6, 0x201, 0x00);
+
+        std::vector<uint8_t> snapshot(Z80Saver::MAX_HEADER_SIZE + 8 * (3 + MEM_PAGE_SIZE));
+        uint32_t size = Z80Saver::save(*a, snapshot.data(), static_cast<uint32_t>(snapshot.size()));
+        EXPECT_TRUE(size > 0);
+        EXPECT_TRUE(size < 8 * MEM_PAGE_SIZE / 2);
+
+        // Saving only needs room for the compressed pages
+        std::vector<uint8_t> tight(size);
+        EXPECT_EQ(Z80Saver::save(*a, tight.data(), size), size);
+        EXPECT_EQ(Z80Saver::save(*a, tight.data(), size - 1), 0u);
+
+        auto b = std::make_unique<zx128k::ZXSpectrum128>();
+        b->init();
+        b->loadZ80(snapshot.data(), size);
+        int differences = 0;
+        for (uint8_t bank = 0; bank < 8; bank++) {
+            for (uint32_t i = 0; i < MEM_PAGE_SIZE; i++) {
+                uint16_t offset = static_cast<uint16_t>(i);
+                if (a->readRamBank(bank, offset) != b->readRamBank(bank, offset)) differences++;
+            }
+        }
+        EXPECT_EQ(differences, 0);
+        EXPECT_EQ(b->getPC(), a->getPC());
+        EXPECT_EQ(b->getPagingRegister(), a->getPagingRegister());
+    TEST_END();
+}
+
+// A native state saved mid-frame must carry on exactly like the machine it
+// came from: CPU, RAM, display, beeper, AY and tape all resume in step
+static void test_state_round_trip(const char* name, const MachineFactory& make)
+{
+    TEST_BEGIN(name);
+        std::vector<uint8_t> tap = makeTap();
+        auto a = bootMachine(make, true, tap);
+        for (int i = 0; i < 20; i++) a->runFrame();
+        for (int i = 0; i < 5000; i++) a->stepInstruction();
+
+        std::vector<uint8_t> state;
+        a->saveState(state);
+        EXPECT_EQ(ZXSpectrum::stateMachineId(state.data(), static_cast<uint32_t>(state.size())),
+                  static_cast<int>(a->getId()));
+
+        // Media isn't part of the state, so the copy gets the same tape
+        auto b = make();
+        b->init();
+        b->setAYEnabled(true);
+        b->setSpecdrumEnabled(true);
+        b->tapeSetInstantLoad(false);
+        b->loadTAP(tap.data(), static_cast<uint32_t>(tap.size()));
+        EXPECT_TRUE(b->loadState(state.data(), static_cast<uint32_t>(state.size())));
+
+        int mismatches = 0;
+        for (int i = 0; i < 30; i++) {
+            a->runFrame();
+            b->runFrame();
+            if (frameHash(*a) != frameHash(*b) || historyHash(*a) != historyHash(*b)) mismatches++;
+        }
+        EXPECT_EQ(mismatches, 0);
+
+        // Saving the copy gives the same bytes back
+        std::vector<uint8_t> again;
+        a->saveState(state);
+        b->saveState(again);
+        EXPECT_TRUE(state == again);
+
+        // Compressed, it is a fraction of the size and loads the same
+        std::vector<uint8_t> packed;
+        a->saveState(packed, true);
+        EXPECT_TRUE(packed.size() < state.size() / 2);
+        EXPECT_TRUE(b->loadState(packed.data(), static_cast<uint32_t>(packed.size())));
+        b->saveState(again);
+        EXPECT_TRUE(state == again);
+
+        // Truncated data and another machine's state are refused
+        EXPECT_TRUE(!b->loadState(state.data(), static_cast<uint32_t>(state.size() / 2)));
+
+        // So is a RAM chunk for the wrong size of RAM, found only after the
+        // machine and CPU chunks are applied. The machine is left as it was.
+        for (int i = 0; i < 7; i++) a->runFrame();
+        std::vector<uint8_t> bad;
+        a->saveState(bad);
+        auto payload = [&bad](const char* tag) {
+            uint32_t pos = StateWriter::HEADER_SIZE;
+            while (std::memcmp(bad.data() + pos, tag, 4) != 0) {
+                uint32_t length = 0;
+                std::memcpy(&length, bad.data() + pos + 8, 4);
+                pos += StateWriter::CHUNK_HEADER_SIZE + length;
+            }
+            return pos + StateWriter::CHUNK_HEADER_SIZE;
+        };
+        bad[payload("RAM ")] ^= 0x01;
+        EXPECT_TRUE(!b->loadState(bad.data(), static_cast<uint32_t>(bad.size())));
+        b->saveState(again);
+        EXPECT_TRUE(state == again);
+
+        // And so is a bool or an enum holding a value its type can't: the
+        // CPU's Halted flag follows 29 bytes of registers, and its CPU type
+        // follows the other flags, T-states and MEMPTR
+        a->saveState(bad);
+        bad[payload("CPU ") + 29] = 2;
+        EXPECT_TRUE(!b->loadState(bad.data(), static_cast<uint32_t>(bad.size())));
+        b->saveState(again);
+        EXPECT_TRUE(state == again);
+        a->saveState(bad);
+        bad[payload("CPU ") + 40] = 7;
+        EXPECT_TRUE(!b->loadState(bad.data(), static_cast<uint32_t>(bad.size())));
+        b->saveState(again);
+        EXPECT_TRUE(state == again);
+        a->saveState(bad);
+        EXPECT_TRUE(b->loadState(bad.data(), static_cast<uint32_t>(bad.size())));
+        auto other = std::make_unique<zx48k::ZXSpectrum48>();
+        other->init();
+        if (a->getId() != other->getId()) {
+            EXPECT_TRUE(!other->loadState(state.data(), static_cast<uint32_t>(state.size())));
+        }
+    TEST_END();
+}
+
+static void test_fork(const char* name, const MachineFactory& make)
+{
+    TEST_BEGIN(name);
+        std::vector<uint8_t> tap = makeTap();
+        auto a = bootMachine(make, true, tap);
+        for (int i = 0; i < 20; i++) a->runFrame();
+        for (int i = 0; i < 5000; i++) a->stepInstruction();
+
+        std::unique_ptr<ZXSpectrum> b = a->fork();
+        EXPECT_TRUE(b != nullptr);
+
+        std::vector<uint8_t> stateA;
+        std::vector<uint8_t> stateB;
+        a->saveState(stateA);
+        b->saveState(stateB);
+        EXPECT_TRUE(stateA == stateB);
+
+        // Both run on identically from the fork, copying banks as they go
+        int mismatches = 0;
+        for (int i = 0; i < 30; i++) {
+            a->runFrame();
+            b->runFrame();
+            if (frameHash(*a) != frameHash(*b) || historyHash(*a) != historyHash(*b)) mismatches++;
+        }
+        EXPECT_EQ(mismatches, 0);
+
+        // A write on either side stays on that side, in RAM and ROM alike
+        uint8_t before = b->readMemory(0x8000);
+        a->writeMemory(0x8000, static_cast<uint8_t>(before ^ 0xFF));
+        EXPECT_EQ(b->readMemory(0x8000), before);
+        EXPECT_EQ(a->readMemory(0x8000), static_cast<uint8_t>(before ^ 0xFF));
+        uint8_t rom = a->readMemory(0x0000);
+        b->writeMemory(0x0000, static_cast<uint8_t>(rom ^ 0xFF));
+        EXPECT_EQ(a->readMemory(0x0000), rom);
+        EXPECT_EQ(b->readMemory(0x0000), rom);
+
+        // The source can fork again after its copy is gone
+        b.reset();
+        auto c = a->fork();
+        EXPECT_TRUE(c != nullptr);
+        a->runFrame();
+        c->runFrame();
+        EXPECT_EQ(frameHash(*a), frameHash(*c));
+    TEST_END();
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+
+int main()
+{
+    std::printf("========================================\n");
+    std::printf("  Machine Test Harness\n");
+    std::printf("========================================\n\n");
+
+    test_batch_matches_per_instruction("Batch execution == per-instruction (48K)",
+        [] { return std::make_unique<zx48k::ZXSpectrum48>(); });
+    test_batch_matches_per_instruction("Batch execution == per-instruction (128K)",
+        [] { return std::make_unique<zx128k::ZXSpectrum128>(); });
+    test_batch_matches_per_instruction("Batch execution == per-instruction (+2A)",
+        [] { return std::make_unique<zxplus2a::ZXSpectrumPlus2A>(); });
+    test_batch_matches_per_instruction("Batch execution == per-instruction (+3)",
+        [] { return std::make_unique<zxplus3::ZXSpectrumPlus3>(); });
+    test_machine_pool_matches_sequential();
+    test_dirty_rows();
+    test_display_write_filter();
+    test_udg_screen_patching();
+    test_stereo_mixer();
+    test_resampler_rates();
+    test_sp0256_cached_allophones();
+    test_tape_pulse_stream();
+    test_tape_edge_loop_skip();
+    test_turbo_frames();
+    test_time_travel();
+    test_time_travel_input_replay();
+    test_time_travel_mid_frame_input("Time travel replays mid-frame input (per-instruction)", false);
+    test_time_travel_mid_frame_input("Time travel replays mid-frame input (batched)", true);
+    test_time_travel_media_changes();
+    test_state_round_trip("Machine state round trip (128K)",
+        [] { return std::make_unique<zx128k::ZXSpectrum128>(); });
+    test_state_round_trip("Machine state round trip (+3)",
+        [] { return std::make_unique<zxplus3::ZXSpectrumPlus3>(); });
+    test_lz_codec();
+    test_z80_snapshot_compression();
+    test_fork("Forked machines run on alike and apart (48K)",
+        [] { return std::make_unique<zx48k::ZXSpectrum48>(); });
+    test_fork("Forked machines run on alike and apart (128K)",
+        [] { return std::make_unique<zx128k::ZXSpectrum128>(); });
+    test_fork("Forked machines run on alike and apart (+3)",
+        [] { return std::make_unique<zxplus3::ZXSpectrumPlus3>(); });
+
+    std::printf("\n========================================\n");
+    std::printf("  Results: %d / %d passed", g_passed, g_total);
+    if (g_failed > 0) {
+        std::printf("  (%d FAILED)", g_failed);
+    }
+    std::printf("\n========================================\n");
+
+    return (g_failed == 0) ? 0 : 1;
+}
@@ -6,6 +6,7 @@
 #   ./tests/run-tests.sh          # Run all tests
 #   ./tests/run-tests.sh z80      # Run Z80 CPU tests only
 #   ./tests/run-tests.sh timing   # Run timing tests only
+#   ./tests/run-tests.sh machine  # Run whole-machine tests only
 #   ./tests/run-tests.sh disk     # Run disk compatibility tests
 #   ./tests/run-tests.sh disk /path/to/dsk/images
 #
@@ -32,6 +33,9 @@ case "${1:-all}" in
     timing)
         ./timing_test
         ;;
+    machine)
+        ./machine_test
+        ;;
     disk)
         ./disk_test "$DISK_DIR"
         ;;
@@ -40,6 +44,8 @@ case "${1:-all}" in
         echo ""
         ./timing_test
         echo ""
+        ./machine_test
+        echo ""
         if [ -d "$DISK_DIR" ] && [ "$(ls -A "$DISK_DIR"/*.dsk 2>/dev/null)" ]; then
             ./disk_test "$DISK_DIR"
         else
@@ -47,7 +53,7 @@ case "${1:-all}" in
         fi
         ;;
     *)
-        echo "Usage: $0 [z80|timing|disk|all] [disk-image-dir]"
+        echo "Usage: $0 [z80|timing|machine|disk|all] [disk-image-dir]"
         exit 1
         ;;
 esac
@@ -0,0 +1,114 @@
+/*
+ * z80_bench.cpp - Instruction throughput benchmark for the Z80 core
+ *
+ * Runs a fixed instruction mix (main, CB, DD/FD, DDCB and ED block opcodes)
+ * on a flat 64 KB bus with no contention and reports instructions per second.
+ * Built twice by CMake, once per opcode dispatch strategy:
+ *   z80_bench_table  - per-prefix pointer-to-member tables (Z80_FLAT_DISPATCH=0)
+ *   z80_bench_flat   - flat 1792-entry handler table     (Z80_FLAT_DISPATCH=1)
+ *
+ * Usage: z80_bench_xxx [million T-states]   (default 700, ~200 emulated seconds)
+ */
+
+#include "z80/z80.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+static uint8_t g_memory[65536];
+
+struct BenchBus {
+    static uint8_t memRead(uint16_t address, void* /*param*/) { return g_memory[address]; }
+    static void memWrite(uint16_t address, uint8_t data, void* /*param*/) { g_memory[address] = data; }
+    static uint8_t ioRead(uint16_t /*address*/, void* /*param*/) { return 0xFF; }
+    static void ioWrite(uint16_t /*address*/, uint8_t /*data*/, void* /*param*/) {}
+    static void contention(uint16_t /*address*/, uint32_t /*tstates*/, void* /*param*/) {}
+    static void noMreqContention(uint16_t /*address*/, uint32_t /*tstates*/, void* /*param*/) {}
+};
+
+static constexpr uint16_t kLoopStart = 0x8008;
+
+static const uint8_t kProgram[] = {
+    0xDD, 0x21, 0x00, 0x90,     // 8000  LD IX,0x9000
+    0xFD, 0x21, 0x40, 0x90,     // 8004  LD IY,0x9040
+    0x06, 0x10,                 // 8008  LD B,16          ; loop
+    0xDD, 0x7E, 0x01,           // 800A  LD A,(IX+1)      ; inner
+    0xFD, 0x86, 0x02,           // 800D  ADD A,(IY+2)
+    0xDD, 0xCB, 0x03, 0x06,     // 8010  RLC (IX+3)
+    0xCB, 0x5F,                 // 8014  BIT 3,A
+    0xCB, 0x3A,                 // 8016  SRL D
+    0xED, 0x5A,                 // 8018  ADC HL,DE
+    0xA9,                       // 801A  XOR C
+    0x13,                       // 801B  INC DE
+    0xFD, 0x77, 0x04,           // 801C  LD (IY+4),A
+    0xE5,                       // 801F  PUSH HL
+    0xE1,                       // 8020  POP HL
+    0xEB,                       // 8021  EX DE,HL
+    0x10, 0xE6,                 // 8022  DJNZ 0x800A
+    0x21, 0x00, 0x90,           // 8024  LD HL,0x9000
+    0x11, 0x00, 0xA0,           // 8027  LD DE,0xA000
+    0x01, 0x20, 0x00,           // 802A  LD BC,32
+    0xED, 0xB0,                 // 802D  LDIR
+    0x18, 0xD7,                 // 802F  JR 0x8008
+};
+
+static void resetCpu(zxspec::Z80& cpu)
+{
+    std::memset(g_memory, 0, sizeof(g_memory));
+    std::memcpy(g_memory + 0x8000, kProgram, sizeof(kProgram));
+    cpu.reset(true);
+    cpu.bindBus<BenchBus>(nullptr);
+    cpu.setRegister(zxspec::Z80::WordReg::PC, 0x8000);
+    cpu.setRegister(zxspec::Z80::WordReg::SP, 0xFF00);
+    cpu.resetTStates();
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t budget = 700ULL * 1000000ULL;
+    if (argc > 1) {
+        budget = std::strtoull(argv[1], nullptr, 10) * 1000000ULL;
+    }
+
+    static zxspec::Z80 cpu;
+
+    // Calibrate: step one pass of the loop to get its instruction and
+    // T-state counts (the loop is fully deterministic on an uncontended bus)
+    resetCpu(cpu);
+    while (cpu.getRegister(zxspec::Z80::WordReg::PC) != kLoopStart) {
+        cpu.execute(1);
+    }
+    uint32_t loopStartTs = cpu.getTStates();
+    uint64_t loopInstructions = 0;
+    do {
+        cpu.execute(1);
+        loopInstructions++;
+    } while (cpu.getRegister(zxspec::Z80::WordReg::PC) != kLoopStart);
+    uint32_t loopTStates = cpu.getTStates() - loopStartTs;
+
+    // Timed run: execute in frame-sized chunks, as the machines do
+    resetCpu(cpu);
+    constexpr uint32_t kChunk = 69888;
+    uint64_t executed = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (executed < budget) {
+        executed += cpu.execute(kChunk, 0);
+        cpu.resetTStates();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double instructions = static_cast<double>(executed) / loopTStates * loopInstructions;
+
+    std::printf("Z80 dispatch:        %s\n", Z80_FLAT_DISPATCH ? "flat 1792-entry table" : "per-prefix member tables");
+    std::printf("Loop:                %llu instructions, %u T-states\n",
+                (unsigned long long)loopInstructions, loopTStates);
+    std::printf("T-states executed:   %llu\n", (unsigned long long)executed);
+    std::printf("Time:                %.3f s\n", seconds);
+    std::printf("Instructions/sec:    %.2f M\n", instructions / seconds / 1e6);
+    std::printf("Speed vs 3.5 MHz:    %.1fx\n", static_cast<double>(executed) / seconds / 3.5e6);
+    return 0;
+}
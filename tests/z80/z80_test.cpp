@@ -364,6 +364,92 @@ static void test_reset()
         EXPECT_EQ(g_cpu.getIFF2(), 0);
         EXPECT_EQ(g_cpu.getIMMode(), 0);
     TEST_END();
+
+    TEST_BEGIN("reset(true) - drops a pending NMI and clears MEMPTR");
+        resetEnv();
+        // LD A,(0x2828) leaves MEMPTR = 0x2829; bits 5 and 3 of its high
+        // byte show up in F after BIT n,(HL)
+        poke(0x0000, { 0x3A, 0x28, 0x28 });
+        step();
+        g_cpu.setNMIReq(true);
+
+        g_cpu.reset(true);
+
+        // A surviving NMI request would divert execution to 0x0066
+        poke(0x0000, { 0xCB, 0x46 });           // BIT 0,(HL)
+        step();
+        EXPECT_EQ(g_cpu.getRegister(WordReg::PC), 0x0002);
+        EXPECT_EQ(g_cpu.getRegister(ByteReg::F) & 0x28, 0x00);
+    TEST_END();
+}
+
+// Bus policy used by the bindBus() tests: same flat memory as the callbacks,
+// but counts contention calls and can rewrite opcode fetches.
+struct TestBus {
+    static inline uint32_t contentionCalls = 0;
+    static inline bool fetchNopAbove8000 = false;
+
+    static uint8_t memRead(uint16_t address, void* /*param*/) { return g_memory[address]; }
+    static void memWrite(uint16_t address, uint8_t data, void* /*param*/) { g_memory[address] = data; }
+    static uint8_t ioRead(uint16_t /*address*/, void* /*param*/) { return 0xFF; }
+    static void ioWrite(uint16_t /*address*/, uint8_t /*data*/, void* /*param*/) {}
+    static void contention(uint16_t /*address*/, uint32_t /*tstates*/, void* /*param*/) { contentionCalls++; }
+    static void noMreqContention(uint16_t /*address*/, uint32_t /*tstates*/, void* /*param*/) {}
+    static uint8_t opcodeFetch(uint16_t address, void* /*param*/)
+    {
+        return (fetchNopAbove8000 && (address & 0x8000)) ? 0x00 : g_memory[address];
+    }
+};
+
+static void test_bound_bus()
+{
+    TEST_BEGIN("bindBus - matches callback path (registers, memory, T-states)");
+        // LD HL,0x8000 ; LD (HL),0x42 ; LD A,(HL) ; INC A ; PUSH AF ; CALL 0x0020
+        // 0x0020: POP BC ; RET
+        auto program = [] {
+            poke(0x0000, { 0x21, 0x00, 0x80, 0x36, 0x42, 0x7E, 0x3C, 0xF5, 0xCD, 0x20, 0x00 });
+            poke(0x0020, { 0xC1, 0xC9 });
+            g_cpu.setRegister(WordReg::SP, 0xFF00);
+        };
+
+        resetEnv();
+        program();
+        for (int i = 0; i < 8; i++) step();
+        uint16_t refAF = g_cpu.getRegister(WordReg::AF);
+        uint16_t refBC = g_cpu.getRegister(WordReg::BC);
+        uint16_t refPC = g_cpu.getRegister(WordReg::PC);
+        uint32_t refTs = g_cpu.getTStates();
+
+        resetEnv();
+        g_cpu.bindBus<TestBus>(nullptr);
+        TestBus::contentionCalls = 0;
+        TestBus::fetchNopAbove8000 = false;
+        program();
+        for (int i = 0; i < 8; i++) step();
+        EXPECT_TRUE(g_cpu.isBusBound());
+        EXPECT_EQ(g_cpu.getRegister(WordReg::AF), refAF);
+        EXPECT_EQ(g_cpu.getRegister(WordReg::BC), refBC);
+        EXPECT_EQ(g_cpu.getRegister(WordReg::PC), refPC);
+        EXPECT_EQ(g_cpu.getTStates(), refTs);
+        EXPECT_EQ(g_memory[0x8000], 0x42);
+        EXPECT_TRUE(TestBus::contentionCalls > 0);
+    TEST_END();
+
+    TEST_BEGIN("bindBus - opcodeFetch override, initialise() unbinds");
+        resetEnv();
+        g_cpu.bindBus<TestBus>(nullptr);
+        TestBus::fetchNopAbove8000 = true;
+        poke(0x8000, { 0x3E, 0x55 });       // LD A,0x55 (fetched as NOP)
+        g_cpu.setRegister(WordReg::PC, 0x8000);
+        g_cpu.setRegister(ByteReg::A, 0x00);
+        step();
+        EXPECT_EQ(g_cpu.getRegister(WordReg::PC), 0x8001);
+        EXPECT_EQ(g_cpu.getRegister(ByteReg::A), 0x00);
+        TestBus::fetchNopAbove8000 = false;
+
+        resetEnv();
+        EXPECT_FALSE(g_cpu.isBusBound());
+    TEST_END();
 }
 
 // ---------------------------------------------------------------------------
@@ -388,6 +474,7 @@ int main()
     test_xor_a();
     test_ld_hl_mem();
     test_reset();
+    test_bound_bus();
 
     std::printf("\n========================================\n");
     std::printf("  Results: %d / %d passed", g_passed, g_total);